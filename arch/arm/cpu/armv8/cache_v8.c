@@ -8,6 +8,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <asm/system.h>
 #include <asm/armv8/mmu.h>
 
@@ -100,20 +101,44 @@ static int level2shift(int level)
 	return (12 + 9 * (3 - level));
 }
 
+/* Returns the first page-table level needed for the current mem_map */
+static int get_start_level(void)
+{
+	u64 va_bits;
+
+	get_tcr(0, NULL, &va_bits);
+
+	return va_bits < 39 ? 1 : 0;
+}
+
+/* Invalidates all TLB entries, keeping count for bdinfo */
+static void mmu_invalidate_tlb(void)
+{
+	__asm_invalidate_tlb_all();
+	gd->arch.tlb_flushes++;
+}
+
+/* Switches to another page table, which also invalidates the TLB */
+static void mmu_switch_ttbr(ulong addr)
+{
+	__asm_switch_ttbr(addr);
+	gd->arch.tlb_flushes++;
+}
+
+/*
+ * Looks up the PTE for an address. The start level is worked out by
+ * setup_pgtables() since get_tcr() scans the whole mem_map, which is too slow
+ * to do for every lookup.
+ */
 static u64 *find_pte(u64 addr, int level)
 {
-	int start_level = 0;
+	int start_level = gd->arch.tlb_start_level;
 	u64 *pte;
 	u64 idx;
-	u64 va_bits;
 	int i;
 
 	debug("addr=%llx level=%d\n", addr, level);
 
-	get_tcr(0, NULL, &va_bits);
-	if (va_bits < 39)
-		start_level = 1;
-
 	if (level < start_level)
 		return NULL;
 
@@ -225,7 +250,9 @@ static void add_map(struct mm_region *map)
 			blocksize = 1ULL << level2shift(level);
 			debug("Checking if pte fits for virt=%llx size=%llx blocksize=%llx\n",
 			      virt, size, blocksize);
-			if (size >= blocksize && !(virt & (blocksize - 1))) {
+			/* Both addresses must be aligned to use a block */
+			if (size >= blocksize &&
+			    !((virt | phys) & (blocksize - 1))) {
 				/* Page fits, create block PTE */
 				debug("Setting PTE %p to block virt=%llx\n",
 				      pte, virt);
@@ -233,6 +260,7 @@ static void add_map(struct mm_region *map)
 					*pte = phys | attrs | PTE_TYPE_PAGE;
 				else
 					*pte = phys | attrs;
+				gd->arch.tlb_blocks[level]++;
 				virt += blocksize;
 				phys += blocksize;
 				size -= blocksize;
@@ -278,14 +306,17 @@ static int count_required_pts(u64 addr, int level, u64 maxaddr)
 		struct mm_region *map = &mem_map[i];
 		u64 start = map->virt;
 		u64 end = start + map->size;
+		u64 phys;
 
 		/* Check if the PTE would overlap with the map */
 		if (max(addr, start) <= min(levelend, end)) {
+			phys = map->phys + max(addr, start) - start;
 			start = max(addr, start);
 			end = min(levelend, end);
 
 			/* We need a sub-pt for this level */
-			if ((start & levelmask) || (end & levelmask)) {
+			if ((start & levelmask) || (end & levelmask) ||
+			    (phys & levelmask)) {
 				pte_type = PTE_LEVEL;
 				break;
 			}
@@ -367,6 +398,10 @@ void setup_pgtables(void)
 	if (!gd->arch.tlb_fillptr || !gd->arch.tlb_addr)
 		panic("Page table pointer not setup.");
 
+	gd->arch.tlb_start_level = get_start_level();
+	for (i = 0; i < ARRAY_SIZE(gd->arch.tlb_blocks); i++)
+		gd->arch.tlb_blocks[i] = 0;
+
 	/*
 	 * Allocate the first level we're on with invalidate entries.
 	 * If the starting level is 0 (va_bits >= 39), then this is our
@@ -379,10 +414,29 @@ void setup_pgtables(void)
 		add_map(&mem_map[i]);
 }
 
+/* Moves the table pointers in a copied page table by @offset bytes */
+static void relocate_pgtable(u64 *table, int level, long offset)
+{
+	u64 *pte;
+	int i;
+
+	/* Level 3 pages look like tables but have no sub-tables */
+	if (level == 3)
+		return;
+
+	for (i = 0, pte = table; i < MAX_PTE_ENTRIES; i++, pte++) {
+		if (pte_type(pte) != PTE_TYPE_TABLE)
+			continue;
+		*pte += offset;
+		relocate_pgtable((u64 *)(*pte & 0x0000fffffffff000ULL),
+				 level + 1, offset);
+	}
+}
+
 static void setup_all_pgtables(void)
 {
 	u64 tlb_addr = gd->arch.tlb_addr;
-	u64 tlb_size = gd->arch.tlb_size;
+	ulong len;
 
 	/* Reset the fill ptr */
 	gd->arch.tlb_fillptr = tlb_addr;
@@ -390,14 +444,22 @@ static void setup_all_pgtables(void)
 	/* Create normal system page tables */
 	setup_pgtables();
 
-	/* Create emergency page tables */
-	gd->arch.tlb_size -= (uintptr_t)gd->arch.tlb_fillptr -
-			     (uintptr_t)gd->arch.tlb_addr;
-	gd->arch.tlb_addr = gd->arch.tlb_fillptr;
-	setup_pgtables();
-	gd->arch.tlb_emerg = gd->arch.tlb_addr;
-	gd->arch.tlb_addr = tlb_addr;
-	gd->arch.tlb_size = tlb_size;
+	/*
+	 * Create emergency page tables. These are identical to the normal ones
+	 * so copy them rather than walking the mem_map again.
+	 */
+	len = gd->arch.tlb_fillptr - tlb_addr;
+	if (2 * len > gd->arch.tlb_size)
+		panic("Insufficient RAM for page tables: 0x%lx > 0x%lx",
+		      2 * len, gd->arch.tlb_size);
+	gd->arch.tlb_emerg = gd->arch.tlb_fillptr;
+	memcpy((void *)gd->arch.tlb_emerg, (void *)tlb_addr, len);
+	relocate_pgtable((u64 *)gd->arch.tlb_emerg, gd->arch.tlb_start_level,
+			 len);
+	gd->arch.tlb_fillptr += len;
+	debug("Page tables: %lx bytes, blocks 1G=%u 2M=%u 4K=%u\n", len,
+	      gd->arch.tlb_blocks[1], gd->arch.tlb_blocks[2],
+	      gd->arch.tlb_blocks[3]);
 }
 
 /* to activate the MMU we need to set up virtual memory */
@@ -405,9 +467,18 @@ __weak void mmu_setup(void)
 {
 	int el;
 
-	/* Set up page tables only once */
-	if (!gd->arch.tlb_fillptr)
+	/*
+	 * Set up page tables only once. They are in memory reserved by
+	 * reserve_mmu() so stay valid across relocation.
+	 */
+	if (!gd->arch.tlb_fillptr) {
+		/* bootstage is not available in SPL until spl_init() */
+		if (gd->bootstage)
+			bootstage_start(BOOTSTAGE_ID_ACCUM_MMU, "mmu_setup");
 		setup_all_pgtables();
+		if (gd->bootstage)
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_MMU);
+	}
 
 	el = current_el();
 	set_ttbr_tcr_mair(el, gd->arch.tlb_addr, get_tcr(el, NULL, NULL),
@@ -464,7 +535,7 @@ void dcache_enable(void)
 	/* The data cache is not active unless the mmu is enabled */
 	if (!(get_sctlr() & CR_M)) {
 		invalidate_dcache_all();
-		__asm_invalidate_tlb_all();
+		mmu_invalidate_tlb();
 		mmu_setup();
 	}
 
@@ -484,7 +555,7 @@ void dcache_disable(void)
 	set_sctlr(sctlr & ~(CR_C|CR_M));
 
 	flush_dcache_all();
-	__asm_invalidate_tlb_all();
+	mmu_invalidate_tlb();
 }
 
 int dcache_status(void)
@@ -557,7 +628,7 @@ void mmu_set_region_dcache_behaviour(phys_addr_t start, size_t size,
 	 * so we first need to switch to the "emergency" page tables where
 	 * we can safely modify our primary page tables and then switch back
 	 */
-	__asm_switch_ttbr(gd->arch.tlb_emerg);
+	mmu_switch_ttbr(gd->arch.tlb_emerg);
 
 	/*
 	 * Loop through the address range until we find a page granule that fits
@@ -581,7 +652,7 @@ void mmu_set_region_dcache_behaviour(phys_addr_t start, size_t size,
 	}
 
 	/* We're done modifying page tables, switch back to our primary ones */
-	__asm_switch_ttbr(gd->arch.tlb_addr);
+	mmu_switch_ttbr(gd->arch.tlb_addr);
 
 	/*
 	 * Make sure there's nothing stale in dcache for a region that might
@@ -622,7 +693,7 @@ void mmu_change_region_attr(phys_addr_t addr, size_t siz, u64 attrs)
 
 	flush_dcache_range(gd->arch.tlb_addr,
 			   gd->arch.tlb_addr + gd->arch.tlb_size);
-	__asm_invalidate_tlb_all();
+	mmu_invalidate_tlb();
 
 	/*
 	 * Loop through the address range until we find a page granule that fits
@@ -644,7 +715,7 @@ void mmu_change_region_attr(phys_addr_t addr, size_t siz, u64 attrs)
 	}
 	flush_dcache_range(gd->arch.tlb_addr,
 			   gd->arch.tlb_addr + gd->arch.tlb_size);
-	__asm_invalidate_tlb_all();
+	mmu_invalidate_tlb();
 }
 
 #else	/* CONFIG_SYS_DCACHE_OFF */
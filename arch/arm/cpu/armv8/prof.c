@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler: ARMv8 uses the virtual generic timer
+ *
+ * The timer interrupt is a PPI which is enabled only on the boot CPU. The GIC
+ * must already be set up with the PPI in group 1, as is normally done by the
+ * secure firmware. U-Boot must run at EL2 or EL1, since group 1 interrupts are
+ * not taken as IRQs at EL3. At EL2, IRQs are routed to EL2 while profiling.
+ */
+
+#include <common.h>
+#include <prof.h>
+#include <asm/gic.h>
+#include <asm/io.h>
+#include <asm/system.h>
+#include <linux/bitops.h>
+
+/* Virtual timer PPI, as interrupt ID */
+#define PROF_TIMER_IRQ		27
+
+/* Interrupt ID which means there is no interrupt pending */
+#define GIC_SPURIOUS_IRQ	1023
+
+#define CNTV_CTL_ENABLE		BIT(0)
+
+/* Number of timer ticks between samples */
+static ulong prof_ticks;
+
+/* Value of HCR_EL2 before profiling started, when running at EL2 */
+static ulong prof_saved_hcr;
+
+#if defined(CONFIG_GICV3)
+#define GICR_TYPER_VLPIS	BIT(1)
+#define GICR_TYPER_LAST		BIT(4)
+#define GICR_SGI_OFFSET		0x10000
+
+/* Find the SGI/PPI frame of the redistributor for this CPU */
+static void *prof_gicr_sgi_base(void)
+{
+	void *base = (void *)GICR_BASE;
+	u32 aff;
+	u64 mpidr;
+	u64 typer;
+
+	asm volatile("mrs %0, mpidr_el1" : "=r" (mpidr));
+	aff = (mpidr & 0xffffff) | ((mpidr >> 8) & 0xff000000);
+	do {
+		typer = readq(base + GICR_TYPER);
+		if (typer >> 32 == aff)
+			return base + GICR_SGI_OFFSET;
+		base += typer & GICR_TYPER_VLPIS ? 0x40000 : 0x20000;
+	} while (!(typer & GICR_TYPER_LAST));
+
+	return NULL;
+}
+
+static int prof_gic_enable(bool enable)
+{
+	void *sgi_base = prof_gicr_sgi_base();
+
+	if (!sgi_base)
+		return -ENODEV;
+	if (enable) {
+		asm volatile("msr " __stringify(ICC_PMR_EL1) ", %0"
+			     : : "r" (0xffUL));
+		asm volatile("msr " __stringify(ICC_IGRPEN1_EL1) ", %0"
+			     : : "r" (1UL));
+		writel(BIT(PROF_TIMER_IRQ), sgi_base + GICR_ISENABLERn);
+	} else {
+		writel(BIT(PROF_TIMER_IRQ), sgi_base + GICR_ICENABLERn);
+	}
+	isb();
+
+	return 0;
+}
+
+static u32 prof_gic_ack(void)
+{
+	ulong irq;
+
+	asm volatile("mrs %0, " __stringify(ICC_IAR1_EL1) : "=r" (irq));
+	dsb();
+
+	return irq;
+}
+
+static void prof_gic_eoi(u32 irq)
+{
+	asm volatile("msr " __stringify(ICC_EOIR1_EL1) ", %0"
+		     : : "r" ((ulong)irq));
+	isb();
+}
+#elif defined(CONFIG_GICV2)
+static int prof_gic_enable(bool enable)
+{
+	if (enable) {
+		writel(0xff, GICC_BASE + GICC_PMR);
+		setbits_le32(GICC_BASE + GICC_CTLR, 1);
+		writel(BIT(PROF_TIMER_IRQ), GICD_BASE + GICD_ISENABLERn);
+	} else {
+		writel(BIT(PROF_TIMER_IRQ), GICD_BASE + GICD_ICENABLERn);
+	}
+
+	return 0;
+}
+
+static u32 prof_gic_ack(void)
+{
+	return readl(GICC_BASE + GICC_IAR);
+}
+
+static void prof_gic_eoi(u32 irq)
+{
+	writel(irq, GICC_BASE + GICC_EOIR);
+}
+#else
+static int prof_gic_enable(bool enable)
+{
+	return -ENOSYS;
+}
+
+static u32 prof_gic_ack(void)
+{
+	return GIC_SPURIOUS_IRQ;
+}
+
+static void prof_gic_eoi(u32 irq)
+{
+}
+#endif
+
+static void prof_timer_set(ulong ticks, ulong ctl)
+{
+	asm volatile("msr cntv_tval_el0, %0" : : "r" (ticks));
+	asm volatile("msr cntv_ctl_el0, %0" : : "r" (ctl));
+	isb();
+}
+
+int arch_prof_start(uint hz)
+{
+	ulong freq;
+	int ret;
+
+	if (current_el() == 3)
+		return -EPERM;
+	asm volatile("mrs %0, cntfrq_el0" : "=r" (freq));
+	prof_ticks = freq / hz;
+	if (!prof_ticks)
+		return -EINVAL;
+	ret = prof_gic_enable(true);
+	if (ret)
+		return ret;
+	/* Otherwise physical IRQs go to EL1, and are never taken at EL2 */
+	if (current_el() == 2) {
+		asm volatile("mrs %0, hcr_el2" : "=r" (prof_saved_hcr));
+		asm volatile("msr hcr_el2, %0"
+			     : : "r" (prof_saved_hcr | HCR_EL2_IMO));
+		isb();
+	}
+	prof_timer_set(prof_ticks, CNTV_CTL_ENABLE);
+	asm volatile("msr daifclr, #2");
+
+	return 0;
+}
+
+void arch_prof_stop(void)
+{
+	asm volatile("msr daifset, #2");
+	prof_timer_set(0, 0);
+	prof_gic_enable(false);
+	if (current_el() == 2) {
+		asm volatile("msr hcr_el2, %0" : : "r" (prof_saved_hcr));
+		isb();
+	}
+}
+
+int armv8_prof_irq(struct pt_regs *regs)
+{
+	u32 irq = prof_gic_ack();
+
+	switch (irq & 0x3ff) {
+	case GIC_SPURIOUS_IRQ:
+		return 0;
+	case PROF_TIMER_IRQ:
+		prof_sample(regs->elr);
+		prof_timer_set(prof_ticks, CNTV_CTL_ENABLE);
+		prof_gic_eoi(irq);
+		return 0;
+	default:
+		prof_gic_eoi(irq);
+		return -ENOENT;
+	}
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SHA-1 and SHA-256 using the ARMv8 Crypto Extensions, when the CPU has them
+ */
+
+#include <common.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+/* Fields of ID_AA64ISAR0_EL1 which are non-zero if the instructions exist */
+#define ID_AA64ISAR0_SHA1_SHIFT		8
+#define ID_AA64ISAR0_SHA2_SHIFT		12
+
+void sha1_ce_transform(u32 state[5], const u8 *data, unsigned int blocks);
+void sha256_ce_transform(u32 state[8], const u8 *data, unsigned int blocks);
+
+/*
+ * Check whether the Crypto Extensions can hash this data. The ID register is
+ * read each time rather than cached, since this may run before relocation.
+ */
+static bool sha_ce_usable(int shift, const void *data)
+{
+	u64 isar0;
+
+	asm volatile("mrs %0, id_aa64isar0_el1" : "=r" (isar0));
+	if (!((isar0 >> shift) & 0xf))
+		return false;
+
+	/* With the MMU off all memory is Device type, so must be aligned */
+	return dcache_status() || !((ulong)data & 3);
+}
+
+#ifdef CONFIG_ARMV8_CE_SHA1
+void sha1_process(sha1_context *ctx, const unsigned char *data,
+		  unsigned int blocks)
+{
+	u32 state[5];
+	int i;
+
+	if (!sha_ce_usable(ID_AA64ISAR0_SHA1_SHIFT, data)) {
+		sha1_generic_process(ctx, data, blocks);
+		return;
+	}
+
+	/* The context holds each word of state in an unsigned long */
+	for (i = 0; i < ARRAY_SIZE(state); i++)
+		state[i] = ctx->state[i];
+	sha1_ce_transform(state, data, blocks);
+	for (i = 0; i < ARRAY_SIZE(state); i++)
+		ctx->state[i] = state[i];
+}
+#endif
+
+#ifdef CONFIG_ARMV8_CE_SHA256
+void sha256_process(sha256_context *ctx, const uint8_t *data,
+		    unsigned int blocks)
+{
+	if (!sha_ce_usable(ID_AA64ISAR0_SHA2_SHIFT, data)) {
+		sha256_generic_process(ctx, data, blocks);
+		return;
+	}
+
+	sha256_ce_transform(ctx->state, data, blocks);
+}
+#endif
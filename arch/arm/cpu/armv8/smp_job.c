@@ -0,0 +1,413 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on the secondary CPUs of ARMv8 systems
+ *
+ * The secondary CPUs are listed in the /cpus node of the control device
+ * tree. Each one is started using its enable-method: either PSCI CPU_ON,
+ * or by releasing it from the spin table (see spin_table_v8.S). It turns
+ * on its MMU using the same translation tables as the boot CPU, runs jobs
+ * until told to stop and is then parked again: with PSCI CPU_OFF, or by
+ * returning to the spin table with the MMU off, ready for the OS to
+ * release it in the normal way.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <errno.h>
+#include <malloc.h>
+#include <smp_job.h>
+#include <asm/psci.h>
+#include <asm/spin_table.h>
+#include <asm/system.h>
+#include <asm/armv8/mmu.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define SMP_JOB_STACK_SIZE	SZ_16K
+#define SMP_JOB_START_TIMEOUT	1000	/* ms */
+#define SMP_JOB_STOP_TIMEOUT	1000	/* ms */
+#define MPIDR_HWID_MASK		0xff00ffffffUL
+
+enum smp_job_method {
+	SMP_JOB_PSCI,
+	SMP_JOB_SPIN_TABLE,
+};
+
+enum smp_job_state {
+	SMP_JOB_CPU_STARTING,
+	SMP_JOB_CPU_RUNNING,
+	SMP_JOB_CPU_PARKED,
+};
+
+/**
+ * struct smp_job_boot - Information for a CPU which is starting up
+ *
+ * This is read by smp_job_secondary_entry with the MMU off, so the layout
+ * must match the offsets used there.
+ *
+ * @mpidr:	Affinity fields of MPIDR_EL1, or ~0 at the end of the table
+ * @sp:		Initial stack pointer
+ * @gd:		Global data pointer
+ * @cpu:	Pointer to the struct smp_job_cpu for this CPU
+ */
+struct smp_job_boot {
+	u64 mpidr;
+	u64 sp;
+	u64 gd;
+	u64 cpu;
+};
+
+/**
+ * struct smp_job_cpu - Information about a secondary CPU
+ *
+ * This is only written by the secondary CPU once its MMU is on, and is kept
+ * in its own cache line so that the boot CPU can flush its own copy safely.
+ *
+ * @mpidr:	Affinity fields of MPIDR_EL1
+ * @method:	How the CPU is started (enum smp_job_method)
+ * @state:	Current state (enum smp_job_state)
+ * @worker:	Worker number to pass to smp_job_worker()
+ * @stack:	Stack for the CPU, allocated the first time it is started
+ */
+struct smp_job_cpu {
+	u64 mpidr;
+	int method;
+	int state;
+	int worker;
+	void *stack;
+} __aligned(ARCH_DMA_MINALIGN);
+
+/**
+ * struct smp_job_regs - System registers copied from the boot CPU
+ *
+ * @el:		Exception level that U-Boot is running at
+ */
+struct smp_job_regs {
+	u64 el;
+	u64 ttbr;
+	u64 tcr;
+	u64 mair;
+	u64 vbar;
+	u64 sctlr;
+};
+
+struct smp_job_boot smp_job_boot[CONFIG_SMP_JOB_MAX_WORKERS + 1];
+static struct smp_job_cpu smp_job_cpus[CONFIG_SMP_JOB_MAX_WORKERS];
+static struct smp_job_regs smp_job_regs;
+static int smp_job_num_cpus;
+static bool smp_job_use_hvc;
+
+void smp_job_secondary_entry(void);
+
+static void smp_job_save_regs(struct smp_job_regs *regs)
+{
+	regs->el = current_el();
+	if (regs->el == 1) {
+		asm volatile("mrs %0, ttbr0_el1" : "=r" (regs->ttbr));
+		asm volatile("mrs %0, tcr_el1" : "=r" (regs->tcr));
+		asm volatile("mrs %0, mair_el1" : "=r" (regs->mair));
+		asm volatile("mrs %0, vbar_el1" : "=r" (regs->vbar));
+	} else if (regs->el == 2) {
+		asm volatile("mrs %0, ttbr0_el2" : "=r" (regs->ttbr));
+		asm volatile("mrs %0, tcr_el2" : "=r" (regs->tcr));
+		asm volatile("mrs %0, mair_el2" : "=r" (regs->mair));
+		asm volatile("mrs %0, vbar_el2" : "=r" (regs->vbar));
+	} else {
+		asm volatile("mrs %0, ttbr0_el3" : "=r" (regs->ttbr));
+		asm volatile("mrs %0, tcr_el3" : "=r" (regs->tcr));
+		asm volatile("mrs %0, mair_el3" : "=r" (regs->mair));
+		asm volatile("mrs %0, vbar_el3" : "=r" (regs->vbar));
+	}
+	regs->sctlr = get_sctlr();
+}
+
+static void smp_job_load_regs(const struct smp_job_regs *regs)
+{
+	if (regs->el == 1)
+		asm volatile("msr vbar_el1, %0" : : "r" (regs->vbar));
+	else if (regs->el == 2)
+		asm volatile("msr vbar_el2, %0" : : "r" (regs->vbar));
+	else
+		asm volatile("msr vbar_el3, %0" : : "r" (regs->vbar));
+
+	/*
+	 * The caches of this CPU were invalidated when it was reset, so it
+	 * is enough to drop any stale TLB entries before turning on the MMU
+	 * and caches.
+	 */
+	__asm_invalidate_tlb_all();
+	__asm_invalidate_icache_all();
+	set_ttbr_tcr_mair(regs->el, regs->ttbr, regs->tcr, regs->mair);
+	set_sctlr(regs->sctlr);
+}
+
+static ulong smp_job_psci(ulong fn, ulong arg0, ulong arg1, ulong arg2)
+{
+	struct pt_regs regs;
+
+	memset(&regs, '\0', sizeof(regs));
+	regs.regs[0] = fn;
+	regs.regs[1] = arg0;
+	regs.regs[2] = arg1;
+	regs.regs[3] = arg2;
+	if (smp_job_use_hvc)
+		hvc_call(&regs);
+	else
+		smc_call(&regs);
+
+	return regs.regs[0];
+}
+
+/**
+ * smp_job_secondary_main() - Run jobs on a secondary CPU
+ *
+ * This is called from smp_job_secondary_entry with the MMU off. It returns
+ * only if the CPU came from the spin table and should go back there.
+ *
+ * @cpu:	Information about this CPU
+ */
+void smp_job_secondary_main(struct smp_job_cpu *cpu)
+{
+	/*
+	 * Until the MMU is on, this CPU is not coherent with the boot CPU,
+	 * so only tables which the boot CPU has flushed may be read.
+	 */
+	if (current_el() != smp_job_regs.el)
+		goto park;
+	smp_job_load_regs(&smp_job_regs);
+
+	__atomic_store_n(&cpu->state, SMP_JOB_CPU_RUNNING, __ATOMIC_RELEASE);
+	smp_job_worker(cpu->worker);
+	__atomic_store_n(&cpu->state, SMP_JOB_CPU_PARKED, __ATOMIC_RELEASE);
+	sev();
+
+park:
+	if (cpu->method == SMP_JOB_PSCI)
+		smp_job_psci(ARM_PSCI_0_2_FN_CPU_OFF, 0, 0, 0);
+}
+
+static int smp_job_get_method(ofnode node)
+{
+	const char *method;
+
+	method = ofnode_read_string(node, "enable-method");
+	if (!method)
+		return -ENOENT;
+	if (!strcmp(method, "psci"))
+		return SMP_JOB_PSCI;
+	if (IS_ENABLED(CONFIG_ARMV8_SPIN_TABLE) &&
+	    !strcmp(method, "spin-table"))
+		return SMP_JOB_SPIN_TABLE;
+
+	return -ENOTSUPP;
+}
+
+/**
+ * smp_job_find_cpus() - Find the secondary CPUs in the device tree
+ *
+ * @max_workers:	Maximum number of CPUs to use
+ * @return number of CPUs found, or -ve on error
+ */
+static int smp_job_find_cpus(int max_workers)
+{
+	u64 self = read_mpidr() & MPIDR_HWID_MASK;
+	ofnode cpus, node;
+	int count = 0;
+	int na;
+
+	cpus = ofnode_path("/cpus");
+	if (!ofnode_valid(cpus))
+		return -ENOENT;
+	na = ofnode_read_simple_addr_cells(cpus);
+	for (node = ofnode_first_subnode(cpus);
+	     ofnode_valid(node) && count < max_workers;
+	     node = ofnode_next_subnode(node)) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[count];
+		const char *type;
+		const fdt32_t *reg;
+		int method, len;
+		u64 mpidr;
+
+		type = ofnode_read_string(node, "device_type");
+		if (!type || strcmp(type, "cpu") || !ofnode_is_available(node))
+			continue;
+		reg = ofnode_get_property(node, "reg", &len);
+		if (!reg || len < na * (int)sizeof(fdt32_t))
+			continue;
+		mpidr = fdtdec_get_number(reg, na) & MPIDR_HWID_MASK;
+		if (mpidr == self)
+			continue;
+		method = smp_job_get_method(node);
+		if (method < 0) {
+			debug("smp_job: %s: no usable enable-method\n",
+			      ofnode_get_name(node));
+			continue;
+		}
+		if (!cpu->stack) {
+			cpu->stack = memalign(16, SMP_JOB_STACK_SIZE);
+			if (!cpu->stack)
+				return -ENOMEM;
+		}
+		cpu->mpidr = mpidr;
+		cpu->method = method;
+		cpu->worker = count;
+		cpu->state = SMP_JOB_CPU_STARTING;
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * smp_job_wait_cpu() - Wait for a CPU to reach a given state
+ *
+ * @cpu:	CPU to wait for
+ * @state:	State to wait for
+ * @timeout_ms:	Timeout in milliseconds
+ * @return 0 if OK, -ETIMEDOUT on timeout
+ */
+static int smp_job_wait_cpu(struct smp_job_cpu *cpu, int state,
+			    int timeout_ms)
+{
+	ulong start = get_timer(0);
+
+	while (__atomic_load_n(&cpu->state, __ATOMIC_ACQUIRE) != state) {
+		if (get_timer(start) > timeout_ms)
+			return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+int arch_smp_job_start(int max_workers)
+{
+	ulong entry = (ulong)smp_job_secondary_entry;
+	bool spin_table = false;
+	int count, running;
+	ofnode psci;
+	int i;
+
+	/* Exclusive accesses, used for the job queue, need the cache on */
+	if (!dcache_status())
+		return -ENOSYS;
+	count = smp_job_find_cpus(max_workers);
+	if (count <= 0)
+		return count;
+
+	psci = ofnode_path("/psci");
+	smp_job_use_hvc = ofnode_valid(psci) &&
+		!strcmp(ofnode_read_string(psci, "method") ?: "", "hvc");
+	smp_job_save_regs(&smp_job_regs);
+	for (i = 0; i < count; i++) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[i];
+		struct smp_job_boot *boot = &smp_job_boot[i];
+
+		boot->mpidr = cpu->mpidr;
+		boot->sp = (ulong)cpu->stack + SMP_JOB_STACK_SIZE;
+		boot->gd = (ulong)gd;
+		boot->cpu = (ulong)cpu;
+	}
+	smp_job_boot[count].mpidr = ~0ULL;
+	smp_job_num_cpus = count;
+
+	/* The secondary CPUs read all of this with their MMU off */
+	flush_dcache_range((ulong)smp_job_boot,
+			   (ulong)(smp_job_boot + count + 1));
+	flush_dcache_range((ulong)smp_job_cpus,
+			   (ulong)(smp_job_cpus + count));
+	flush_dcache_range((ulong)&smp_job_regs,
+			   (ulong)(&smp_job_regs + 1));
+	for (i = 0; i < count; i++) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[i];
+
+		flush_dcache_range((ulong)cpu->stack,
+				   (ulong)cpu->stack + SMP_JOB_STACK_SIZE);
+	}
+
+	for (i = 0; i < count; i++) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[i];
+		ulong ret;
+
+		if (cpu->method == SMP_JOB_SPIN_TABLE) {
+			spin_table = true;
+			continue;
+		}
+		ret = smp_job_psci(ARM_PSCI_0_2_FN64_CPU_ON, cpu->mpidr,
+				   entry, 0);
+		if (ret)
+			debug("smp_job: CPU %llx: CPU_ON failed (err=%ld)\n",
+			      cpu->mpidr, (long)ret);
+	}
+#ifdef CONFIG_ARMV8_SPIN_TABLE
+	if (spin_table) {
+		spin_table_cpu_release_addr = entry;
+		flush_dcache_range((ulong)&spin_table_cpu_release_addr,
+				   (ulong)(&spin_table_cpu_release_addr + 1));
+		sev();
+	}
+#endif
+
+	for (i = 0, running = 0; i < count; i++) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[i];
+
+		if (smp_job_wait_cpu(cpu, SMP_JOB_CPU_RUNNING,
+				     SMP_JOB_START_TIMEOUT))
+			printf("smp_job: CPU %llx did not start\n", cpu->mpidr);
+		else
+			running++;
+	}
+
+#ifdef CONFIG_ARMV8_SPIN_TABLE
+	/* Leave the spin table ready for the OS to use */
+	if (spin_table) {
+		spin_table_cpu_release_addr = 0;
+		flush_dcache_range((ulong)&spin_table_cpu_release_addr,
+				   (ulong)(&spin_table_cpu_release_addr + 1));
+	}
+#endif
+
+	return running;
+}
+
+void arch_smp_job_stop(void)
+{
+	int i;
+
+	for (i = 0; i < smp_job_num_cpus; i++) {
+		struct smp_job_cpu *cpu = &smp_job_cpus[i];
+		ulong start = get_timer(0);
+
+		if (cpu->state == SMP_JOB_CPU_STARTING)
+			continue;
+		if (smp_job_wait_cpu(cpu, SMP_JOB_CPU_PARKED,
+				     SMP_JOB_STOP_TIMEOUT)) {
+			printf("smp_job: CPU %llx did not stop\n", cpu->mpidr);
+			continue;
+		}
+		if (cpu->method != SMP_JOB_PSCI)
+			continue;
+
+		/* Make sure that the CPU is really off before booting an OS */
+		while (smp_job_psci(ARM_PSCI_0_2_FN64_AFFINITY_INFO,
+				    cpu->mpidr, 0, 0) !=
+		       PSCI_AFFINITY_LEVEL_OFF) {
+			if (get_timer(start) > SMP_JOB_STOP_TIMEOUT) {
+				printf("smp_job: CPU %llx did not power off\n",
+				       cpu->mpidr);
+				break;
+			}
+		}
+	}
+	smp_job_num_cpus = 0;
+}
+
+void arch_smp_job_idle(void)
+{
+	wfe();
+}
+
+void arch_smp_job_notify(void)
+{
+	sev();
+}
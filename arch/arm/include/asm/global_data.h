@@ -41,6 +41,9 @@ struct arch_global_data {
 #if defined(CONFIG_ARM64)
 	unsigned long tlb_fillptr;
 	unsigned long tlb_emerg;
+	int tlb_start_level;	/* First page-table level, 0 or 1 */
+	uint tlb_flushes;	/* Number of full TLB invalidations */
+	uint tlb_blocks[4];	/* Block/page entries created per level */
 #endif
 #endif
 #ifdef CONFIG_SYS_MEM_RESERVE_SECURE
@@ -77,6 +77,27 @@ lr	.req	x30
 	b.eq	\el1_label
 .endm
 
+/*
+ * Branch if memory may only be accessed with naturally aligned loads and
+ * stores: either the MMU is off, so that all data accesses are to Device
+ * memory, or alignment checking is enabled.
+ */
+.macro	branch_if_strict_align, xreg, label
+	switch_el \xreg, .Lsa_el3_\@, .Lsa_el2_\@, .Lsa_el1_\@
+.Lsa_el3_\@:
+	mrs	\xreg, sctlr_el3
+	b	.Lsa_check_\@
+.Lsa_el2_\@:
+	mrs	\xreg, sctlr_el2
+	b	.Lsa_check_\@
+.Lsa_el1_\@:
+	mrs	\xreg, sctlr_el1
+.Lsa_check_\@:
+	and	\xreg, \xreg, #(CR_M | CR_A)
+	cmp	\xreg, #CR_M
+	b.ne	\label
+.endm
+
 /*
  * Branch if current processor is a Cortex-A57 core.
  */
@@ -79,6 +79,7 @@
 #define HCR_EL2_RW_AARCH64	(1 << 31) /* EL1 is AArch64                   */
 #define HCR_EL2_RW_AARCH32	(0 << 31) /* Lower levels are AArch32         */
 #define HCR_EL2_HCD_DIS		(1 << 29) /* Hypervisor Call disabled         */
+#define HCR_EL2_IMO		(1 << 4)  /* IRQs are taken to EL2            */
 
 /*
  * CPACR_EL1 bits definitions
@@ -130,6 +131,16 @@ enum dcache_option {
 	"wfi" : : : "memory");		\
 	})
 
+#define wfe()				\
+	({asm volatile(			\
+	"wfe" : : : "memory");		\
+	})
+
+#define sev()				\
+	({asm volatile(			\
+	"sev" : : : "memory");		\
+	})
+
 static inline unsigned int current_el(void)
 {
 	unsigned int el;
@@ -253,6 +264,22 @@ void mmu_change_region_attr(phys_addr_t start, size_t size, u64 attrs);
  */
 void smc_call(struct pt_regs *args);
 
+/**
+ * Issue a hypervisor call
+ *
+ * @args: input and output arguments
+ */
+void hvc_call(struct pt_regs *args);
+
+/**
+ * armv8_prof_irq() - Handle an interrupt for the sampling profiler
+ *
+ * @regs: Registers at the time of the interrupt
+ * @return 0 if the interrupt was handled, -ENOENT if it was not for the
+ *	profiler
+ */
+int armv8_prof_irq(struct pt_regs *regs);
+
 void __noreturn psci_system_reset(void);
 void __noreturn psci_system_off(void);
 
@@ -102,6 +102,11 @@ void do_sync(struct pt_regs *pt_regs, unsigned int esr)
 void do_irq(struct pt_regs *pt_regs, unsigned int esr)
 {
 	efi_restore_gd();
+#if CONFIG_IS_ENABLED(PROF)
+	/* The sampling profiler is the only user of interrupts */
+	if (!armv8_prof_irq(pt_regs))
+		return;
+#endif
 	printf("\"Irq\" handler, esr 0x%08x\n", esr);
 	show_regs(pt_regs);
 	panic("Resetting CPU ...\n");
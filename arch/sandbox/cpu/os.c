@@ -3,11 +3,16 @@
  * Copyright (c) 2011 The Chromium OS Authors.
  */
 
+/* Needed for the register names in ucontext_t */
+#define _GNU_SOURCE
+
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <setjmp.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -262,6 +267,102 @@ void os_usleep(unsigned long usec)
 	usleep(usec);
 }
 
+struct os_thread {
+	pthread_t thread;
+	void (*func)(void *arg);
+	void *arg;
+};
+
+static void *os_thread_main(void *data)
+{
+	struct os_thread *thread = data;
+
+	thread->func(thread->arg);
+
+	return NULL;
+}
+
+void *os_thread_create(void (*func)(void *arg), void *arg)
+{
+	struct os_thread *thread;
+
+	thread = os_malloc(sizeof(*thread));
+	if (!thread)
+		return NULL;
+	thread->func = func;
+	thread->arg = arg;
+	if (pthread_create(&thread->thread, NULL, os_thread_main, thread)) {
+		os_free(thread);
+		return NULL;
+	}
+
+	return thread;
+}
+
+void os_thread_join(void *handle)
+{
+	struct os_thread *thread = handle;
+
+	pthread_join(thread->thread, NULL);
+	os_free(thread);
+}
+
+static void (*os_prof_func)(unsigned long pc);
+
+static void os_prof_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	unsigned long pc;
+
+#if defined(__x86_64__)
+	pc = uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+	pc = uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+	pc = uc->uc_mcontext.pc;
+#else
+	pc = 0;
+#endif
+	os_prof_func(pc);
+}
+
+static int os_prof_set_timer(unsigned int hz)
+{
+	struct itimerval val;
+
+	memset(&val, '\0', sizeof(val));
+	if (hz) {
+		val.it_interval.tv_sec = 0;
+		val.it_interval.tv_usec = 1000000 / hz ? 1000000 / hz : 1;
+		val.it_value = val.it_interval;
+	}
+
+	return setitimer(ITIMER_PROF, &val, NULL);
+}
+
+int os_prof_start(unsigned int hz, void (*func)(unsigned long pc))
+{
+	struct sigaction act;
+
+	os_prof_func = func;
+	memset(&act, '\0', sizeof(act));
+	act.sa_sigaction = os_prof_handler;
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGPROF, &act, NULL))
+		return -errno;
+	if (os_prof_set_timer(hz))
+		return -errno;
+
+	return 0;
+}
+
+void os_prof_stop(void)
+{
+	os_prof_set_timer(0);
+	signal(SIGPROF, SIG_IGN);
+}
+
 uint64_t __attribute__((no_instrument_function)) os_get_nsec(void)
 {
 #if defined(CLOCK_MONOTONIC) && defined(_POSIX_MONOTONIC_CLOCK)
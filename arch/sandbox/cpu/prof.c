@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler: sandbox uses the host's SIGPROF timer
+ */
+
+#include <common.h>
+#include <os.h>
+#include <prof.h>
+
+int arch_prof_start(uint hz)
+{
+	return os_prof_start(hz, prof_sample);
+}
+
+void arch_prof_stop(void)
+{
+	os_prof_stop();
+}
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on secondary CPUs: sandbox uses a host thread for each one
+ */
+
+#include <common.h>
+#include <os.h>
+#include <smp_job.h>
+
+static void *threads[CONFIG_SMP_JOB_MAX_WORKERS];
+static int num_threads;
+
+static void sandbox_smp_job_thread(void *arg)
+{
+	smp_job_worker((long)arg);
+}
+
+int arch_smp_job_start(int max_workers)
+{
+	int i;
+
+	for (i = 0; i < max_workers && i < ARRAY_SIZE(threads); i++) {
+		threads[i] = os_thread_create(sandbox_smp_job_thread,
+					      (void *)(long)i);
+		if (!threads[i])
+			break;
+	}
+	num_threads = i;
+
+	return num_threads;
+}
+
+void arch_smp_job_stop(void)
+{
+	int i;
+
+	for (i = 0; i < num_threads; i++)
+		os_thread_join(threads[i]);
+	num_threads = 0;
+}
+
+void arch_smp_job_idle(void)
+{
+	/* Sleep rather than spin, since the host may have fewer CPUs */
+	os_usleep(10);
+}
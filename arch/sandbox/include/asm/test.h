@@ -161,4 +161,18 @@ int sandbox_get_setup_called(struct udevice *dev);
  */
 int sandbox_get_sound_sum(struct udevice *dev);
 
+/**
+ * sandbox_dma_get_async_stats() - Read and reset asynchronous DMA statistics
+ *
+ * The sandbox DMA engine moves data at a fixed rate in the background. This
+ * reports how much of the data it moved while the CPU was doing something
+ * else, and how much remained when the CPU had to stop and wait for it.
+ *
+ * @dev: DMA device to check
+ * @overlapp: Returns the number of bytes moved before dma_async_wait()
+ * @stallp: Returns the number of bytes moved within dma_async_wait()
+ */
+void sandbox_dma_get_async_stats(struct udevice *dev, ulong *overlapp,
+				 ulong *stallp);
+
 #endif
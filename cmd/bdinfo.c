@@ -323,6 +323,12 @@ static int do_bdinfo(cmd_tbl_t *cmdtp, int flag, int argc,
 	print_baudrate();
 #if !(defined(CONFIG_SYS_ICACHE_OFF) && defined(CONFIG_SYS_DCACHE_OFF))
 	print_num("TLB addr", gd->arch.tlb_addr);
+#ifdef CONFIG_ARM64
+	printf("TLB flushes = %u\n", gd->arch.tlb_flushes);
+	printf("PT blocks   = %u x 1G, %u x 2M, %u x 4K\n",
+	       gd->arch.tlb_blocks[1], gd->arch.tlb_blocks[2],
+	       gd->arch.tlb_blocks[3]);
+#endif
 #endif
 	print_num("relocaddr", gd->relocaddr);
 	print_num("reloc off", gd->reloc_off);
@@ -43,6 +43,28 @@ U_BOOT_CMD(
 	"      If 'pos' is 0 or omitted, the file is read from the start."
 )
 
+#ifdef CONFIG_CMD_LOADZ
+static int do_loadz_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	efi_set_bootdev(argv[1], (argc > 2) ? argv[2] : "",
+			(argc > 4) ? argv[4] : "");
+	return do_loadz(cmdtp, flag, argc, argv, FS_TYPE_ANY);
+}
+
+U_BOOT_CMD(
+	loadz,	6,	0,	do_loadz_wrapper,
+	"load and uncompress a gzipped file from a filesystem",
+	"<interface> [<dev[:part]> [<addr> [<filename> [bytes]]]]\n"
+	"    - Load gzipped file 'filename' from partition 'part' on device\n"
+	"       type 'interface' instance 'dev' and uncompress it to address\n"
+	"       'addr' in memory, as it is read.\n"
+	"      'bytes' gives the maximum uncompressed size in bytes.\n"
+	"      If 'bytes' is 0 or omitted, it is limited by the free memory\n"
+	"      at 'addr'."
+)
+#endif
+
 static int do_save_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
 				char * const argv[])
 {
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Benchmark comparing the generic and architecture-specific SHA block functions
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <div64.h>
+#include <linux/sizes.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+#define HASHBENCH_DEF_SIZE	SZ_1M
+#define HASHBENCH_DEF_ITER	4
+
+struct hashbench_algo {
+	const char *name;
+	/* Process blocks with the default (possibly accelerated) backend */
+	void (*process)(void *ctx, const void *data, unsigned int blocks);
+	/* Process blocks with the portable C backend */
+	void (*generic)(void *ctx, const void *data, unsigned int blocks);
+	/* Set up a context; return its size so the results can be compared */
+	int (*init)(void *ctx);
+};
+
+#ifdef CONFIG_SHA1
+static void hashbench_sha1(void *ctx, const void *data, unsigned int blocks)
+{
+	sha1_process(ctx, data, blocks);
+}
+
+static void hashbench_sha1_generic(void *ctx, const void *data,
+				   unsigned int blocks)
+{
+	sha1_generic_process(ctx, data, blocks);
+}
+
+static int hashbench_sha1_init(void *ctx)
+{
+	memset(ctx, '\0', sizeof(sha1_context));
+	sha1_starts(ctx);
+
+	return sizeof(sha1_context);
+}
+#endif
+
+#ifdef CONFIG_SHA256
+static void hashbench_sha256(void *ctx, const void *data, unsigned int blocks)
+{
+	sha256_process(ctx, data, blocks);
+}
+
+static void hashbench_sha256_generic(void *ctx, const void *data,
+				     unsigned int blocks)
+{
+	sha256_generic_process(ctx, data, blocks);
+}
+
+static int hashbench_sha256_init(void *ctx)
+{
+	memset(ctx, '\0', sizeof(sha256_context));
+	sha256_starts(ctx);
+
+	return sizeof(sha256_context);
+}
+#endif
+
+static const struct hashbench_algo hashbench_algos[] = {
+#ifdef CONFIG_SHA1
+	{ "sha1", hashbench_sha1, hashbench_sha1_generic,
+		hashbench_sha1_init },
+#endif
+#ifdef CONFIG_SHA256
+	{ "sha256", hashbench_sha256, hashbench_sha256_generic,
+		hashbench_sha256_init },
+#endif
+};
+
+union hashbench_ctx {
+#ifdef CONFIG_SHA1
+	sha1_context sha1;
+#endif
+#ifdef CONFIG_SHA256
+	sha256_context sha256;
+#endif
+};
+
+/**
+ * hashbench_run() - Hash the buffer repeatedly and return the throughput
+ *
+ * @process:	Block function to use
+ * @ctx:	Context to update
+ * @buf:	Data to hash
+ * @size:	Number of bytes to hash in each iteration, a multiple of 64
+ * @iter:	Number of iterations
+ * @return throughput in MB/s (10^6 bytes per second)
+ */
+static ulong hashbench_run(void (*process)(void *ctx, const void *data,
+					   unsigned int blocks),
+			   void *ctx, const char *buf, ulong size, ulong iter)
+{
+	ulong start, us, i;
+
+	start = timer_get_us();
+	for (i = 0; i < iter; i++)
+		process(ctx, buf, size / 64);
+	us = timer_get_us() - start;
+
+	return lldiv((u64)size * iter, max(us, 1UL));
+}
+
+static int do_hashbench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	union hashbench_ctx generic, ctx;
+	ulong size = HASHBENCH_DEF_SIZE;
+	ulong iter = HASHBENCH_DEF_ITER;
+	int ret = CMD_RET_SUCCESS;
+	char *buf;
+	int i;
+
+	if (argc > 1)
+		size = simple_strtoul(argv[1], NULL, 16) & ~0x3fUL;
+	if (argc > 2)
+		iter = simple_strtoul(argv[2], NULL, 10);
+	if (!size || !iter)
+		return CMD_RET_USAGE;
+
+	buf = malloc(size);
+	if (!buf) {
+		printf("Cannot allocate %#lx bytes\n", size);
+		return CMD_RET_FAILURE;
+	}
+	for (i = 0; i < size; i++)
+		buf[i] = i * 7;
+
+	printf("Size %#lx bytes, %lu iterations\n", size, iter);
+	printf("%-8s %10s %10s\n", "", "generic", "default");
+	for (i = 0; i < ARRAY_SIZE(hashbench_algos); i++) {
+		const struct hashbench_algo *algo = &hashbench_algos[i];
+		ulong generic_rate, rate;
+		int ctx_size;
+
+		ctx_size = algo->init(&generic);
+		algo->init(&ctx);
+		generic_rate = hashbench_run(algo->generic, &generic, buf,
+					     size, iter);
+		rate = hashbench_run(algo->process, &ctx, buf, size, iter);
+		printf("%-8s %5lu MB/s %5lu MB/s\n", algo->name, generic_rate,
+		       rate);
+		if (memcmp(&generic, &ctx, ctx_size)) {
+			printf("%s: backends produced different results\n",
+			       algo->name);
+			ret = CMD_RET_FAILURE;
+		}
+	}
+	free(buf);
+
+	return ret;
+}
+
+U_BOOT_CMD(hashbench, 3, 0, do_hashbench,
+	"compare the speed of the SHA1/SHA256 implementations",
+	"[size [iterations]]\n"
+	"    - hash 'size' (hex) bytes 'iterations' times with the generic\n"
+	"      C code and with the default (possibly accelerated) code"
+);
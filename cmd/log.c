@@ -94,6 +94,24 @@ static int do_log_rec(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	return 0;
 }
 
+#ifdef CONFIG_LOG_RING
+static int do_log_dump(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	log_ring_dump();
+
+	return 0;
+}
+
+static int do_log_flush(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	log_flush();
+
+	return 0;
+}
+#endif
+
 static cmd_tbl_t log_sub[] = {
 	U_BOOT_CMD_MKENT(level, CONFIG_SYS_MAXARGS, 1, do_log_level, "", ""),
 #ifdef CONFIG_LOG_TEST
@@ -101,6 +119,10 @@ static cmd_tbl_t log_sub[] = {
 #endif
 	U_BOOT_CMD_MKENT(format, CONFIG_SYS_MAXARGS, 1, do_log_format, "", ""),
 	U_BOOT_CMD_MKENT(rec, CONFIG_SYS_MAXARGS, 1, do_log_rec, "", ""),
+#ifdef CONFIG_LOG_RING
+	U_BOOT_CMD_MKENT(dump, 1, 1, do_log_dump, "", ""),
+	U_BOOT_CMD_MKENT(flush, 1, 1, do_log_flush, "", ""),
+#endif
 };
 
 static int do_log(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
@@ -133,6 +155,10 @@ static char log_help_text[] =
 	"\tor 'default', equivalent to 'fm', or 'all' for all\n"
 	"log rec <category> <level> <file> <line> <func> <message> - "
 		"output a log record"
+#ifdef CONFIG_LOG_RING
+	"\nlog dump - show all records in the log ring, with timestamps\n"
+	"log flush - output any deferred log records"
+#endif
 	;
 #endif
 
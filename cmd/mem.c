@@ -16,6 +16,7 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <dma.h>
 #include <hash.h>
 #include <mapmem.h>
 #include <watchdog.h>
@@ -343,7 +344,14 @@ static int do_mem_cp(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	}
 #endif
 
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+	if (dma_memmove((void *)dest, (void *)addr, count * size)) {
+		puts("DMA copy failed\n");
+		return 1;
+	}
+#else
 	memcpy((void *)dest, (void *)addr, count * size);
+#endif
 
 	return 0;
 }
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Memory bandwidth benchmark for the mem*() string functions
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <div64.h>
+#include <linux/sizes.h>
+
+#define MEMBENCH_DEF_SIZE	SZ_1M
+#define MEMBENCH_DEF_ITER	16
+
+enum membench_op {
+	MEMBENCH_MEMCPY,
+	MEMBENCH_MEMMOVE,
+	MEMBENCH_MEMSET,
+	MEMBENCH_MEMCMP,
+};
+
+struct membench_test {
+	const char *name;
+	enum membench_op op;
+	int dst_offset;
+	int src_offset;
+};
+
+static const struct membench_test membench_tests[] = {
+	{ "memcpy",		MEMBENCH_MEMCPY, 0, 0 },
+	{ "memcpy unaligned",	MEMBENCH_MEMCPY, 1, 3 },
+	{ "memmove overlap",	MEMBENCH_MEMMOVE, 0, 64 },
+	{ "memset",		MEMBENCH_MEMSET, 0, 0 },
+	{ "memset zero",	MEMBENCH_MEMSET, 0, -1 },
+	{ "memcmp",		MEMBENCH_MEMCMP, 0, 0 },
+};
+
+/**
+ * membench_run() - Run one test and return the bandwidth
+ *
+ * @test:	Test to run
+ * @dst:	Destination buffer
+ * @src:	Source buffer, of the same size
+ * @size:	Number of bytes to process in each iteration
+ * @iter:	Number of iterations
+ * @return bandwidth in MB/s (10^6 bytes per second)
+ */
+static ulong membench_run(const struct membench_test *test, char *dst,
+			  char *src, ulong size, ulong iter)
+{
+	ulong start, us, i;
+
+	dst += test->dst_offset;
+	if (test->src_offset > 0)
+		src += test->src_offset;
+	start = timer_get_us();
+	for (i = 0; i < iter; i++) {
+		switch (test->op) {
+		case MEMBENCH_MEMCPY:
+			memcpy(dst, src, size);
+			break;
+		case MEMBENCH_MEMMOVE:
+			memmove(dst, dst + test->src_offset, size);
+			break;
+		case MEMBENCH_MEMSET:
+			memset(dst, test->src_offset < 0 ? 0 : 0xa5, size);
+			break;
+		case MEMBENCH_MEMCMP:
+			/* Make sure the compare reads the whole buffer */
+			if (memcmp(dst, src, size))
+				return 0;
+			break;
+		}
+	}
+	us = timer_get_us() - start;
+
+	return lldiv((u64)size * iter, max(us, 1UL));
+}
+
+static int do_membench(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	ulong size = MEMBENCH_DEF_SIZE;
+	ulong iter = MEMBENCH_DEF_ITER;
+	char *dst, *src;
+	int i;
+
+	if (argc > 1)
+		size = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		iter = simple_strtoul(argv[2], NULL, 10);
+	if (!size || !iter)
+		return CMD_RET_USAGE;
+
+	/* Allow room for the offsets used by the tests */
+	dst = malloc(size + 128);
+	src = malloc(size + 128);
+	if (!dst || !src) {
+		printf("Cannot allocate 2 x %#lx bytes\n", size);
+		free(dst);
+		free(src);
+		return CMD_RET_FAILURE;
+	}
+	memset(src, 0x5a, size + 128);
+	memset(dst, 0x5a, size + 128);
+
+	printf("Size %#lx bytes, %lu iterations\n", size, iter);
+	for (i = 0; i < ARRAY_SIZE(membench_tests); i++) {
+		const struct membench_test *test = &membench_tests[i];
+
+		if (test->op == MEMBENCH_MEMCMP)
+			memcpy(dst, src, size);
+		printf("%-18s %8lu MB/s\n", test->name,
+		       membench_run(test, dst, src, size, iter));
+	}
+	free(dst);
+	free(src);
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(membench, 3, 0, do_membench,
+	"measure memcpy/memmove/memset/memcmp bandwidth",
+	"[size [iterations]]\n"
+	"    - run each function 'iterations' times over 'size' (hex) bytes"
+);
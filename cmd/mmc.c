@@ -10,6 +10,7 @@
 #include <mmc.h>
 #include <sparse_format.h>
 #include <image-sparse.h>
+#include <linux/math64.h>
 
 static int curr_device = -1;
 
@@ -374,11 +375,27 @@ static int do_mmc_sparse_write(cmd_tbl_t *cmdtp, int flag,
 #endif
 
 #if CONFIG_IS_ENABLED(MMC_WRITE)
+/* Show the outcome of a write or erase and how long it took */
+static void mmc_print_result(struct mmc *mmc, const char *op, u32 n, u32 cnt,
+			     ulong time)
+{
+	printf("%d blocks %s: %s in %lu ms", n, op,
+	       (n == cnt) ? "OK" : "ERROR", time);
+	if (time > 0) {
+		puts(" (");
+		print_size(div_u64((u64)n * mmc_get_blk_desc(mmc)->blksz,
+				   time) * 1000, "/s");
+		puts(")");
+	}
+	puts("\n");
+}
+
 static int do_mmc_write(cmd_tbl_t *cmdtp, int flag,
 			int argc, char * const argv[])
 {
 	struct mmc *mmc;
 	u32 blk, cnt, n;
+	ulong time;
 	void *addr;
 
 	if (argc != 4)
@@ -399,8 +416,9 @@ static int do_mmc_write(cmd_tbl_t *cmdtp, int flag,
 		printf("Error: card is write protected!\n");
 		return CMD_RET_FAILURE;
 	}
+	time = get_timer(0);
 	n = blk_dwrite(mmc_get_blk_desc(mmc), blk, cnt, addr);
-	printf("%d blocks written: %s\n", n, (n == cnt) ? "OK" : "ERROR");
+	mmc_print_result(mmc, "written", n, cnt, get_timer(time));
 
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
 }
@@ -409,6 +427,7 @@ static int do_mmc_erase(cmd_tbl_t *cmdtp, int flag,
 {
 	struct mmc *mmc;
 	u32 blk, cnt, n;
+	ulong time;
 
 	if (argc != 3)
 		return CMD_RET_USAGE;
@@ -427,8 +446,9 @@ static int do_mmc_erase(cmd_tbl_t *cmdtp, int flag,
 		printf("Error: card is write protected!\n");
 		return CMD_RET_FAILURE;
 	}
+	time = get_timer(0);
 	n = blk_derase(mmc_get_blk_desc(mmc), blk, cnt);
-	printf("%d blocks erased: %s\n", n, (n == cnt) ? "OK" : "ERROR");
+	mmc_print_result(mmc, "erased", n, cnt, get_timer(time));
 
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
 }
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Control of the sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <mapmem.h>
+#include <prof.h>
+
+static int do_prof_start(cmd_tbl_t *cmdtp, int flag, int argc,
+			 char * const argv[])
+{
+	uint hz = PROF_DEFAULT_HZ;
+	int ret;
+
+	if (argc > 1)
+		hz = simple_strtoul(argv[1], NULL, 10);
+	ret = prof_start(hz);
+	if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_prof_stop(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	prof_stop();
+
+	return 0;
+}
+
+static int do_prof_dump(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	size_t buff_size, used;
+	uint needed;
+	void *buff;
+	int ret;
+
+	if (argc < 3) {
+		prof_print_report(argc > 1 ? simple_strtoul(argv[1], NULL, 10) :
+				  20);
+		return 0;
+	}
+
+	buff_size = simple_strtoul(argv[2], NULL, 16);
+	buff = map_sysmem(simple_strtoul(argv[1], NULL, 16), buff_size);
+	ret = prof_list_samples(buff, buff_size, &needed);
+	if (ret)
+		printf("Error: truncated (%#x bytes needed)\n", needed);
+	used = min(buff_size, (size_t)needed);
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff), used);
+	env_set_hex("filesize", used);
+	unmap_sysmem(buff);
+
+	return 0;
+}
+
+static cmd_tbl_t prof_sub[] = {
+	U_BOOT_CMD_MKENT(start, 2, 1, do_prof_start, "", ""),
+	U_BOOT_CMD_MKENT(stop, 1, 1, do_prof_stop, "", ""),
+	U_BOOT_CMD_MKENT(dump, 3, 1, do_prof_dump, "", ""),
+};
+
+static int do_prof(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	cmd_tbl_t *cp;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* drop initial "prof" arg */
+	argc--;
+	argv++;
+
+	cp = find_cmd_tbl(argv[0], prof_sub, ARRAY_SIZE(prof_sub));
+	if (cp)
+		return cp->cmd(cmdtp, flag, argc, argv);
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	prof, 4, 1, do_prof,
+	"sampling profiler",
+	"start [<hz>]        - start sampling (default 1000 per second)\n"
+	"prof stop                - stop sampling\n"
+	"prof dump [<count>]      - show where most samples were taken\n"
+	"prof dump <addr> <size>  - write samples to memory for proftool"
+);
@@ -7,16 +7,28 @@
 #include <common.h>
 #include <dm.h>
 #include <spl.h>
+#include <warm_state.h>
 #include <asm/state.h>
 
 static int do_sb_handoff(cmd_tbl_t *cmdtp, int flag, int argc,
 			 char *const argv[])
 {
 #if CONFIG_IS_ENABLED(HANDOFF)
+#if CONFIG_IS_ENABLED(WARM_STATE)
+	const ulong *magic;
+#endif
+
 	if (gd->spl_handoff)
 		printf("SPL handoff magic %lx\n", gd->spl_handoff->arch.magic);
 	else
 		printf("SPL handoff info not received\n");
+#if CONFIG_IS_ENABLED(WARM_STATE)
+	magic = warm_state_find(UCLASS_ROOT, 0, sizeof(*magic));
+	if (magic)
+		printf("SPL warm state magic %lx\n", *magic);
+	else
+		printf("SPL warm state not received\n");
+#endif
 
 	return 0;
 #else
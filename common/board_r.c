@@ -153,6 +153,10 @@ static int initr_reloc_global_data(void)
 	 */
 	gd->fdt_blob += gd->reloc_off;
 #endif
+#if CONFIG_IS_ENABLED(OF_PHANDLE_CACHE)
+	/* The cache was allocated from the pre-relocation heap */
+	gd->phandle_cache = NULL;
+#endif
 #ifdef CONFIG_EFI_LOADER
 	efi_runtime_relocate(gd->relocaddr, NULL);
 #endif
@@ -13,6 +13,8 @@
 #include <lmb.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <prof.h>
+#include <smp_job.h>
 #include <asm/io.h>
 #include <linux/lzo.h>
 #include <lzma/LzmaTypes.h>
@@ -56,19 +58,60 @@ static void boot_start_lmb(bootm_headers_t *images)
 	ulong		mem_start;
 	phys_size_t	mem_size;
 
-	lmb_init(&images->lmb);
-
 	mem_start = env_get_bootm_low();
 	mem_size = env_get_bootm_size();
 
-	lmb_add(&images->lmb, (phys_addr_t)mem_start, mem_size);
+	lmb_init_and_reserve(&images->lmb, (phys_addr_t)mem_start, mem_size);
+}
 
-	arch_lmb_reserve(&images->lmb);
-	board_lmb_reserve(&images->lmb);
+/**
+ * bootm_move_comp() - Move compressed data out of the way of decompression
+ *
+ * Decompressing over the compressed data corrupts it, so the two would
+ * otherwise have to be placed apart by hand. If they overlap, use lmb to
+ * find memory which is not in use, and move the compressed data there
+ * first. The image is left where it is if there is no such memory.
+ *
+ * @images:	Images being booted
+ * @load:	Address to decompress to
+ * @image_bufp:	Compressed data, updated if it is moved
+ * @image_len:	Size of the compressed data in bytes
+ */
+static void bootm_move_comp(bootm_headers_t *images, ulong load,
+			    void **image_bufp, ulong image_len)
+{
+	ulong image_start = map_to_sysmem(*image_bufp);
+	struct lmb lmb = images->lmb;
+	phys_addr_t scratch;
+
+	if (images->os.comp == IH_COMP_NONE ||
+	    image_start >= load + CONFIG_SYS_BOOTM_LEN ||
+	    image_start + image_len <= load)
+		return;
+
+	/* Keep clear of the decompressed image and the rest of the blob */
+	lmb_reserve(&lmb, load, CONFIG_SYS_BOOTM_LEN);
+	lmb_reserve(&lmb, image_start, image_len);
+	if (images->os.end > images->os.start)
+		lmb_reserve(&lmb, images->os.start,
+			    images->os.end - images->os.start);
+	scratch = __lmb_alloc_base(&lmb, image_len, ARCH_DMA_MINALIGN,
+				   LMB_ALLOC_ANYWHERE);
+	if (!scratch) {
+		debug("No space to move compressed image away from %08lx\n",
+		      load);
+		return;
+	}
+	debug("   Moving compressed image to %08llx\n",
+	      (unsigned long long)scratch);
+	*image_bufp = map_sysmem(scratch, image_len);
+	memcpy(*image_bufp, map_sysmem(image_start, image_len), image_len);
 }
 #else
 #define lmb_reserve(lmb, base, size)
 static inline void boot_start_lmb(bootm_headers_t *images) { }
+static inline void bootm_move_comp(bootm_headers_t *images, ulong load,
+				   void **image_bufp, ulong image_len) { }
 #endif
 
 static int bootm_start(cmd_tbl_t *cmdtp, int flag, int argc,
@@ -460,6 +503,7 @@ static int bootm_load_os(bootm_headers_t *images, int boot_progress)
 
 	load_buf = map_sysmem(load, 0);
 	image_buf = map_sysmem(os.image_start, image_len);
+	bootm_move_comp(images, load, &image_buf, image_len);
 	err = bootm_decomp_image(os.comp, load, os.image_start, os.type,
 				 load_buf, image_buf, image_len,
 				 CONFIG_SYS_BOOTM_LEN, &load_end);
@@ -519,6 +563,15 @@ ulong bootm_disable_interrupts(void)
 	 * recover from any failures any more...
 	 */
 	iflag = disable_interrupts();
+
+	/* Park any secondary CPUs which have been running jobs */
+	smp_job_stop();
+
+	/* The profiler's timer interrupt must not reach the OS */
+	prof_stop();
+
+	/* Show any deferred log output while we still can */
+	log_flush();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
 	eth_halt();
@@ -681,8 +734,10 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 #endif
 
 	/* From now on, we need the OS boot function */
-	if (ret)
+	if (ret) {
+		boot_ramdisk_wait();
 		return ret;
+	}
 	boot_fn = bootm_os_get_boot_func(images->os.os);
 	need_boot_fn = states & (BOOTM_STATE_OS_CMDLINE |
 			BOOTM_STATE_OS_BD_T | BOOTM_STATE_OS_PREP |
@@ -693,6 +748,7 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		printf("ERROR: booting os '%s' (%d) is not supported\n",
 		       genimg_get_os_name(images->os.os), images->os.os);
 		bootstage_error(BOOTSTAGE_ID_CHECK_BOOT_OS);
+		boot_ramdisk_wait();
 		return 1;
 	}
 
@@ -710,6 +766,12 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		ret = boot_fn(BOOTM_STATE_OS_PREP, argc, argv, images);
 	}
 
+	/*
+	 * A DMA copy of the ramdisk may still be running. Nothing above reads
+	 * the ramdisk, so it only has to be finished before the OS starts.
+	 */
+	boot_ramdisk_wait();
+
 #ifdef CONFIG_TRACE
 	/* Pretend to run the OS, then run a user command */
 	if (!ret && (states & BOOTM_STATE_OS_FAKE_GO)) {
@@ -530,7 +530,12 @@ int cli_readline_into_buffer(const char *const prompt, char *buffer,
 	unsigned int len = CONFIG_SYS_CBSIZE;
 	int rc;
 	static int initted;
+#endif
+
+	/* We are waiting for input, so show any deferred log output */
+	log_flush();
 
+#ifdef CONFIG_CMDLINE_EDITING
 	/*
 	 * History uses a global array which is not
 	 * writable until after relocation to RAM.
@@ -610,6 +610,9 @@ void mem_malloc_init(ulong start, ulong size)
 	memset((void *)mem_malloc_start, 0x0, size);
 #endif
 	malloc_bin_reloc();
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	malloc_slab_reset();
+#endif
 }
 
 /* field-extraction macros */
@@ -1234,9 +1237,9 @@ static void malloc_extend_top(nb) INTERNAL_SIZE_T nb;
 */
 
 #if __STD_C
-Void_t* mALLOc(size_t bytes)
+static Void_t* chunk_alloc(size_t bytes)
 #else
-Void_t* mALLOc(bytes) size_t bytes;
+static Void_t* chunk_alloc(bytes) size_t bytes;
 #endif
 {
   mchunkptr victim;                  /* inspected/selected chunk */
@@ -1483,6 +1486,30 @@ Void_t* mALLOc(bytes) size_t bytes;
 
 
 
+/*
+  malloc() passes small requests to the slab allocator, if enabled. Code
+  in this file which needs a real chunk calls chunk_alloc() directly.
+*/
+
+#if __STD_C
+Void_t* mALLOc(size_t bytes)
+#else
+Void_t* mALLOc(bytes) size_t bytes;
+#endif
+{
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	if (bytes <= MALLOC_SLAB_MAX &&
+	    (gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+		Void_t *mem = malloc_slab_alloc(bytes);
+
+		if (mem)
+			return mem;
+	}
+#endif
+
+  return chunk_alloc(bytes);
+}
+
 /*
 
   free() algorithm :
@@ -1531,6 +1558,11 @@ void fREe(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	if (malloc_slab_free(mem))
+		return;
+#endif
+
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -1689,6 +1721,20 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 	}
 #endif
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	if (malloc_slab_owns(oldmem)) {
+		oldsize = malloc_slab_usable_size(oldmem);
+		if (bytes <= oldsize)
+			return oldmem;
+		newmem = mALLOc(bytes);
+		if (!newmem)
+			return NULL;
+		memcpy(newmem, oldmem, oldsize);
+		malloc_slab_free(oldmem);
+		return newmem;
+	}
+#endif
+
   newp    = oldp    = mem2chunk(oldmem);
   newsize = oldsize = chunksize(oldp);
 
@@ -1705,7 +1751,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
     /* Note the extra SIZE_SZ overhead. */
     if(oldsize - SIZE_SZ >= nb) return oldmem; /* do nothing */
     /* Must alloc, copy, free. */
-    newmem = mALLOc(bytes);
+    newmem = chunk_alloc(bytes);
     if (!newmem)
 	return NULL; /* propagate failure */
     MALLOC_COPY(newmem, oldmem, oldsize - 2*SIZE_SZ);
@@ -1808,7 +1854,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 
     /* Must allocate */
 
-    newmem = mALLOc (bytes);
+    newmem = chunk_alloc(bytes);
 
     if (newmem == NULL)  /* propagate failure */
       return NULL;
@@ -1909,7 +1955,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
   /* Call malloc with worst case padding to hit alignment. */
 
   nb = request2size(bytes);
-  m  = (char*)(mALLOc(nb + alignment + MINSIZE));
+  m  = (char*)(chunk_alloc(nb + alignment + MINSIZE));
 
   /*
   * The attempt to over-allocate (with a size large enough to guarantee the
@@ -1925,7 +1971,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
      * Use bytes not nb, since mALLOc internally calls request2size too, and
      * each call increases the size to allocate, to account for the header.
      */
-    m  = (char*)(mALLOc(bytes));
+    m  = (char*)(chunk_alloc(bytes));
     /* Aligned -> return it */
     if ((((unsigned long)(m)) % alignment) == 0)
       return m;
@@ -1936,7 +1982,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
     fREe(m);
     /* Add in extra bytes to match misalignment of unexpanded allocation */
     extra = alignment - (((unsigned long)(m)) % alignment);
-    m  = (char*)(mALLOc(bytes + extra));
+    m  = (char*)(chunk_alloc(bytes + extra));
     /*
      * m might not be the same as before. Validate that the previous value of
      * extra still works for the current value of m.
@@ -2090,6 +2136,13 @@ Void_t* cALLOc(n, elem_size) size_t n; size_t elem_size;
 		MALLOC_ZERO(mem, sz);
 		return mem;
 	}
+#endif
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	/* MALLOC_ZERO() may write past the end of a small object */
+	if (malloc_slab_owns(mem)) {
+		memset(mem, '\0', sz);
+		return mem;
+	}
 #endif
     p = mem2chunk(mem);
 
@@ -2238,6 +2291,10 @@ size_t malloc_usable_size(mem) Void_t* mem;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  else if (malloc_slab_owns(mem))
+    return malloc_slab_usable_size(mem);
+#endif
   else
   {
     p = mem2chunk(mem);
@@ -2288,6 +2345,15 @@ static void malloc_update_mallinfo()
 
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  {
+    ulong reserved, in_use;
+
+    /* Count the slab objects in use, not the whole slab area */
+    malloc_slab_get_usage(&reserved, &in_use);
+    current_mallinfo.uordblks += in_use - reserved;
+  }
+#endif
   current_mallinfo.fordblks = avail;
   current_mallinfo.hblks = n_mmaps;
   current_mallinfo.hblkhd = mmapped_mem;
@@ -2311,11 +2377,15 @@ static void malloc_update_mallinfo()
     number requested. It will be larger than the number requested
     because of alignment and bookkeeping overhead.)
 
+    With CONFIG_SYS_MALLOC_SLAB, the statistics for each slab size class
+    are shown too.
+
 */
 
-#ifdef DEBUG
+#if defined(DEBUG) || CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
 void malloc_stats()
 {
+#ifdef DEBUG
   malloc_update_mallinfo();
   printf("max system bytes = %10u\n",
 	  (unsigned int)(max_total_mem));
@@ -2327,8 +2397,12 @@ void malloc_stats()
   printf("max mmap regions = %10u\n",
 	  (unsigned int)max_n_mmaps);
 #endif
-}
 #endif	/* DEBUG */
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  malloc_slab_print_stats();
+#endif
+}
+#endif	/* DEBUG || SYS_MALLOC_SLAB */
 
 /*
   mallinfo returns a copy of updated current mallinfo.
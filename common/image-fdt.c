@@ -477,6 +477,10 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
 		printf("ERROR: /chosen node create failed\n");
 		goto err;
 	}
+	if (log_ring_fdt_fixup(blob) < 0) {
+		printf("ERROR: log ring fdt fixup failed\n");
+		goto err;
+	}
 	if (arch_fixup_fdt(blob) < 0) {
 		printf("ERROR: arch-specific fdt fixup failed\n");
 		goto err;
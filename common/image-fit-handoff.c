@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Passing the hashes of FIT images verified by SPL to U-Boot proper, so that
+ * they need not be calculated again
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <image.h>
+#include <u-boot/crc.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define FIT_HANDOFF_MAX_RECS	((CONFIG_FIT_HANDOFF_SIZE - \
+				  sizeof(struct fit_handoff_hdr)) / \
+				 sizeof(struct fit_handoff_rec))
+
+static u32 fit_handoff_chksum(struct fit_handoff_hdr *hdr)
+{
+	return crc32(0, (unsigned char *)(hdr + 1),
+		     hdr->count * sizeof(struct fit_handoff_rec));
+}
+
+/* Get the records, checking that they have not been corrupted */
+static struct fit_handoff_rec *fit_handoff_get(struct fit_handoff_hdr *hdr)
+{
+	if (hdr->count > FIT_HANDOFF_MAX_RECS ||
+	    hdr->chksum != fit_handoff_chksum(hdr))
+		return NULL;
+
+	return (struct fit_handoff_rec *)(hdr + 1);
+}
+
+static struct fit_handoff_rec *fit_handoff_find_recs(
+		struct fit_handoff_hdr **hdrp)
+{
+	if (!gd->bloblist)
+		return NULL;
+	*hdrp = bloblist_find(BLOBLISTT_FIT_HANDOFF, CONFIG_FIT_HANDOFF_SIZE);
+	if (!*hdrp)
+		return NULL;
+
+	return fit_handoff_get(*hdrp);
+}
+
+static void fit_handoff_drop(struct fit_handoff_hdr *hdr,
+			     struct fit_handoff_rec *recs, int i)
+{
+	hdr->count--;
+	memmove(&recs[i], &recs[i + 1], (hdr->count - i) * sizeof(*recs));
+	hdr->chksum = fit_handoff_chksum(hdr);
+}
+
+static int fit_handoff_add(struct fit_handoff_hdr *hdr, ulong addr, ulong size,
+			   const char *algo, const uint8_t *value,
+			   int value_len)
+{
+	struct fit_handoff_rec *recs, *rec;
+	int i;
+
+	if (strlen(algo) >= sizeof(rec->algo) || value_len > FIT_MAX_HASH_LEN)
+		return -E2BIG;
+	recs = fit_handoff_get(hdr);
+	if (!recs)
+		return -EINVAL;
+
+	/* Replace any previous record of the same hash at this address */
+	for (i = 0; i < hdr->count; i++) {
+		if (recs[i].addr == addr && !strcmp(recs[i].algo, algo))
+			break;
+	}
+	if (i == hdr->count) {
+		if (hdr->count == FIT_HANDOFF_MAX_RECS)
+			return -ENOSPC;
+		hdr->count++;
+	}
+	rec = &recs[i];
+	memset(rec, '\0', sizeof(*rec));
+	rec->addr = addr;
+	rec->size = size;
+	rec->value_len = value_len;
+	strcpy(rec->algo, algo);
+	memcpy(rec->value, value, value_len);
+	hdr->chksum = fit_handoff_chksum(hdr);
+
+	return 0;
+}
+
+int fit_handoff_save(const void *fit, int image_noffset, ulong addr,
+		     ulong size)
+{
+	struct fit_handoff_hdr *hdr;
+	int noffset;
+	int ret;
+
+	if (!gd->bloblist)
+		return -ENOENT;
+	hdr = bloblist_find(BLOBLISTT_FIT_HANDOFF, CONFIG_FIT_HANDOFF_SIZE);
+	if (!hdr) {
+		hdr = bloblist_add(BLOBLISTT_FIT_HANDOFF,
+				   CONFIG_FIT_HANDOFF_SIZE);
+		if (!hdr)
+			return -ENOSPC;
+		hdr->count = 0;
+		hdr->chksum = fit_handoff_chksum(hdr);
+	}
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+		uint8_t *value;
+		int value_len;
+		char *algo;
+		int ignore;
+
+		if (strncmp(name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (fit_image_hash_get_algo(fit, noffset, &algo) ||
+		    fit_image_hash_get_value(fit, noffset, &value,
+					     &value_len))
+			return -EINVAL;
+		fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+		ret = fit_handoff_add(hdr, addr, size, algo, value, value_len);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Get the index of the record matching an image, or -ENOENT if none */
+static int fit_handoff_match(struct fit_handoff_hdr *hdr,
+			     struct fit_handoff_rec *recs, ulong addr,
+			     ulong size, const char *algo,
+			     const uint8_t *value, int value_len)
+{
+	int i;
+
+	for (i = 0; i < hdr->count; i++) {
+		struct fit_handoff_rec *rec = &recs[i];
+
+		if (rec->addr == addr && rec->size == size &&
+		    rec->value_len == value_len && !strcmp(rec->algo, algo) &&
+		    !memcmp(rec->value, value, value_len))
+			return i;
+	}
+
+	return -ENOENT;
+}
+
+bool fit_handoff_find(ulong addr, ulong size, const char *algo,
+		      const uint8_t *value, int value_len)
+{
+	struct fit_handoff_hdr *hdr;
+	struct fit_handoff_rec *recs;
+
+	recs = fit_handoff_find_recs(&hdr);
+	if (!recs)
+		return false;
+
+	return fit_handoff_match(hdr, recs, addr, size, algo, value,
+				 value_len) >= 0;
+}
+
+bool fit_handoff_use(ulong addr, ulong size, const char *algo,
+		     const uint8_t *value, int value_len)
+{
+	struct fit_handoff_hdr *hdr;
+	struct fit_handoff_rec *recs;
+	int i;
+
+	recs = fit_handoff_find_recs(&hdr);
+	if (!recs)
+		return false;
+	i = fit_handoff_match(hdr, recs, addr, size, algo, value, value_len);
+	if (i < 0)
+		return false;
+
+	/* Each record vouches for the data only once */
+	fit_handoff_drop(hdr, recs, i);
+
+	return true;
+}
+
+void fit_handoff_invalidate(ulong addr, ulong size)
+{
+	struct fit_handoff_hdr *hdr;
+	struct fit_handoff_rec *recs;
+	int i;
+
+	recs = fit_handoff_find_recs(&hdr);
+	if (!recs)
+		return;
+	for (i = 0; i < hdr->count;) {
+		struct fit_handoff_rec *rec = &recs[i];
+
+		if (rec->addr + rec->size > addr &&
+		    (!size || rec->addr < (u64)addr + size))
+			fit_handoff_drop(hdr, recs, i);
+		else
+			i++;
+	}
+}
@@ -23,6 +23,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
 
 #include <image.h>
+#include <smp_job.h>
 #include <bootstage.h>
 #include <u-boot/crc.h>
 #include <u-boot/md5.h>
@@ -1064,7 +1065,7 @@ int fit_image_hash_get_value(const void *fit, int noffset, uint8_t **value,
  *     0, on ignore not found
  *     value, on ignore found
  */
-static int fit_image_hash_get_ignore(const void *fit, int noffset, int *ignore)
+int fit_image_hash_get_ignore(const void *fit, int noffset, int *ignore)
 {
 	int len;
 	int *value;
@@ -1158,6 +1159,199 @@ int calculate_hash(const void *data, int data_len, const char *algo,
 	return 0;
 }
 
+/**
+ * fit_image_hash_handed_off() - Check if a previous phase verified a hash
+ *
+ * @fit:	FIT containing the image
+ * @noffset:	Offset of the hash node
+ * @data:	Image data
+ * @size:	Size of image data
+ * @algo:	Hash algorithm
+ * @use:	true to remove the record, so that it is only used once
+ * @return true if the previous boot phase verified that @data has the hash
+ *	value in the hash node, so that it need not be calculated
+ */
+static bool fit_image_hash_handed_off(const void *fit, int noffset,
+				      const void *data, size_t size,
+				      const char *algo, bool use)
+{
+	uint8_t *fit_value;
+	int fit_value_len;
+	ulong addr;
+
+	if (!IMAGE_ENABLE_HANDOFF ||
+	    fit_image_hash_get_value(fit, noffset, &fit_value, &fit_value_len))
+		return false;
+
+	addr = map_to_sysmem((void *)data);
+	if (use)
+		return fit_handoff_use(addr, size, algo, fit_value,
+				       fit_value_len);
+
+	return fit_handoff_find(addr, size, algo, fit_value, fit_value_len);
+}
+
+#if IMAGE_ENABLE_HASH_JOBS
+/**
+ * struct fit_hash_job - Calculation of the hash for one hash node
+ *
+ * @job:	Job which calculates the hash
+ * @noffset:	Offset of the hash node
+ * @data:	Image data to hash
+ * @size:	Size of image data
+ * @algo:	Hash algorithm to use
+ * @value:	Returns the calculated hash
+ * @value_len:	Returns the length of @value
+ */
+struct fit_hash_job {
+	struct smp_job job;
+	int noffset;
+	const void *data;
+	size_t size;
+	const char *algo;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+};
+
+/* Hash calculations started by fit_hash_jobs_start() */
+static struct fit_hash_job *fit_hash_jobs;
+static int fit_hash_job_count;
+
+static int fit_hash_job_run(void *arg)
+{
+	struct fit_hash_job *hjob = arg;
+
+	return calculate_hash(hjob->data, hjob->size, hjob->algo, hjob->value,
+			      &hjob->value_len);
+}
+
+/**
+ * fit_hash_jobs_scan() - Find the hashes of all images in a FIT
+ *
+ * @fit:	FIT to scan
+ * @images_noffset: Offset of the /images node
+ * @hjobs:	Array to fill in with the hashes found, or NULL to count them
+ * @max:	Number of entries in @hjobs
+ * @return number of hashes found, at most @max if @hjobs is not NULL
+ */
+static int fit_hash_jobs_scan(const void *fit, int images_noffset,
+			      struct fit_hash_job *hjobs, int max)
+{
+	int image_noffset, noffset;
+	int count = 0;
+
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		const void *data;
+		size_t size;
+
+		if (fit_image_get_data_and_size(fit, image_noffset, &data,
+						&size))
+			continue;
+		fdt_for_each_subnode(noffset, fit, image_noffset) {
+			const char *name = fit_get_name(fit, noffset, NULL);
+			char *algo;
+			int ignore;
+
+			if (strncmp(name, FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)) ||
+			    fit_image_hash_get_algo(fit, noffset, &algo))
+				continue;
+			if (IMAGE_ENABLE_IGNORE) {
+				fit_image_hash_get_ignore(fit, noffset,
+							  &ignore);
+				if (ignore)
+					continue;
+			}
+			if (fit_image_hash_handed_off(fit, noffset, data, size,
+						      algo, false))
+				continue;
+			if (hjobs) {
+				struct fit_hash_job *hjob;
+
+				if (count == max)
+					return count;
+				hjob = &hjobs[count];
+
+				hjob->noffset = noffset;
+				hjob->data = data;
+				hjob->size = size;
+				hjob->algo = algo;
+				smp_job_init(&hjob->job, fit_hash_job_run, hjob);
+			}
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void fit_hash_jobs_start(const void *fit, int images_noffset)
+{
+	int count, i;
+
+	count = fit_hash_jobs_scan(fit, images_noffset, NULL, 0);
+	if (count < 2)
+		return;
+	fit_hash_jobs = calloc(count, sizeof(*fit_hash_jobs));
+	if (!fit_hash_jobs)
+		return;
+	fit_hash_job_count = fit_hash_jobs_scan(fit, images_noffset,
+						fit_hash_jobs, count);
+	for (i = 0; i < fit_hash_job_count; i++)
+		smp_job_queue(&fit_hash_jobs[i].job);
+}
+
+void fit_hash_jobs_finish(void)
+{
+	int i;
+
+	for (i = 0; i < fit_hash_job_count; i++)
+		smp_job_wait(&fit_hash_jobs[i].job);
+	free(fit_hash_jobs);
+	fit_hash_jobs = NULL;
+	fit_hash_job_count = 0;
+}
+
+/**
+ * fit_image_calc_hash() - Calculate a hash, or get it from a hash job
+ *
+ * This is the same as calculate_hash(), but uses the result of a hash job
+ * if there is one for this hash node.
+ *
+ * @noffset:	Offset of the hash node
+ * Other parameters and return value are as for calculate_hash()
+ */
+static int fit_image_calc_hash(int noffset, const void *data, size_t size,
+			       const char *algo, uint8_t *value,
+			       int *value_len)
+{
+	int i;
+
+	for (i = 0; i < fit_hash_job_count; i++) {
+		struct fit_hash_job *hjob = &fit_hash_jobs[i];
+
+		if (hjob->noffset != noffset || hjob->data != data ||
+		    hjob->size != size || strcmp(hjob->algo, algo))
+			continue;
+		if (smp_job_wait(&hjob->job))
+			return -1;
+		memcpy(value, hjob->value, hjob->value_len);
+		*value_len = hjob->value_len;
+
+		return 0;
+	}
+
+	return calculate_hash(data, size, algo, value, value_len);
+}
+#else
+static int fit_image_calc_hash(int noffset, const void *data, size_t size,
+			       const char *algo, uint8_t *value,
+			       int *value_len)
+{
+	return calculate_hash(data, size, algo, value, value_len);
+}
+#endif
+
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 				size_t size, char **err_msgp)
 {
@@ -1190,7 +1384,13 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	if (fit_image_hash_handed_off(fit, noffset, data, size, algo, true)) {
+		printf("-handoff ");
+		return 0;
+	}
+
+	if (fit_image_calc_hash(noffset, data, size, algo, value,
+				&value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1331,6 +1531,7 @@ int fit_all_image_verify(const void *fit)
 	/* Process all image subnodes, check hashes for each */
 	printf("## Checking hash(es) for FIT Image at %08lx ...\n",
 	       (ulong)fit);
+	fit_hash_jobs_start(fit, images_noffset);
 	for (ndepth = 0, count = 0,
 	     noffset = fdt_next_node(fit, images_noffset, &ndepth);
 			(noffset >= 0) && (ndepth > 0);
@@ -1344,11 +1545,15 @@ int fit_all_image_verify(const void *fit)
 			       fit_get_name(fit, noffset, NULL));
 			count++;
 
-			if (!fit_image_verify(fit, noffset))
+			if (!fit_image_verify(fit, noffset)) {
+				fit_hash_jobs_finish();
 				return 0;
+			}
 			printf("\n");
 		}
 	}
+	fit_hash_jobs_finish();
+
 	return 1;
 }
 
@@ -1521,6 +1726,11 @@ int fit_check_format(const void *fit)
  * compatible list, "foo,bar", matches a compatible string in the root of fdt1.
  * "bim,bam" in fdt2 matches the second string which isn't as good as fdt1.
  *
+ * If a configuration node has its own "compatible" property (mkimage copies
+ * this from the root of its fdt), that is used instead, so the fdt images do
+ * not need to be looked at. This is much faster with many configurations,
+ * and also works when the fdt images are compressed.
+ *
  * returns:
  *     offset to the configuration to use if one was found
  *     -1 otherwise
@@ -1555,7 +1765,7 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 			noffset = fdt_next_node(fit, noffset, &ndepth)) {
 		const void *kfdt;
 		const char *kfdt_name;
-		int kfdt_noffset;
+		int kfdt_noffset, compat_noffset;
 		const char *cur_fdt_compat;
 		int len;
 		size_t size;
@@ -1564,24 +1774,33 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 		if (ndepth > 1)
 			continue;
 
-		kfdt_name = fdt_getprop(fit, noffset, "fdt", &len);
-		if (!kfdt_name) {
-			debug("No fdt property found.\n");
-			continue;
-		}
-		kfdt_noffset = fdt_subnode_offset(fit, images_noffset,
-						  kfdt_name);
-		if (kfdt_noffset < 0) {
-			debug("No image node named \"%s\" found.\n",
-			      kfdt_name);
-			continue;
-		}
-		/*
-		 * Get a pointer to this configuration's fdt.
-		 */
-		if (fit_image_get_data(fit, kfdt_noffset, &kfdt, &size)) {
-			debug("Failed to get fdt \"%s\".\n", kfdt_name);
-			continue;
+		if (fdt_getprop(fit, noffset, FIT_COMPAT_PROP, NULL)) {
+			/* Use the compatible list in the configuration node */
+			kfdt = fit;
+			compat_noffset = noffset;
+		} else {
+			kfdt_name = fdt_getprop(fit, noffset, "fdt", &len);
+			if (!kfdt_name) {
+				debug("No fdt property found.\n");
+				continue;
+			}
+			kfdt_noffset = fdt_subnode_offset(fit, images_noffset,
+							  kfdt_name);
+			if (kfdt_noffset < 0) {
+				debug("No image node named \"%s\" found.\n",
+				      kfdt_name);
+				continue;
+			}
+			/*
+			 * Get a pointer to this configuration's fdt.
+			 */
+			if (fit_image_get_data(fit, kfdt_noffset, &kfdt,
+					       &size)) {
+				debug("Failed to get fdt \"%s\".\n",
+				      kfdt_name);
+				continue;
+			}
+			compat_noffset = 0;
 		}
 
 		len = fdt_compat_len;
@@ -1594,7 +1813,7 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 		     (!best_match_offset || best_match_pos > i); i++) {
 			int cur_len = strlen(cur_fdt_compat) + 1;
 
-			if (!fdt_node_check_compatible(kfdt, 0,
+			if (!fdt_node_check_compatible(kfdt, compat_noffset,
 						       cur_fdt_compat)) {
 				best_match_offset = noffset;
 				best_match_pos = i;
@@ -8,6 +8,7 @@
 
 #ifndef USE_HOSTCC
 #include <common.h>
+#include <dma.h>
 #include <watchdog.h>
 
 #ifdef CONFIG_SHOW_BOOT_PROGRESS
@@ -1116,6 +1117,13 @@ int boot_get_ramdisk(int argc, char * const argv[], bootm_headers_t *images,
 }
 
 #ifdef CONFIG_SYS_BOOT_RAMDISK_HIGH
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+/* Ramdisk copy left running in the background by boot_ramdisk_high() */
+static struct dma_sg rd_sg;
+static struct dma_async_desc rd_copy;
+static bool rd_copy_busy;
+#endif
+
 /**
  * boot_ramdisk_high - relocate init ramdisk
  * @lmb: pointer to lmb handle, will be used for memory mgmt
@@ -1184,6 +1192,30 @@ int boot_ramdisk_high(struct lmb *lmb, ulong rd_data, ulong rd_len,
 			printf("   Loading Ramdisk to %08lx, end %08lx ... ",
 					*initrd_start, *initrd_end);
 
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+			/*
+			 * Let a DMA engine do the copy while the caller gets on
+			 * with preparing the OS. It must call
+			 * boot_ramdisk_wait() before the ramdisk is used. DMA
+			 * only takes whole cache lines, so the CPU copies any
+			 * tail, which must not overlap the data being copied.
+			 */
+			rd_sg.dst = (void *)*initrd_start;
+			rd_sg.src = (void *)rd_data;
+			rd_sg.len = rounddown(rd_len, ARCH_DMA_MINALIGN);
+			rd_copy.sg = &rd_sg;
+			rd_copy.count = 1;
+			if (rd_sg.len && (rd_data + rd_len <= *initrd_start ||
+					  *initrd_end <= rd_data) &&
+			    !dma_async_submit(&rd_copy)) {
+				memcpy(rd_sg.dst + rd_sg.len,
+				       rd_sg.src + rd_sg.len,
+				       rd_len - rd_sg.len);
+				rd_copy_busy = true;
+				puts("started\n");
+				goto done;
+			}
+#endif
 			memmove_wd((void *)*initrd_start,
 					(void *)rd_data, rd_len, CHUNKSZ);
 
@@ -1202,6 +1234,9 @@ int boot_ramdisk_high(struct lmb *lmb, ulong rd_data, ulong rd_len,
 		*initrd_start = 0;
 		*initrd_end = 0;
 	}
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+done:
+#endif
 	debug("   ramdisk load start = 0x%08lx, ramdisk load end = 0x%08lx\n",
 			*initrd_start, *initrd_end);
 
@@ -1210,6 +1245,25 @@ int boot_ramdisk_high(struct lmb *lmb, ulong rd_data, ulong rd_len,
 error:
 	return -1;
 }
+
+void boot_ramdisk_wait(void)
+{
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+	if (!rd_copy_busy)
+		return;
+	rd_copy_busy = false;
+
+	/* The source is still intact, so the CPU can redo a failed copy */
+	if (dma_async_wait(&rd_copy)) {
+		puts("   DMA copy of ramdisk failed, copying again\n");
+		memmove_wd(rd_sg.dst, (void *)rd_sg.src, rd_sg.len, CHUNKSZ);
+	}
+#ifdef CONFIG_MP
+	flush_cache((unsigned long)rd_sg.dst,
+		    ALIGN(rd_sg.len, ARCH_DMA_MINALIGN));
+#endif
+#endif
+}
 #endif /* CONFIG_SYS_BOOT_RAMDISK_HIGH */
 
 int boot_get_setup(bootm_headers_t *images, uint8_t arch,
@@ -175,16 +175,7 @@ static bool log_passes_filters(struct log_device *ldev, struct log_rec *rec)
 	return false;
 }
 
-/**
- * log_dispatch() - Send a log record to all log devices for processing
- *
- * The log record is sent to each log device in turn, skipping those which have
- * filters which block the record
- *
- * @rec: Log record to dispatch
- * @return 0 (meaning success)
- */
-static int log_dispatch(struct log_rec *rec)
+int log_dispatch(struct log_rec *rec)
 {
 	struct log_device *ldev;
 
@@ -217,6 +208,18 @@ int _log(enum log_category_t cat, enum log_level_t level, const char *file,
 			gd->log_drop_count++;
 		return -ENOSYS;
 	}
+#if CONFIG_IS_ENABLED(LOG_RING)
+	if (gd->log_ring) {
+		if (log_ring_add(&rec))
+			return -ENOSPC;
+
+		/* Output now unless this can wait until we are idle */
+		if (!IS_ENABLED(CONFIG_LOG_RING_DEFER) || level <= LOGL_WARNING)
+			log_flush();
+
+		return 0;
+	}
+#endif
 	log_dispatch(&rec);
 
 	return 0;
@@ -319,5 +322,16 @@ int log_init(void)
 		gd->default_log_level = LOGL_INFO;
 	gd->log_fmt = LOGF_DEFAULT;
 
+#if CONFIG_IS_ENABLED(LOG_RING)
+	/* Records stay in the ring, so only set it up after relocation */
+	if (gd->flags & GD_FLG_RELOC) {
+		int ret;
+
+		ret = log_ring_init();
+		if (ret)
+			return ret;
+	}
+#endif
+
 	return 0;
 }
@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * In-memory ring of log records
+ *
+ * _log() adds each record to the ring as a binary record with a timestamp.
+ * Records are passed to the log drivers straight away or, with
+ * CONFIG_LOG_RING_DEFER, when U-Boot is idle. The ring keeps the most recent
+ * records so that they can be shown with 'log dump' or examined by the OS.
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <div64.h>
+#include <fdt_support.h>
+#include <log.h>
+#include <malloc.h>
+#include <mapmem.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static bool log_ring_flushing;	/* true while passing records to drivers */
+
+static struct log_ring_rec *log_ring_rec_at(struct log_ring_hdr *ring,
+					    u32 offset)
+{
+	return (void *)ring + ring->hdr_size + offset % ring->size;
+}
+
+static void log_ring_get_rec(struct log_ring_rec *rrec, struct log_rec *rec)
+{
+	rec->cat = rrec->cat;
+	rec->level = rrec->level;
+	rec->file = (const char *)(ulong)rrec->file;
+	rec->line = rrec->line;
+	rec->func = (const char *)(ulong)rrec->func;
+	rec->msg = rrec->msg;
+}
+
+/**
+ * log_ring_time() - Get the timestamp for a new record
+ *
+ * The timer may not be started yet and starting it can produce log records of
+ * its own. These are given a timestamp of 0.
+ *
+ * @return current time in microseconds
+ */
+static ulong log_ring_time(void)
+{
+	static bool busy;
+	ulong time_us;
+
+	if (busy)
+		return 0;
+	busy = true;
+	time_us = timer_get_us();
+	busy = false;
+
+	return time_us;
+}
+
+/**
+ * log_ring_make_space() - Discard old records to make space for a new one
+ *
+ * @ring: Log ring
+ * @size: Number of bytes needed at the head of the ring
+ * @return 0 if OK, -EBUSY if space is needed while flushing the ring
+ */
+static int log_ring_make_space(struct log_ring_hdr *ring, uint size)
+{
+	while (ring->head + size - ring->tail > ring->size) {
+		/*
+		 * A record being output may still be in use, so records added
+		 * by a log driver cannot discard anything
+		 */
+		if (log_ring_flushing)
+			return -EBUSY;
+		if (ring->tail == ring->emit)
+			log_flush();
+		ring->tail += log_ring_rec_at(ring, ring->tail)->size;
+	}
+
+	return 0;
+}
+
+int log_ring_add(struct log_rec *rec)
+{
+	struct log_ring_hdr *ring = gd->log_ring;
+	ulong time_us = log_ring_time();
+	struct log_ring_rec *rrec;
+	uint msg_len, size, pad;
+	u32 head, pos;
+
+	msg_len = strlen(rec->msg);
+	size = ALIGN(sizeof(*rrec) + msg_len + 1, LOG_RING_ALIGN);
+	head = ring->head;
+	pos = head % ring->size;
+	pad = pos + size > ring->size ? ring->size - pos : 0;
+	if (pad + size > ring->size || log_ring_make_space(ring, pad + size)) {
+		ring->drop_count++;
+		return -ENOSPC;
+	}
+
+	/* Records must not wrap, so skip the space at the end of the ring */
+	if (pad) {
+		rrec = log_ring_rec_at(ring, head);
+		rrec->size = pad;
+		rrec->flags = LOGRF_PAD;
+		head += pad;
+	}
+	rrec = log_ring_rec_at(ring, head);
+	rrec->size = size;
+	rrec->cat = rec->cat;
+	rrec->level = rec->level;
+	rrec->flags = 0;
+	rrec->msg_len = msg_len;
+	rrec->line = rec->line;
+	rrec->seq = ring->seq++;
+	rrec->time_us = time_us;
+	rrec->file = (ulong)rec->file;
+	rrec->func = (ulong)rec->func;
+	memcpy(rrec->msg, rec->msg, msg_len + 1);
+
+	/* Make sure the record is complete before anyone can read it */
+	__atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+void log_flush(void)
+{
+	struct log_ring_hdr *ring = gd->log_ring;
+
+	if (!ring || log_ring_flushing)
+		return;
+	log_ring_flushing = true;
+	while (ring->emit != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+		struct log_ring_rec *rrec = log_ring_rec_at(ring, ring->emit);
+		struct log_rec rec;
+
+		ring->emit += rrec->size;
+		if (rrec->flags & LOGRF_PAD)
+			continue;
+		log_ring_get_rec(rrec, &rec);
+		log_dispatch(&rec);
+	}
+	log_ring_flushing = false;
+}
+
+int log_ring_dump(void)
+{
+	struct log_ring_hdr *ring = gd->log_ring;
+	struct log_ring_rec *rrec;
+	int count = 0;
+	u32 offset;
+
+	if (!ring)
+		return 0;
+	for (offset = ring->tail; offset != ring->head; offset += rrec->size) {
+		ulong secs;
+
+		rrec = log_ring_rec_at(ring, offset);
+		if (rrec->flags & LOGRF_PAD)
+			continue;
+		secs = lldiv(rrec->time_us, 1000000);
+		printf("[%5lu.%06lu] %s.%s,%s", secs,
+		       (ulong)(rrec->time_us - secs * 1000000ULL),
+		       log_get_level_name(rrec->level),
+		       log_get_cat_name(rrec->cat), rrec->msg);
+		count++;
+	}
+	ring->emit = ring->head;
+	if (ring->drop_count)
+		printf("(%u records dropped)\n", ring->drop_count);
+
+	return count;
+}
+
+int log_ring_fdt_fixup(void *blob)
+{
+	struct log_ring_hdr *ring = gd->log_ring;
+	fdt64_t val[2];
+	ulong addr;
+	uint size;
+	int node;
+	int ret;
+
+	if (!ring)
+		return 0;
+	addr = map_to_sysmem(ring);
+	size = ring->hdr_size + ring->size;
+	ret = fdt_add_mem_rsv(blob, addr, size);
+	if (ret)
+		return ret;
+	node = fdt_find_or_add_subnode(blob, 0, "chosen");
+	if (node < 0)
+		return node;
+	val[0] = cpu_to_fdt64(addr);
+	val[1] = cpu_to_fdt64(size);
+
+	return fdt_setprop(blob, node, "u-boot,log-ring", val, sizeof(val));
+}
+
+int log_ring_init(void)
+{
+	struct log_ring_hdr *ring = NULL;
+	int size = CONFIG_LOG_RING_SIZE;
+
+	if (IS_ENABLED(CONFIG_BLOBLIST))
+		ring = bloblist_ensure(BLOBLISTT_LOG_RING, size);
+	if (!ring)
+		ring = memalign(LOG_RING_ALIGN, size);
+	if (!ring) {
+		debug("%s: Cannot allocate log ring\n", __func__);
+		return -ENOMEM;
+	}
+	memset(ring, '\0', sizeof(*ring));
+	ring->magic = LOG_RING_MAGIC;
+	ring->hdr_size = sizeof(*ring);
+	ring->size = (size - sizeof(*ring)) & ~(LOG_RING_ALIGN - 1);
+	gd->log_ring = ring;
+
+	return 0;
+}
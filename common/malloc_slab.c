@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Slab allocator for small malloc() requests
+ *
+ * Driver model allocates a large number of small structures, each of which
+ * goes through the dlmalloc() bin search and leaves small holes in the heap
+ * when freed. Instead, requests up to MALLOC_SLAB_MAX bytes are served from a
+ * separate area which is divided into pages. Each page holds objects of a
+ * single size class and keeps its own list of freed objects. Empty pages are
+ * returned to a common pool so they can be used by any size class.
+ *
+ * Objects can be identified by their address, since the slab area is a single
+ * block taken from the heap.
+ */
+
+#define LOG_CATEGORY LOGC_ALLOC
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/list.h>
+
+#define SLAB_PAGE_SIZE		4096
+#define SLAB_ALIGN		16
+
+/**
+ * struct slab_page - Header at the start of each page in the slab area
+ *
+ * @sibling:	Node in the partial list of the size class, or in the list of
+ *		empty pages. Full pages are not in any list.
+ * @free:	List of freed objects, linked through their first word
+ * @used:	Number of objects currently allocated
+ * @carved:	Number of objects ever handed out from this page. Objects
+ *		above this have never been used, so are not in @free
+ * @cls:	Size-class index
+ */
+struct slab_page {
+	struct list_head sibling;
+	void *free;
+	u16 used;
+	u16 carved;
+	u8 cls;
+};
+
+#define SLAB_HDR_SIZE	ALIGN(sizeof(struct slab_page), SLAB_ALIGN)
+
+static const u16 slab_sizes[] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512,
+};
+
+/**
+ * struct slab_class - Information about a size class
+ *
+ * @partial:	Pages with at least one free object
+ * @pages:	Number of pages in use by this class
+ * @allocs:	Number of objects allocated
+ * @frees:	Number of objects freed
+ */
+struct slab_class {
+	struct list_head partial;
+	uint pages;
+	ulong allocs;
+	ulong frees;
+};
+
+/**
+ * struct slab_info - State of the slab allocator
+ *
+ * @base:	Start of the slab area, or NULL if not allocated yet
+ * @end:	End of the slab area
+ * @brk:	Next page which has never been used
+ * @empty:	Pages which have been used and are now empty
+ * @misses:	Number of requests passed to dlmalloc() as the area was full
+ * @failed:	true if the slab area could not be allocated
+ * @disabled:	true to pass all requests to dlmalloc()
+ * @index:	Size-class index for each multiple of SLAB_ALIGN bytes
+ * @cls:	Information for each size class
+ */
+static struct slab_info {
+	void *base;
+	void *end;
+	void *brk;
+	struct list_head empty;
+	ulong misses;
+	bool failed;
+	bool disabled;
+	u8 index[MALLOC_SLAB_MAX / SLAB_ALIGN + 1];
+	struct slab_class cls[ARRAY_SIZE(slab_sizes)];
+} slab;
+
+static uint slab_objs_per_page(int cls)
+{
+	return (SLAB_PAGE_SIZE - SLAB_HDR_SIZE) / slab_sizes[cls];
+}
+
+static struct slab_page *slab_page_of(const void *mem)
+{
+	return slab.base + ((mem - slab.base) & ~(SLAB_PAGE_SIZE - 1));
+}
+
+static int slab_init(void)
+{
+	int i, cls;
+
+	slab.base = memalign(SLAB_PAGE_SIZE, CONFIG_SYS_MALLOC_SLAB_SIZE);
+	if (!slab.base) {
+		log_warning("Cannot allocate slab area\n");
+		slab.failed = true;
+		return -ENOMEM;
+	}
+	slab.end = slab.base + ALIGN_DOWN(CONFIG_SYS_MALLOC_SLAB_SIZE,
+					  SLAB_PAGE_SIZE);
+	slab.brk = slab.base;
+	INIT_LIST_HEAD(&slab.empty);
+	for (i = 0, cls = 0; i < ARRAY_SIZE(slab.index); i++) {
+		if (i * SLAB_ALIGN > slab_sizes[cls])
+			cls++;
+		slab.index[i] = cls;
+	}
+	for (cls = 0; cls < ARRAY_SIZE(slab.cls); cls++)
+		INIT_LIST_HEAD(&slab.cls[cls].partial);
+
+	return 0;
+}
+
+/* Get an empty page and assign it to a size class */
+static struct slab_page *slab_new_page(int cls)
+{
+	struct slab_page *page;
+
+	if (!list_empty(&slab.empty)) {
+		page = list_first_entry(&slab.empty, struct slab_page, sibling);
+		list_del(&page->sibling);
+	} else {
+		if (slab.brk == slab.end)
+			return NULL;
+		page = slab.brk;
+		slab.brk += SLAB_PAGE_SIZE;
+	}
+	page->free = NULL;
+	page->used = 0;
+	page->carved = 0;
+	page->cls = cls;
+	list_add(&page->sibling, &slab.cls[cls].partial);
+	slab.cls[cls].pages++;
+
+	return page;
+}
+
+void *malloc_slab_alloc(size_t bytes)
+{
+	struct slab_page *page;
+	struct slab_class *sc;
+	void *mem;
+	int cls;
+
+	if (bytes > MALLOC_SLAB_MAX || slab.disabled)
+		return NULL;
+	if (!slab.base && (slab.failed || slab_init()))
+		return NULL;
+
+	cls = slab.index[DIV_ROUND_UP(bytes, SLAB_ALIGN)];
+	sc = &slab.cls[cls];
+	if (!list_empty(&sc->partial)) {
+		page = list_first_entry(&sc->partial, struct slab_page,
+					sibling);
+	} else {
+		page = slab_new_page(cls);
+		if (!page) {
+			slab.misses++;
+			return NULL;
+		}
+	}
+	if (page->free) {
+		mem = page->free;
+		page->free = *(void **)mem;
+	} else {
+		mem = (void *)page + SLAB_HDR_SIZE +
+			page->carved * slab_sizes[cls];
+		page->carved++;
+	}
+	if (++page->used == slab_objs_per_page(cls))
+		list_del(&page->sibling);
+	sc->allocs++;
+
+	return mem;
+}
+
+bool malloc_slab_owns(const void *mem)
+{
+	return mem >= slab.base && mem < slab.end;
+}
+
+bool malloc_slab_free(void *mem)
+{
+	struct slab_page *page;
+	struct slab_class *sc;
+
+	if (!malloc_slab_owns(mem))
+		return false;
+	page = slab_page_of(mem);
+	sc = &slab.cls[page->cls];
+	if (page->used == slab_objs_per_page(page->cls))
+		list_add(&page->sibling, &sc->partial);
+	*(void **)mem = page->free;
+	page->free = mem;
+	sc->frees++;
+	if (!--page->used) {
+		list_move(&page->sibling, &slab.empty);
+		sc->pages--;
+	}
+
+	return true;
+}
+
+size_t malloc_slab_usable_size(const void *mem)
+{
+	return slab_sizes[slab_page_of(mem)->cls];
+}
+
+void malloc_slab_get_usage(ulong *reservedp, ulong *in_usep)
+{
+	ulong in_use = 0;
+	int cls;
+
+	*reservedp = slab.base ? CONFIG_SYS_MALLOC_SLAB_SIZE : 0;
+	for (cls = 0; cls < ARRAY_SIZE(slab.cls); cls++)
+		in_use += (slab.cls[cls].allocs - slab.cls[cls].frees) *
+			slab_sizes[cls];
+	*in_usep = in_use;
+}
+
+int malloc_slab_get_stats(size_t bytes, struct malloc_slab_stats *stats)
+{
+	struct slab_class *sc;
+	int cls;
+
+	if (bytes > MALLOC_SLAB_MAX)
+		return -E2BIG;
+	if (!slab.base) {
+		memset(stats, '\0', sizeof(*stats));
+		return 0;
+	}
+	cls = slab.index[DIV_ROUND_UP(bytes, SLAB_ALIGN)];
+	sc = &slab.cls[cls];
+	stats->obj_size = slab_sizes[cls];
+	stats->pages = sc->pages;
+	stats->allocs = sc->allocs;
+	stats->frees = sc->frees;
+	stats->in_use = sc->allocs - sc->frees;
+	stats->misses = slab.misses;
+
+	return 0;
+}
+
+bool malloc_slab_enable(bool enable)
+{
+	bool old = !slab.disabled;
+
+	slab.disabled = !enable;
+
+	return old;
+}
+
+void malloc_slab_print_stats(void)
+{
+	struct malloc_slab_stats stats;
+	struct list_head *node;
+	ulong unused;
+	int cls;
+
+	if (!slab.base) {
+		printf("slab area not allocated\n");
+		return;
+	}
+	unused = (slab.end - slab.brk) / SLAB_PAGE_SIZE;
+	list_for_each(node, &slab.empty)
+		unused++;
+	printf("slab area        = %08lx, %#x bytes, %lu pages unused\n",
+	       (ulong)slab.base, CONFIG_SYS_MALLOC_SLAB_SIZE, unused);
+	printf(" Size  Pages      Allocs       Frees  In use\n");
+	for (cls = 0; cls < ARRAY_SIZE(slab.cls); cls++) {
+		malloc_slab_get_stats(slab_sizes[cls], &stats);
+		printf("%5u %6u %11lu %11lu %7lu\n", stats.obj_size,
+		       stats.pages, stats.allocs, stats.frees, stats.in_use);
+	}
+	printf("dlmalloc fallbacks = %lu\n", slab.misses);
+}
+
+void malloc_slab_reset(void)
+{
+	memset(&slab, '\0', sizeof(slab));
+}
@@ -22,6 +22,7 @@
 #include <linux/compiler.h>
 #include <fdt_support.h>
 #include <bootcount.h>
+#include <warm_state.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -348,6 +349,9 @@ static int write_spl_handoff(void)
 	handoff_save_dram(ho);
 #ifdef CONFIG_SANDBOX
 	ho->arch.magic = TEST_HANDOFF_MAGIC;
+	if (CONFIG_IS_ENABLED(WARM_STATE))
+		warm_state_save(UCLASS_ROOT, 0, &ho->arch.magic,
+				sizeof(ho->arch.magic));
 #endif
 	debug(SPL_TPL_PROMPT "Wrote SPL handoff\n");
 
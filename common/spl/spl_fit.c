@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <dma.h>
 #include <errno.h>
 #include <fpga.h>
 #include <image.h>
@@ -261,7 +262,16 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 		}
 		length = size;
 	} else {
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+		if (dma_memmove((void *)load_addr, src, length))
+			return -EIO;
+#else
 		memcpy((void *)load_addr, src, length);
+#endif
+		/* Let U-Boot proper skip hashing this image again */
+		if (CONFIG_IS_ENABLED(FIT_HANDOFF) &&
+		    !IS_ENABLED(CONFIG_SPL_FIT_IMAGE_POST_PROCESS))
+			fit_handoff_save(fit, node, load_addr, length);
 	}
 
 	if (image_info) {
@@ -281,6 +281,49 @@ int usb_bulk_msg(struct usb_device *dev, unsigned int pipe,
 		return -EIO;
 }
 
+#if !CONFIG_IS_ENABLED(DM_USB)
+__weak int submit_bulk_batch(struct usb_device *dev,
+			     struct usb_bulk_xfer *xfer, int count)
+{
+	return -ENOSYS;
+}
+
+__weak int usb_alloc_streams(struct usb_device *dev,
+			     const unsigned long *pipes, int num_pipes,
+			     int num_streams)
+{
+	return -ENOSYS;
+}
+#endif
+
+int usb_bulk_batch(struct usb_device *dev, struct usb_bulk_xfer *xfer,
+		   int count, int timeout)
+{
+	int i, ret;
+
+	for (i = 0; i < count; i++) {
+		xfer[i].act_len = 0;
+		xfer[i].status = USB_ST_NOT_PROC;
+	}
+
+	ret = submit_bulk_batch(dev, xfer, count);
+	if (ret != -ENOSYS)
+		return ret;
+
+	/* The controller cannot queue transfers, so send them one by one */
+	for (i = 0; i < count; i++) {
+		if (xfer[i].stream)
+			return -EINVAL;
+		ret = usb_bulk_msg(dev, xfer[i].pipe, xfer[i].buffer,
+				   xfer[i].length, &xfer[i].act_len, timeout);
+		xfer[i].status = dev->status;
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 
 /*-------------------------------------------------------------------
  * Max Packet stuff
@@ -647,6 +690,7 @@ int usb_set_interface(struct usb_device *dev, int interface, int alternate)
 				USB_CNTL_TIMEOUT * 5);
 	if (ret < 0)
 		return ret;
+	if_face->act_altsetting = alternate;
 
 	return 0;
 }
@@ -45,6 +45,7 @@
 
 #include <part.h>
 #include <usb.h>
+#include <linux/usb/uas.h>
 
 #undef BBB_COMDAT_TRACE
 #undef BBB_XPORT_TRACE
@@ -79,6 +80,7 @@ struct us_data {
 
 	unsigned int	flags;			/* from filter initially */
 #	define USB_READY	(1 << 0)
+#	define USB_UAS_SENSE	(1 << 1)	/* sense data held by UAS */
 	unsigned char	ifnum;			/* interface number */
 	unsigned char	ep_in;			/* in endpoint */
 	unsigned char	ep_out;			/* out ....... */
@@ -97,6 +99,11 @@ struct us_data {
 	trans_reset	transport_reset;	/* reset routine */
 	trans_cmnd	transport;		/* transport routine */
 	unsigned short	max_xfer_blk;		/* maximum transfer blocks */
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+	unsigned char	ep_cmd;			/* UAS command endpoint */
+	unsigned char	ep_status;		/* UAS status endpoint */
+	unsigned short	streams;		/* UAS streams, 0 if none */
+#endif
 };
 
 #if !CONFIG_IS_ENABLED(BLK)
@@ -107,6 +114,33 @@ static struct us_data usb_stor[USB_MAX_STOR_DEV];
 #define USB_STOR_TRANSPORT_FAILED -1
 #define USB_STOR_TRANSPORT_ERROR  -2
 
+/* Number of READ(10) commands queued at once by usb_stor_BBB_read_batch() */
+#define USB_STOR_BATCH		4
+
+/* Command and status wrappers for one command in a batch */
+struct usb_stor_bbb_cmd {
+	struct umass_bbb_cbw cbw __aligned(ARCH_DMA_MINALIGN);
+	struct umass_bbb_csw csw __aligned(ARCH_DMA_MINALIGN);
+};
+
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+/* Tag for UAS commands which are not part of a batch */
+#define USB_UAS_TAG		1
+
+/* Information units for one command on a UAS device */
+struct usb_stor_uas_cmd {
+	union {
+		struct command_iu cmd;
+		struct task_mgmt_iu tmf;
+	} __aligned(ARCH_DMA_MINALIGN);
+	union {
+		struct iu iu;
+		struct sense_iu sense;
+		struct response_iu resp;
+	} __aligned(ARCH_DMA_MINALIGN);
+};
+#endif
+
 int usb_stor_get_info(struct usb_device *dev, struct us_data *us,
 		      struct blk_desc *dev_desc);
 int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
@@ -171,6 +205,12 @@ static unsigned int usb_get_max_lun(struct us_data *us)
 {
 	int len;
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, result, 1);
+
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+	/* UAS has no Get Max LUN request; only LUN 0 is used */
+	if (us->protocol == US_PR_UAS)
+		return 0;
+#endif
 	len = usb_control_msg(us->pusb_dev,
 			      usb_rcvctrlpipe(us->pusb_dev, 0),
 			      US_BBB_GET_MAX_LUN,
@@ -523,6 +563,22 @@ static int usb_stor_CB_reset(struct us_data *us)
 	return 0;
 }
 
+/* Fill in a CBW for a command, using the next tag */
+static void usb_stor_BBB_set_cbw(struct umass_bbb_cbw *cbw,
+				 struct scsi_cmd *srb)
+{
+	cbw->dCBWSignature = cpu_to_le32(CBWSIGNATURE);
+	cbw->dCBWTag = cpu_to_le32(CBWTag++);
+	cbw->dCBWDataTransferLength = cpu_to_le32(srb->datalen);
+	cbw->bCBWFlags = (US_DIRECTION(srb->cmd[0]) ? CBWFLAGS_IN :
+			  CBWFLAGS_OUT);
+	cbw->bCBWLUN = srb->lun;
+	cbw->bCDBLength = srb->cmdlen;
+	/* copy the command data into the CBW command data buffer */
+	/* DST SRC LEN!!! */
+	memcpy(cbw->CBWCDB, srb->cmd, srb->cmdlen);
+}
+
 /*
  * Set up the command for a BBB device. Note that the actual SCSI
  * command is copied into cbw.CBWCDB.
@@ -531,15 +587,12 @@ static int usb_stor_BBB_comdat(struct scsi_cmd *srb, struct us_data *us)
 {
 	int result;
 	int actlen;
-	int dir_in;
 	unsigned int pipe;
 	ALLOC_CACHE_ALIGN_BUFFER(struct umass_bbb_cbw, cbw, 1);
 
-	dir_in = US_DIRECTION(srb->cmd[0]);
-
 #ifdef BBB_COMDAT_TRACE
 	printf("dir %d lun %d cmdlen %d cmd %p datalen %lu pdata %p\n",
-		dir_in, srb->lun, srb->cmdlen, srb->cmd, srb->datalen,
+		US_DIRECTION(srb->cmd[0]), srb->lun, srb->cmdlen, srb->cmd, srb->datalen,
 		srb->pdata);
 	if (srb->cmdlen) {
 		for (result = 0; result < srb->cmdlen; result++)
@@ -556,16 +609,7 @@ static int usb_stor_BBB_comdat(struct scsi_cmd *srb, struct us_data *us)
 	/* always OUT to the ep */
 	pipe = usb_sndbulkpipe(us->pusb_dev, us->ep_out);
 
-	cbw->dCBWSignature = cpu_to_le32(CBWSIGNATURE);
-	cbw->dCBWTag = cpu_to_le32(CBWTag++);
-	cbw->dCBWDataTransferLength = cpu_to_le32(srb->datalen);
-	cbw->bCBWFlags = (dir_in ? CBWFLAGS_IN : CBWFLAGS_OUT);
-	cbw->bCBWLUN = srb->lun;
-	cbw->bCDBLength = srb->cmdlen;
-	/* copy the command data into the CBW command data buffer */
-	/* DST SRC LEN!!! */
-
-	memcpy(cbw->CBWCDB, srb->cmd, srb->cmdlen);
+	usb_stor_BBB_set_cbw(cbw, srb);
 	result = usb_bulk_msg(us->pusb_dev, pipe, cbw, UMASS_BBB_CBW_SIZE,
 			      &actlen, USB_CNTL_TIMEOUT * 5);
 	if (result < 0)
@@ -823,6 +867,209 @@ again:
 	return result;
 }
 
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+static void usb_stor_UAS_set_cmd(struct command_iu *iu, struct scsi_cmd *srb,
+				 int tag)
+{
+	memset(iu, '\0', sizeof(*iu));
+	iu->iu_id = IU_ID_COMMAND;
+	iu->tag = cpu_to_be16(tag);
+	iu->lun[1] = srb->lun;
+	memcpy(iu->cdb, srb->cmd, min_t(int, srb->cmdlen, sizeof(iu->cdb)));
+}
+
+/*
+ * Set up the transfers for one command on a UAS device with streams. The
+ * status and data stages are queued on the command's stream before the
+ * command IU, so that the device can move data as soon as it gets the
+ * command. Returns the number of transfers used, 2 or 3.
+ */
+static int usb_stor_UAS_setup_xfer(struct us_data *us,
+				   struct usb_stor_uas_cmd *uc,
+				   struct scsi_cmd *srb, int tag,
+				   struct usb_bulk_xfer *x)
+{
+	struct usb_device *udev = us->pusb_dev;
+	int n = 0;
+
+	usb_stor_UAS_set_cmd(&uc->cmd, srb, tag);
+	memset(x, '\0', 3 * sizeof(*x));
+	x[n].pipe = usb_rcvbulkpipe(udev, us->ep_status);
+	x[n].stream = tag;
+	x[n].buffer = &uc->sense;
+	x[n++].length = sizeof(uc->sense);
+	if (srb->datalen) {
+		if (US_DIRECTION(srb->cmd[0]))
+			x[n].pipe = usb_rcvbulkpipe(udev, us->ep_in);
+		else
+			x[n].pipe = usb_sndbulkpipe(udev, us->ep_out);
+		x[n].stream = tag;
+		x[n].buffer = srb->pdata;
+		x[n++].length = srb->datalen;
+	}
+	x[n].pipe = usb_sndbulkpipe(udev, us->ep_cmd);
+	x[n].buffer = &uc->cmd;
+	x[n++].length = sizeof(uc->cmd);
+
+	return n;
+}
+
+/*
+ * Run one command on a UAS device without streams. The device sends a READ
+ * READY or WRITE READY IU on the status pipe when it wants the data stage,
+ * then a SENSE IU once the command has finished.
+ */
+static int usb_stor_UAS_run(struct us_data *us, struct usb_stor_uas_cmd *uc,
+			    struct scsi_cmd *srb)
+{
+	struct usb_device *udev = us->pusb_dev;
+	int dir_in = US_DIRECTION(srb->cmd[0]);
+	unsigned long pipe;
+	int actlen, result;
+
+	usb_stor_UAS_set_cmd(&uc->cmd, srb, USB_UAS_TAG);
+	result = usb_bulk_msg(udev, usb_sndbulkpipe(udev, us->ep_cmd),
+			      &uc->cmd, sizeof(uc->cmd), &actlen,
+			      USB_CNTL_TIMEOUT * 5);
+	if (result < 0)
+		return result;
+
+	pipe = usb_rcvbulkpipe(udev, us->ep_status);
+	result = usb_bulk_msg(udev, pipe, &uc->sense, sizeof(uc->sense),
+			      &actlen, USB_CNTL_TIMEOUT * 5);
+	if (result < 0 || !srb->datalen)
+		return result;
+	/* the command may have failed before the data stage */
+	if (uc->iu.iu_id != (dir_in ? IU_ID_READ_READY : IU_ID_WRITE_READY))
+		return 0;
+
+	result = usb_bulk_msg(udev, dir_in ? usb_rcvbulkpipe(udev, us->ep_in) :
+			      usb_sndbulkpipe(udev, us->ep_out), srb->pdata,
+			      srb->datalen, &actlen, USB_CNTL_TIMEOUT * 5);
+	if (result < 0)
+		return result;
+
+	return usb_bulk_msg(udev, pipe, &uc->sense, sizeof(uc->sense),
+			    &actlen, USB_CNTL_TIMEOUT * 5);
+}
+
+/*
+ * Check the SENSE IU received for a command. If the command failed, the
+ * sense data is kept in @srb for the REQUEST SENSE which follows.
+ */
+static int usb_stor_UAS_status(struct us_data *us, struct scsi_cmd *srb,
+			       struct sense_iu *sense, int tag)
+{
+	if (sense->iu_id != IU_ID_STATUS || be16_to_cpu(sense->tag) != tag) {
+		debug("UAS: bad status IU %#x tag %d\n", sense->iu_id,
+		      be16_to_cpu(sense->tag));
+		return USB_STOR_TRANSPORT_ERROR;
+	}
+	if (sense->status == S_GOOD)
+		return USB_STOR_TRANSPORT_GOOD;
+
+	debug("UAS: status %#x\n", sense->status);
+	if (sense->status == S_CHECK_COND) {
+		memcpy(srb->sense_buf, sense->sense,
+		       min_t(int, be16_to_cpu(sense->len),
+			     sizeof(srb->sense_buf)));
+		us->flags |= USB_UAS_SENSE;
+	}
+
+	return USB_STOR_TRANSPORT_FAILED;
+}
+
+/*
+ * Reset a UAS device after a transport error: clear any halt on its
+ * endpoints, then abort its commands with a LOGICAL UNIT RESET.
+ */
+static int usb_stor_UAS_reset(struct us_data *us)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_stor_uas_cmd, uc, 1);
+	struct usb_device *udev = us->pusb_dev;
+	struct usb_bulk_xfer xfer[2];
+	unsigned long pipe_cmd, pipe_status;
+	int actlen, result;
+
+	debug("UAS: reset\n");
+	pipe_cmd = usb_sndbulkpipe(udev, us->ep_cmd);
+	pipe_status = usb_rcvbulkpipe(udev, us->ep_status);
+	usb_clear_halt(udev, pipe_cmd);
+	usb_clear_halt(udev, pipe_status);
+	usb_clear_halt(udev, usb_rcvbulkpipe(udev, us->ep_in));
+	usb_clear_halt(udev, usb_sndbulkpipe(udev, us->ep_out));
+
+	memset(&uc->tmf, '\0', sizeof(uc->tmf));
+	uc->tmf.iu_id = IU_ID_TASK_MGMT;
+	uc->tmf.tag = cpu_to_be16(USB_UAS_TAG);
+	uc->tmf.function = TMF_LOGICAL_UNIT_RESET;
+	if (us->streams) {
+		memset(xfer, '\0', sizeof(xfer));
+		xfer[0].pipe = pipe_status;
+		xfer[0].stream = USB_UAS_TAG;
+		xfer[0].buffer = &uc->resp;
+		xfer[0].length = sizeof(uc->sense);
+		xfer[1].pipe = pipe_cmd;
+		xfer[1].buffer = &uc->tmf;
+		xfer[1].length = sizeof(uc->tmf);
+		result = usb_bulk_batch(udev, xfer, 2, USB_CNTL_TIMEOUT * 5);
+	} else {
+		result = usb_bulk_msg(udev, pipe_cmd, &uc->tmf, sizeof(uc->tmf),
+				      &actlen, USB_CNTL_TIMEOUT * 5);
+		if (!result)
+			result = usb_bulk_msg(udev, pipe_status, &uc->resp,
+					      sizeof(uc->sense), &actlen,
+					      USB_CNTL_TIMEOUT * 5);
+	}
+	if (result || uc->resp.iu_id != IU_ID_RESPONSE ||
+	    uc->resp.response_code != RC_TMF_COMPLETE) {
+		debug("UAS: reset failed\n");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int usb_stor_UAS_transport(struct scsi_cmd *srb, struct us_data *us)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_stor_uas_cmd, uc, 1);
+	struct usb_bulk_xfer xfer[3];
+	int n, result;
+
+	/* the sense data arrived with the status of the failed command */
+	if (srb->cmd[0] == SCSI_REQ_SENSE && (us->flags & USB_UAS_SENSE)) {
+		us->flags &= ~USB_UAS_SENSE;
+		if (srb->pdata != srb->sense_buf)
+			memcpy(srb->pdata, srb->sense_buf,
+			       min_t(int, srb->datalen,
+				     sizeof(srb->sense_buf)));
+		return USB_STOR_TRANSPORT_GOOD;
+	}
+	us->flags &= ~USB_UAS_SENSE;
+
+	if (us->streams) {
+		n = usb_stor_UAS_setup_xfer(us, uc, srb, USB_UAS_TAG, xfer);
+		result = usb_bulk_batch(us->pusb_dev, xfer, n,
+					USB_CNTL_TIMEOUT * 5);
+	} else {
+		result = usb_stor_UAS_run(us, uc, srb);
+	}
+	if (result < 0) {
+		debug("UAS: transport error %d\n", result);
+		usb_stor_UAS_reset(us);
+		return USB_STOR_TRANSPORT_FAILED;
+	}
+
+	result = usb_stor_UAS_status(us, srb, &uc->sense, USB_UAS_TAG);
+	if (result == USB_STOR_TRANSPORT_ERROR) {
+		usb_stor_UAS_reset(us);
+		return USB_STOR_TRANSPORT_FAILED;
+	}
+
+	return result;
+}
+#endif
+
 static int usb_stor_CB_transport(struct scsi_cmd *srb, struct us_data *us)
 {
 	int result, status;
@@ -1061,11 +1308,11 @@ static int usb_read_capacity(struct scsi_cmd *srb, struct us_data *ss)
 	return -1;
 }
 
-static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
-		       unsigned long start, unsigned short blocks)
+static void usb_set_rw_10(struct scsi_cmd *srb, unsigned char op,
+			  unsigned long start, unsigned short blocks)
 {
 	memset(&srb->cmd[0], 0, 12);
-	srb->cmd[0] = SCSI_READ10;
+	srb->cmd[0] = op;
 	srb->cmd[1] = srb->lun << 5;
 	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
 	srb->cmd[3] = ((unsigned char) (start >> 16)) & 0xff;
@@ -1074,6 +1321,12 @@ static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
 	srb->cmd[7] = ((unsigned char) (blocks >> 8)) & 0xff;
 	srb->cmd[8] = (unsigned char) blocks & 0xff;
 	srb->cmdlen = 12;
+}
+
+static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
+		       unsigned long start, unsigned short blocks)
+{
+	usb_set_rw_10(srb, SCSI_READ10, start, blocks);
 	debug("read10: start %lx blocks %x\n", start, blocks);
 	return ss->transport(srb, ss);
 }
@@ -1081,20 +1334,158 @@ static int usb_read_10(struct scsi_cmd *srb, struct us_data *ss,
 static int usb_write_10(struct scsi_cmd *srb, struct us_data *ss,
 			unsigned long start, unsigned short blocks)
 {
-	memset(&srb->cmd[0], 0, 12);
-	srb->cmd[0] = SCSI_WRITE10;
-	srb->cmd[1] = srb->lun << 5;
-	srb->cmd[2] = ((unsigned char) (start >> 24)) & 0xff;
-	srb->cmd[3] = ((unsigned char) (start >> 16)) & 0xff;
-	srb->cmd[4] = ((unsigned char) (start >> 8)) & 0xff;
-	srb->cmd[5] = ((unsigned char) (start)) & 0xff;
-	srb->cmd[7] = ((unsigned char) (blocks >> 8)) & 0xff;
-	srb->cmd[8] = (unsigned char) blocks & 0xff;
-	srb->cmdlen = 12;
+	usb_set_rw_10(srb, SCSI_WRITE10, start, blocks);
 	debug("write10: start %lx blocks %x\n", start, blocks);
 	return ss->transport(srb, ss);
 }
 
+/*
+ * Read a run of blocks from a BBB device using several READ(10) commands
+ * at once. The CBW, data and CSW of each command are handed to the host
+ * controller together, so that it can move from one stage to the next
+ * without waiting for us. Bulk-only transport does not allow a CBW to be
+ * sent until the CSW of the previous command has arrived, so each CBW
+ * after the first is queued behind a barrier.
+ *
+ * Returns the number of blocks read. If this is less than @blks, the
+ * caller should read the rest with usb_read_10(), which handles errors.
+ */
+static lbaint_t usb_stor_BBB_read_batch(struct us_data *ss,
+					struct blk_desc *block_dev,
+					lbaint_t start, lbaint_t blks,
+					uintptr_t buf_addr)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_stor_bbb_cmd, cmd, USB_STOR_BATCH);
+	struct usb_bulk_xfer xfer[USB_STOR_BATCH * 3];
+	unsigned short count[USB_STOR_BATCH];
+	struct usb_device *udev = ss->pusb_dev;
+	unsigned long pipein, pipeout;
+	struct scsi_cmd srb;
+	lbaint_t done = 0, pos;
+	int i, n;
+
+	pipein = usb_rcvbulkpipe(udev, ss->ep_in);
+	pipeout = usb_sndbulkpipe(udev, ss->ep_out);
+	memset(&srb, '\0', sizeof(srb));
+	srb.lun = block_dev->lun;
+
+	while (done < blks) {
+		memset(xfer, '\0', sizeof(xfer));
+		for (n = 0, pos = done; n < USB_STOR_BATCH && pos < blks; n++) {
+			struct usb_bulk_xfer *x = &xfer[n * 3];
+
+			count[n] = min(blks - pos, (lbaint_t)ss->max_xfer_blk);
+			usb_set_rw_10(&srb, SCSI_READ10, start + pos, count[n]);
+			srb.datalen = block_dev->blksz * count[n];
+			usb_stor_BBB_set_cbw(&cmd[n].cbw, &srb);
+
+			x[0].pipe = pipeout;
+			x[0].buffer = &cmd[n].cbw;
+			x[0].length = UMASS_BBB_CBW_SIZE;
+			x[0].flags = n ? USB_BULK_BARRIER : 0;
+			x[1].pipe = pipein;
+			x[1].buffer = (void *)(buf_addr +
+					       pos * block_dev->blksz);
+			x[1].length = srb.datalen;
+			x[2].pipe = pipein;
+			x[2].buffer = &cmd[n].csw;
+			x[2].length = UMASS_BBB_CSW_SIZE;
+			pos += count[n];
+		}
+		debug("read10 batch: start " LBAF " commands %d\n",
+		      start + done, n);
+
+		/* Errors are picked up from the status of each transfer */
+		usb_bulk_batch(udev, xfer, n * 3, USB_CNTL_TIMEOUT * 5);
+
+		for (i = 0; i < n; i++) {
+			struct umass_bbb_csw *csw = &cmd[i].csw;
+			struct usb_bulk_xfer *x = &xfer[i * 3];
+
+			if (x[0].status || x[1].status || x[2].status ||
+			    x[2].act_len != UMASS_BBB_CSW_SIZE ||
+			    le32_to_cpu(csw->dCSWSignature) != CSWSIGNATURE ||
+			    csw->dCSWTag != cmd[i].cbw.dCBWTag) {
+				debug("read10 batch: transport error\n");
+				usb_stor_BBB_reset(ss);
+				return done;
+			}
+			if (csw->bCSWStatus != CSWSTATUS_GOOD ||
+			    csw->dCSWDataResidue || x[1].act_len != x[1].length)
+				return done;
+			if (count[i] == ss->max_xfer_blk)
+				usb_show_progress();
+			done += count[i];
+		}
+	}
+
+	return done;
+}
+
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+/*
+ * Read a run of blocks from a UAS device with streams, using several
+ * READ(10) commands at once. Each command has its own tag and so its own
+ * stream, so unlike bulk-only transport they can all be sent together and
+ * the device can work on them in any order.
+ *
+ * Returns the number of blocks read, as usb_stor_BBB_read_batch()
+ */
+static lbaint_t usb_stor_UAS_read_batch(struct us_data *ss,
+					struct blk_desc *block_dev,
+					lbaint_t start, lbaint_t blks,
+					uintptr_t buf_addr)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_stor_uas_cmd, uc, USB_STOR_BATCH);
+	struct usb_bulk_xfer xfer[USB_STOR_BATCH * 3];
+	unsigned short count[USB_STOR_BATCH];
+	int max = min_t(int, USB_STOR_BATCH, ss->streams);
+	struct scsi_cmd srb;
+	lbaint_t done = 0, pos;
+	int i, n, ret;
+
+	memset(&srb, '\0', sizeof(srb));
+	srb.lun = block_dev->lun;
+
+	while (done < blks) {
+		for (n = 0, pos = done; n < max && pos < blks; n++) {
+			count[n] = min(blks - pos, (lbaint_t)ss->max_xfer_blk);
+			usb_set_rw_10(&srb, SCSI_READ10, start + pos, count[n]);
+			srb.datalen = block_dev->blksz * count[n];
+			srb.pdata = (unsigned char *)(buf_addr +
+						      pos * block_dev->blksz);
+			usb_stor_UAS_setup_xfer(ss, &uc[n], &srb, n + 1,
+						&xfer[n * 3]);
+			pos += count[n];
+		}
+		debug("read10 batch: start " LBAF " commands %d\n",
+		      start + done, n);
+
+		usb_bulk_batch(ss->pusb_dev, xfer, n * 3, USB_CNTL_TIMEOUT * 5);
+
+		for (i = 0; i < n; i++) {
+			struct usb_bulk_xfer *x = &xfer[i * 3];
+
+			ret = USB_STOR_TRANSPORT_ERROR;
+			if (!x[0].status && !x[1].status && !x[2].status)
+				ret = usb_stor_UAS_status(ss, &srb,
+							  &uc[i].sense, i + 1);
+			if (ret == USB_STOR_TRANSPORT_ERROR) {
+				debug("read10 batch: transport error\n");
+				usb_stor_UAS_reset(ss);
+				return done;
+			}
+			if (ret || x[1].act_len != x[1].length)
+				return done;
+			if (count[i] == ss->max_xfer_blk)
+				usb_show_progress();
+			done += count[i];
+		}
+	}
+
+	return done;
+}
+#endif
 
 #ifdef CONFIG_USB_BIN_FIXUP
 /*
@@ -1129,9 +1520,10 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 {
 	lbaint_t start, blks;
 	uintptr_t buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks = 0;
 	struct usb_device *udev;
 	struct us_data *ss;
+	bool pipeline;
 	int retry;
 	struct scsi_cmd *srb = &usb_ccb;
 #if CONFIG_IS_ENABLED(BLK)
@@ -1160,6 +1552,15 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 	buf_addr = (uintptr_t)buffer;
 	start = blknr;
 	blks = blkcnt;
+	/*
+	 * Once the first command has succeeded, read the rest in batches.
+	 * If a batch fails, finish off one command at a time.
+	 */
+	pipeline = ss->transport == usb_stor_BBB_transport;
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+	if (ss->protocol == US_PR_UAS)
+		pipeline = ss->streams > 1;
+#endif
 
 	debug("\nusb_read: dev %d startblk " LBAF ", blccnt " LBAF " buffer %lx\n",
 	      block_dev->devnum, start, blks, buf_addr);
@@ -1188,6 +1589,24 @@ retry_it:
 		start += smallblks;
 		blks -= smallblks;
 		buf_addr += srb->datalen;
+		if (blks && pipeline) {
+			lbaint_t done;
+
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+			if (ss->protocol == US_PR_UAS)
+				done = usb_stor_UAS_read_batch(ss, block_dev,
+							       start, blks,
+							       buf_addr);
+			else
+#endif
+				done = usb_stor_BBB_read_batch(ss, block_dev,
+							       start, blks,
+							       buf_addr);
+			pipeline = done == blks;
+			start += done;
+			blks -= done;
+			buf_addr += done * block_dev->blksz;
+		}
 	} while (blks != 0);
 	ss->flags &= ~USB_READY;
 
@@ -1286,6 +1705,136 @@ retry_it:
 
 }
 
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+/*
+ * Check whether the device is listed in the "usb_uas_ignore" environment
+ * variable, as vendor:product IDs in hex, e.g. "174c:55aa 152d:0578"
+ */
+static bool usb_stor_UAS_ignored(struct usb_device *dev)
+{
+	const char *list = env_get("usb_uas_ignore");
+	ulong vid, pid;
+	char *end;
+
+	while (list && *list) {
+		vid = simple_strtoul(list, &end, 16);
+		if (*end != ':')
+			break;
+		pid = simple_strtoul(end + 1, &end, 16);
+		if (vid == dev->descriptor.idVendor &&
+		    pid == dev->descriptor.idProduct)
+			return true;
+		for (list = end; *list == ' ' || *list == ','; list++)
+			;
+	}
+
+	return false;
+}
+
+/*
+ * Look for a UAS alternate setting on a mass-storage interface and switch
+ * to it if there is one. The endpoints are identified by their pipe usage
+ * descriptors, which the USB core does not keep, so the configuration
+ * descriptor is read again here. At SuperSpeed the data and status pipes
+ * need streams; if the host controller cannot set them up, the device is
+ * left in the bulk-only alternate setting.
+ */
+static void usb_stor_UAS_probe(struct usb_device *dev,
+			       struct usb_interface *iface, struct us_data *ss)
+{
+	int ifnum = iface->desc.bInterfaceNumber;
+	unsigned char ep[DATA_OUT_PIPE_ID + 1] = { 0 };
+	struct usb_descriptor_header *head;
+	struct usb_interface_descriptor *intf;
+	struct usb_pipe_usage_descriptor *usage;
+	int len, pos, alt = -1, addr = 0;
+	int streams = 0, max_streams = INT_MAX;
+	unsigned long pipes[3];
+	unsigned char *buf;
+	int ret;
+
+	if (usb_stor_UAS_ignored(dev)) {
+		debug("UAS: ignored\n");
+		return;
+	}
+	len = usb_get_configuration_len(dev, 0);
+	if (len < 0)
+		return;
+	buf = malloc_cache_aligned(len);
+	if (!buf)
+		return;
+	if (usb_get_configuration_no(dev, 0, buf, len) != len)
+		goto out;
+
+	for (pos = 0; pos + 2 <= len; pos += head->bLength) {
+		head = (struct usb_descriptor_header *)&buf[pos];
+		if (head->bLength < 2 || pos + head->bLength > len)
+			break;
+		if (head->bDescriptorType == USB_DT_INTERFACE) {
+			/* stop at the end of the UAS alternate setting */
+			if (alt >= 0)
+				break;
+			intf = (struct usb_interface_descriptor *)head;
+			if (intf->bInterfaceNumber == ifnum &&
+			    intf->bInterfaceClass == USB_CLASS_MASS_STORAGE &&
+			    intf->bInterfaceSubClass == US_SC_SCSI &&
+			    intf->bInterfaceProtocol == US_PR_UAS)
+				alt = intf->bAlternateSetting;
+		} else if (head->bDescriptorType == USB_DT_ENDPOINT) {
+			addr = ((struct usb_endpoint_descriptor *)head)->
+				bEndpointAddress;
+			streams = 0;
+		} else if (head->bDescriptorType == USB_DT_SS_ENDPOINT_COMP) {
+			streams = usb_ss_max_streams(
+				(struct usb_ss_ep_comp_descriptor *)head);
+		} else if (head->bDescriptorType == USB_DT_PIPE_USAGE &&
+			   alt >= 0) {
+			usage = (struct usb_pipe_usage_descriptor *)head;
+			if (usage->bPipeID < CMD_PIPE_ID ||
+			    usage->bPipeID > DATA_OUT_PIPE_ID)
+				continue;
+			ep[usage->bPipeID] = addr & USB_ENDPOINT_NUMBER_MASK;
+			if (usage->bPipeID != CMD_PIPE_ID)
+				max_streams = min(max_streams, streams);
+		}
+	}
+	if (alt < 0 || !ep[CMD_PIPE_ID] || !ep[STATUS_PIPE_ID] ||
+	    !ep[DATA_IN_PIPE_ID] || !ep[DATA_OUT_PIPE_ID])
+		goto out;
+	if (usb_set_interface(dev, ifnum, alt))
+		goto out;
+
+	if (dev->speed >= USB_SPEED_SUPER) {
+		pipes[0] = usb_rcvbulkpipe(dev, ep[STATUS_PIPE_ID]);
+		pipes[1] = usb_rcvbulkpipe(dev, ep[DATA_IN_PIPE_ID]);
+		pipes[2] = usb_sndbulkpipe(dev, ep[DATA_OUT_PIPE_ID]);
+		ret = -ENOSYS;
+		if (max_streams > 0)
+			ret = usb_alloc_streams(dev, pipes, ARRAY_SIZE(pipes),
+						min(max_streams,
+						    USB_STOR_BATCH));
+		if (ret < 0) {
+			debug("UAS: no streams (err=%d)\n", ret);
+			usb_set_interface(dev, ifnum, 0);
+			goto out;
+		}
+		ss->streams = ret;
+	}
+
+	ss->protocol = US_PR_UAS;
+	ss->ep_cmd = ep[CMD_PIPE_ID];
+	ss->ep_status = ep[STATUS_PIPE_ID];
+	ss->ep_in = ep[DATA_IN_PIPE_ID];
+	ss->ep_out = ep[DATA_OUT_PIPE_ID];
+	ss->transport = usb_stor_UAS_transport;
+	ss->transport_reset = usb_stor_UAS_reset;
+	debug("UAS: alt %d cmd %d status %d in %d out %d streams %d\n", alt,
+	      ss->ep_cmd, ss->ep_status, ss->ep_in, ss->ep_out, ss->streams);
+out:
+	free(buf);
+}
+#endif
+
 /* Probe to see if a new device is actually a Storage device */
 int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 		      struct us_data *ss)
@@ -1392,6 +1941,10 @@ int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 		printf("Sorry, protocol %d not yet supported.\n", ss->subclass);
 		return 0;
 	}
+#if CONFIG_IS_ENABLED(USB_STORAGE_UAS)
+	if (ss->subclass == US_SC_SCSI)
+		usb_stor_UAS_probe(dev, iface, ss);
+#endif
 	if (ss->ep_int) {
 		/* we had found an interrupt endpoint, prepare irq pipe
 		 * set up the IRQ pipe and handler
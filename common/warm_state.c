@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Passing the state of probed devices from one boot phase to the next
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <warm_state.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define foreach_warm_rec(_rec, _hdr) \
+	for (_rec = (struct warm_state_rec *)((_hdr) + 1); \
+	     (void *)_rec < (void *)((_hdr) + 1) + (_hdr)->used; \
+	     _rec = (void *)(_rec + 1) + ALIGN(_rec->size, 4))
+
+static struct warm_state_rec *warm_state_findrec(struct warm_state_hdr *hdr,
+						 enum uclass_id id, u32 key)
+{
+	struct warm_state_rec *rec;
+
+	foreach_warm_rec(rec, hdr) {
+		if (rec->uclass_id == id && rec->key == key)
+			return rec;
+	}
+
+	return NULL;
+}
+
+int warm_state_save(enum uclass_id id, u32 key, const void *data, int size)
+{
+	struct warm_state_hdr *hdr;
+	struct warm_state_rec *rec;
+
+	if (!gd->bloblist)
+		return -ENOENT;
+	hdr = bloblist_find(BLOBLISTT_WARM_STATE, CONFIG_WARM_STATE_SIZE);
+	if (!hdr) {
+		hdr = bloblist_add(BLOBLISTT_WARM_STATE, CONFIG_WARM_STATE_SIZE);
+		if (!hdr)
+			return -ENOSPC;
+		hdr->used = 0;
+		hdr->count = 0;
+	}
+	rec = warm_state_findrec(hdr, id, key);
+	if (rec) {
+		if (rec->size != size)
+			return -ESPIPE;
+	} else {
+		int new_used;
+
+		new_used = hdr->used + sizeof(*rec) + ALIGN(size, 4);
+		if (sizeof(*hdr) + new_used > CONFIG_WARM_STATE_SIZE)
+			return -ENOSPC;
+		rec = (void *)(hdr + 1) + hdr->used;
+		rec->uclass_id = id;
+		rec->size = size;
+		rec->key = key;
+		hdr->used = new_used;
+		hdr->count++;
+	}
+	memcpy(rec + 1, data, size);
+
+	return 0;
+}
+
+const void *warm_state_find(enum uclass_id id, u32 key, int size)
+{
+	struct warm_state_hdr *hdr;
+	struct warm_state_rec *rec;
+
+	hdr = bloblist_find(BLOBLISTT_WARM_STATE, CONFIG_WARM_STATE_SIZE);
+	if (!hdr)
+		return NULL;
+	rec = warm_state_findrec(hdr, id, key);
+	if (!rec || rec->size != size)
+		return NULL;
+
+	return rec + 1;
+}
+
+int warm_state_count(void)
+{
+	struct warm_state_hdr *hdr;
+
+	hdr = bloblist_find(BLOBLISTT_WARM_STATE, CONFIG_WARM_STATE_SIZE);
+
+	return hdr ? hdr->count : 0;
+}
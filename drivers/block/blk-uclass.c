@@ -7,6 +7,8 @@
 #include <common.h>
 #include <blk.h>
 #include <dm.h>
+#include <image.h>
+#include <mapmem.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -436,6 +438,8 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	if (!ops->read)
 		return -ENOSYS;
 
+	fit_handoff_invalidate(map_to_sysmem(buffer),
+			       blkcnt * block_dev->blksz);
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
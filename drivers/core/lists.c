@@ -11,12 +11,15 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/of_access.h>
 #include <dm/platdata.h>
 #include <dm/uclass.h>
 #include <dm/util.h>
 #include <fdtdec.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -122,11 +125,112 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   bool pre_reloc_only)
+#ifdef CONFIG_OF_LIVE
+/**
+ * struct driver_compat - Driver which matches a compatible string
+ *
+ * @drv: Driver to use
+ * @of_id: Entry in the driver's of_match list which matched
+ */
+struct driver_compat {
+	struct driver *drv;
+	const struct udevice_id *of_id;
+};
+
+/* Drivers indexed by compatible-string ID, built after relocation */
+static struct of_strtab *driver_compat_tab;
+static struct driver_compat *driver_compats;
+
+/**
+ * driver_compat_index_build() - Index all drivers by compatible string
+ *
+ * Where several drivers have the same compatible string, the first one in
+ * the linker list is used, as with a linear search.
+ *
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+static int driver_compat_index_build(void)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_match;
+	struct driver *entry;
+	struct of_strtab *tab;
+	uint count = 0;
+	void *buf;
+	int id;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_match = entry->of_match; of_match &&
+		     of_match->compatible; of_match++)
+			count++;
+	}
+	buf = malloc(ALIGN(sizeof(*tab), sizeof(void *)) +
+		     count * sizeof(struct driver_compat) +
+		     of_strtab_size(count));
+	if (!buf)
+		return -ENOMEM;
+	tab = buf;
+	driver_compats = buf + ALIGN(sizeof(*tab), sizeof(void *));
+	of_strtab_init(tab, driver_compats + count, count, false);
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_match = entry->of_match; of_match &&
+		     of_match->compatible; of_match++) {
+			uint old_count = tab->count;
+
+			id = of_strtab_add(tab, of_match->compatible);
+			if (tab->count != old_count) {
+				driver_compats[id].drv = entry;
+				driver_compats[id].of_id = of_match;
+			}
+		}
+	}
+	driver_compat_tab = tab;
+
+	return 0;
+}
+#endif
+
+/**
+ * driver_lookup_compatible() - Find the driver for a compatible string
+ *
+ * @compat:	The compatible string to search for
+ * @of_idp:	Returns the match that was found
+ * @return driver found, or NULL if none
+ */
+static struct driver *driver_lookup_compatible(const char *compat,
+					       const struct udevice_id **of_idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#ifdef CONFIG_OF_LIVE
+	/* The index uses malloc() space, so wait until after relocation */
+	if (!driver_compat_tab && (gd->flags & GD_FLG_RELOC))
+		driver_compat_index_build();
+	if (driver_compat_tab) {
+		int id = of_strtab_find(driver_compat_tab, compat);
+
+		if (id < 0)
+			return NULL;
+		*of_idp = driver_compats[id].of_id;
+
+		return driver_compats[id].drv;
+	}
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, of_idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -163,14 +267,11 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		pr_debug("   - attempt to match compatible string '%s'\n",
 			 compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = driver_lookup_compatible(compat, &id);
+		if (!entry) {
+			ret = -ENOENT;
 			continue;
+		}
 
 		if (pre_reloc_only) {
 			if (!dm_ofnode_pre_reloc(node) &&
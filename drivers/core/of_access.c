@@ -43,6 +43,9 @@ static struct device_node *of_stdout;
 /* pointer to options given after the alias (separated by :) or NULL if none */
 static const char *of_stdout_options;
 
+/* lookup tables for the live tree, or NULL if none */
+static struct of_live_index *of_index;
+
 /**
  * struct alias_prop - Alias property in 'aliases' node
  *
@@ -119,16 +122,38 @@ int of_simple_size_cells(const struct device_node *np)
 	return 2;
 }
 
+/* Check if a node or property belongs to the tree that was indexed */
+static bool of_index_has(const void *ptr)
+{
+	return of_index && ptr >= (void *)of_index->root &&
+		ptr < (void *)of_index;
+}
+
+/*
+ * Interned names are compared by ID, others by string. IDs from another tree
+ * or added later may not match the index, so they are not trusted.
+ */
+static bool of_prop_name_match(const struct property *pp, const char *name,
+			       int id)
+{
+	if (pp->id >= 0 && of_index_has(pp))
+		return pp->id == id;
+
+	return of_prop_cmp(pp->name, name) == 0;
+}
+
 struct property *of_find_property(const struct device_node *np,
 				  const char *name, int *lenp)
 {
 	struct property *pp;
+	int id;
 
 	if (!np)
 		return NULL;
 
+	id = of_prop_name_id(name);
 	for (pp = np->properties; pp; pp = pp->next) {
-		if (strcmp(pp->name, name) == 0) {
+		if (of_prop_name_match(pp, name, id)) {
 			if (lenp)
 				*lenp = pp->length;
 			break;
@@ -362,11 +387,61 @@ struct device_node *of_find_node_opts_by_path(const char *path,
 	return np;
 }
 
+/**
+ * of_find_compatible_indexed() - Find a compatible node using the index
+ *
+ * @from: Node to start after, or NULL to start at the beginning
+ * @type: Required device_type value, NULL or "" for any match
+ * @compatible: Compatible string to find
+ * @npp: Returns the node found, or NULL if none
+ * @return true if the index was used, false if the caller must scan the tree
+ */
+static bool of_find_compatible_indexed(struct device_node *from,
+				       const char *type,
+				       const char *compatible,
+				       struct device_node **npp)
+{
+	struct device_node **nodes;
+	uint i, end;
+	int id;
+
+	*npp = NULL;
+	if (!of_index || !of_index->compats || !compatible || !*compatible)
+		return false;
+	if (of_index->root != gd->of_root)
+		return false;
+	id = of_strtab_find(of_index->compats, compatible);
+	if (id < 0)
+		return true;
+
+	nodes = of_index->compat_nodes;
+	i = of_index->compat_start[id];
+	end = of_index->compat_start[id + 1];
+	if (from) {
+		while (i < end && nodes[i] != from)
+			i++;
+		if (i == end)
+			return false;
+		i++;
+	}
+	for (; i < end; i++) {
+		if (of_device_is_compatible(nodes[i], compatible, type, NULL)) {
+			*npp = nodes[i];
+			break;
+		}
+	}
+
+	return true;
+}
+
 struct device_node *of_find_compatible_node(struct device_node *from,
 		const char *type, const char *compatible)
 {
 	struct device_node *np;
 
+	if (of_find_compatible_indexed(from, type, compatible, &np))
+		return np;
+
 	for_each_of_allnodes_from(from, np)
 		if (of_device_is_compatible(np, compatible, type, NULL) &&
 		    of_node_get(np))
@@ -834,3 +909,200 @@ struct device_node *of_get_stdout(void)
 {
 	return of_stdout;
 }
+
+static uint of_strtab_slots(uint max)
+{
+	uint slots = 4;
+
+	/* Keep the table at most half full so that probe chains are short */
+	while (slots < max * 2)
+		slots <<= 1;
+
+	return slots;
+}
+
+static uint of_strtab_hash(const struct of_strtab *tab, const char *str)
+{
+	uint hash = 2166136261U;
+
+	/* FNV-1a */
+	for (; *str; str++)
+		hash = (hash ^ (tab->nocase ? tolower(*str) : *str)) *
+			16777619U;
+
+	return hash;
+}
+
+/**
+ * of_strtab_lookup() - Find a string, or the slot where it should go
+ *
+ * @tab: Table to search
+ * @str: String to find
+ * @slotp: Returns the empty slot to use for @str, if not found
+ * @return ID of the string, or -ENOENT if not found
+ */
+static int of_strtab_lookup(const struct of_strtab *tab, const char *str,
+			    uint *slotp)
+{
+	uint i;
+
+	for (i = of_strtab_hash(tab, str) & tab->mask; tab->slot[i];
+	     i = (i + 1) & tab->mask) {
+		const char *s = tab->str[tab->slot[i] - 1];
+
+		if (tab->nocase ? !strcasecmp(s, str) : !strcmp(s, str))
+			return tab->slot[i] - 1;
+	}
+	*slotp = i;
+
+	return -ENOENT;
+}
+
+size_t of_strtab_size(uint max)
+{
+	return max * sizeof(const char *) + of_strtab_slots(max) * sizeof(uint);
+}
+
+void of_strtab_init(struct of_strtab *tab, void *buf, uint max, bool nocase)
+{
+	uint slots = of_strtab_slots(max);
+
+	tab->str = buf;
+	tab->slot = buf + max * sizeof(const char *);
+	memset(tab->slot, '\0', slots * sizeof(uint));
+	tab->count = 0;
+	tab->max = max;
+	tab->mask = slots - 1;
+	tab->nocase = nocase;
+}
+
+int of_strtab_add(struct of_strtab *tab, const char *str)
+{
+	uint slot;
+	int id;
+
+	id = of_strtab_lookup(tab, str, &slot);
+	if (id >= 0)
+		return id;
+	if (tab->count == tab->max)
+		return -ENOSPC;
+	id = tab->count++;
+	tab->str[id] = str;
+	tab->slot[slot] = id + 1;
+
+	return id;
+}
+
+int of_strtab_find(const struct of_strtab *tab, const char *str)
+{
+	uint slot;
+
+	return of_strtab_lookup(tab, str, &slot);
+}
+
+void of_live_set_index(struct of_live_index *index)
+{
+	of_compat_index_drop();
+	of_index = index;
+}
+
+int of_prop_name_id(const char *name)
+{
+	if (!of_index)
+		return -ENOENT;
+
+	return of_strtab_find(&of_index->names, name);
+}
+
+/* Check if a compatible string appears earlier in the same property */
+static bool of_compat_is_dup(struct property *prop, const char *cp)
+{
+	const char *prev;
+
+	for (prev = of_prop_next_string(prop, NULL); prev != cp;
+	     prev = of_prop_next_string(prop, prev)) {
+		if (!of_compat_cmp(prev, cp, 0))
+			return true;
+	}
+
+	return false;
+}
+
+int of_compat_index_build(void)
+{
+	struct device_node **nodes;
+	struct device_node *np;
+	struct of_strtab *tab;
+	struct property *prop;
+	const char *cp;
+	uint count = 0;
+	uint *start;
+	void *buf;
+	int id;
+
+	of_compat_index_drop();
+	/* Lookups scan gd->of_root, so only that tree is worth indexing */
+	if (!of_index || of_index->root != gd->of_root)
+		return -ENOENT;
+
+	for_each_of_allnodes(np) {
+		prop = of_find_property(np, "compatible", NULL);
+		for (cp = of_prop_next_string(prop, NULL); cp;
+		     cp = of_prop_next_string(prop, cp))
+			count++;
+	}
+
+	/* Put everything in one allocation, starting with the table */
+	buf = calloc(1, ALIGN(sizeof(*tab), sizeof(void *)) +
+		     of_strtab_size(count) + count * sizeof(*nodes) +
+		     (count + 1) * sizeof(*start));
+	if (!buf)
+		return -ENOMEM;
+	tab = buf;
+	buf += ALIGN(sizeof(*tab), sizeof(void *));
+	of_strtab_init(tab, buf, count, true);
+	nodes = buf + of_strtab_size(count);
+	start = (uint *)(nodes + count);
+
+	/* Count the nodes for each string, then turn counts into positions */
+	for_each_of_allnodes(np) {
+		prop = of_find_property(np, "compatible", NULL);
+		for (cp = of_prop_next_string(prop, NULL); cp;
+		     cp = of_prop_next_string(prop, cp)) {
+			if (!of_compat_is_dup(prop, cp))
+				start[of_strtab_add(tab, cp) + 1]++;
+		}
+	}
+	for (id = 0; id < tab->count; id++)
+		start[id + 1] += start[id];
+
+	for_each_of_allnodes(np) {
+		prop = of_find_property(np, "compatible", NULL);
+		for (cp = of_prop_next_string(prop, NULL); cp;
+		     cp = of_prop_next_string(prop, cp)) {
+			if (!of_compat_is_dup(prop, cp))
+				nodes[start[of_strtab_find(tab, cp)]++] = np;
+		}
+	}
+
+	/* Each entry now holds the end of its list, i.e. the next start */
+	for (id = tab->count; id > 0; id--)
+		start[id] = start[id - 1];
+	start[0] = 0;
+
+	of_index->compats = tab;
+	of_index->compat_start = start;
+	of_index->compat_nodes = nodes;
+
+	return 0;
+}
+
+void of_compat_index_drop(void)
+{
+	if (!of_index || !of_index->compats)
+		return;
+	free(of_index->compats);
+	of_index->compats = NULL;
+	of_index->compat_start = NULL;
+	of_index->compat_nodes = NULL;
+}
@@ -226,8 +226,8 @@ ofnode ofnode_get_by_phandle(uint phandle)
 	if (of_live_active())
 		node = np_to_ofnode(of_find_node_by_phandle(phandle));
 	else
-		node.of_offset = fdt_node_offset_by_phandle(gd->fdt_blob,
-							    phandle);
+		node.of_offset = fdtdec_node_offset_by_phandle(gd->fdt_blob,
+							       phandle);
 
 	return node;
 }
@@ -815,6 +815,10 @@ int ofnode_write_prop(ofnode node, const char *propname, int len,
 	if (!np)
 		return -EINVAL;
 
+	/* The compatible-string index does not track changes */
+	if (!strcmp(propname, "compatible"))
+		of_compat_index_drop();
+
 	for (pp = np->properties; pp; pp = pp->next) {
 		if (strcmp(pp->name, propname) == 0) {
 			/* Property exists -> change value */
@@ -839,6 +843,7 @@ int ofnode_write_prop(ofnode node, const char *propname, int len,
 		return -ENOMEM;
 	}
 
+	new->id = of_prop_name_id(propname);
 	new->value = (void *)value;
 	new->length = len;
 	new->next = NULL;
@@ -15,6 +15,7 @@
 #include <dma-uclass.h>
 #include <dt-structs.h>
 #include <errno.h>
+#include <watchdog.h>
 
 #ifdef CONFIG_DMA_CHANNELS
 static inline struct dma_ops *dma_dev_ops(struct udevice *dev)
@@ -234,6 +235,190 @@ int dma_memcpy(void *dst, void *src, size_t len)
 	return ops->transfer(dev, DMA_MEM_TO_MEM, dst, src, len);
 }
 
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+/* Longest time that dma_async_wait() allows a transfer to take */
+#define DMA_ASYNC_TIMEOUT_MS	10000
+
+static int dma_async_get_device(bool fill, struct udevice **devp)
+{
+	struct udevice *dev;
+
+	for (uclass_first_device(UCLASS_DMA, &dev); dev;
+	     uclass_next_device(&dev)) {
+		struct dma_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+		const struct dma_ops *ops = device_get_ops(dev);
+
+		if (!(uc_priv->supported & DMA_SUPPORTS_MEM_TO_MEM))
+			continue;
+		/* transfer() can only copy, so fills need an async device */
+		if ((ops->submit && ops->poll) || (ops->transfer && !fill)) {
+			*devp = dev;
+			return 0;
+		}
+	}
+
+	return -ENODEV;
+}
+
+static void dma_async_flush(const struct dma_async_desc *desc, bool before)
+{
+	int i;
+
+	for (i = 0; i < desc->count; i++) {
+		const struct dma_sg *sg = &desc->sg[i];
+		ulong start = (ulong)sg->dst;
+		ulong end = start + sg->len;
+
+		/*
+		 * Beforehand, write back anything dirty in the destination
+		 * so that no writeback races with the DMA. Afterwards, drop
+		 * any lines fetched speculatively while the DMA was running.
+		 */
+		if (before) {
+			flush_dcache_range(start, end);
+			if (sg->src)
+				flush_dcache_range(
+					rounddown((ulong)sg->src,
+						  ARCH_DMA_MINALIGN),
+					roundup((ulong)sg->src + sg->len,
+						ARCH_DMA_MINALIGN));
+		} else {
+			invalidate_dcache_range(start, end);
+		}
+	}
+}
+
+static int dma_async_complete(struct dma_async_desc *desc, int ret)
+{
+	desc->status = ret;
+	if (!ret)
+		dma_async_flush(desc, false);
+
+	return ret;
+}
+
+int dma_async_submit(struct dma_async_desc *desc)
+{
+	const struct dma_ops *ops;
+	struct udevice *dev;
+	bool fill = false;
+	int i, ret;
+
+	desc->dev = NULL;
+	for (i = 0; i < desc->count; i++) {
+		const struct dma_sg *sg = &desc->sg[i];
+		ulong dst = (ulong)sg->dst, src = (ulong)sg->src;
+
+		/*
+		 * The destination is invalidated once the transfer is done, so
+		 * it must not share a cache line with anything else
+		 */
+		if (!IS_ALIGNED(dst, ARCH_DMA_MINALIGN) ||
+		    !IS_ALIGNED(sg->len, ARCH_DMA_MINALIGN)) {
+			ret = -EINVAL;
+			goto err;
+		}
+		if (!sg->src) {
+			fill = true;
+		} else if (dst < src + sg->len && src < dst + sg->len) {
+			ret = -EINVAL;
+			goto err;
+		}
+	}
+
+	ret = dma_async_get_device(fill, &dev);
+	if (ret)
+		goto err;
+	ops = device_get_ops(dev);
+	dma_async_flush(desc, true);
+	desc->dev = dev;
+
+	if (ops->submit && ops->poll) {
+		ret = ops->submit(dev, desc);
+		if (ret)
+			goto err;
+		desc->status = -EINPROGRESS;
+
+		return 0;
+	}
+
+	/* Synchronous device: the transfer is complete when this returns */
+	for (i = 0; i < desc->count; i++) {
+		const struct dma_sg *sg = &desc->sg[i];
+
+		ret = ops->transfer(dev, DMA_MEM_TO_MEM, sg->dst,
+				    (void *)sg->src, sg->len);
+		if (ret)
+			goto err;
+	}
+
+	return dma_async_complete(desc, 0);
+
+err:
+	desc->status = ret;
+
+	return ret;
+}
+
+int dma_async_poll(struct dma_async_desc *desc)
+{
+	const struct dma_ops *ops;
+	int ret;
+
+	if (desc->status != -EINPROGRESS)
+		return desc->status;
+
+	ops = device_get_ops(desc->dev);
+	ret = ops->poll(desc->dev, desc);
+	if (ret == -EINPROGRESS)
+		return ret;
+
+	return dma_async_complete(desc, ret);
+}
+
+int dma_async_wait(struct dma_async_desc *desc)
+{
+	const struct dma_ops *ops;
+	ulong start;
+	int ret;
+
+	if (desc->status != -EINPROGRESS)
+		return desc->status;
+
+	ops = device_get_ops(desc->dev);
+	if (ops->wait)
+		return dma_async_complete(desc, ops->wait(desc->dev, desc));
+
+	start = get_timer(0);
+	while ((ret = dma_async_poll(desc)) == -EINPROGRESS) {
+		if (get_timer(start) > DMA_ASYNC_TIMEOUT_MS) {
+			pr_err("%s: DMA transfer timed out\n", desc->dev->name);
+			desc->status = -ETIMEDOUT;
+			return -ETIMEDOUT;
+		}
+		WATCHDOG_RESET();
+	}
+
+	return ret;
+}
+
+int dma_memmove(void *dst, const void *src, size_t len)
+{
+	struct dma_sg sg = { .dst = dst, .src = src, .len = len };
+	struct dma_async_desc desc = { .sg = &sg, .count = 1 };
+
+	if (dst == src || !len)
+		return 0;
+
+	if (dma_async_submit(&desc)) {
+		memmove(dst, src, len);
+		return 0;
+	}
+
+	return dma_async_wait(&desc);
+}
+#endif /* DMA_ASYNC */
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
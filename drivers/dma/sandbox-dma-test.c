@@ -13,10 +13,14 @@
 #include <dma-uclass.h>
 #include <dt-structs.h>
 #include <errno.h>
+#include <asm/test.h>
 
 #define SANDBOX_DMA_CH_CNT 3
 #define SANDBOX_DMA_BUF_SIZE 1024
 
+/* Speed of the simulated memory-to-memory engine */
+#define SANDBOX_DMA_BYTES_PER_US	1
+
 struct sandbox_dma_chan {
 	struct sandbox_dma_dev *ud;
 	char name[20];
@@ -34,6 +38,14 @@ struct sandbox_dma_dev {
 	uchar	*buf_rx;
 	size_t	data_len;
 	u32	meta;
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+	struct dma_async_desc *async;	/* transfer in progress, or NULL */
+	ulong	async_start;		/* timer_get_us() at submit time */
+	ulong	async_done;		/* bytes moved so far */
+	ulong	async_total;
+	ulong	overlap;		/* bytes moved in the background */
+	ulong	stall;			/* bytes moved inside wait() */
+#endif
 };
 
 static int sandbox_dma_transfer(struct udevice *dev, int direction,
@@ -44,6 +56,107 @@ static int sandbox_dma_transfer(struct udevice *dev, int direction,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+/* Move the transfer on to byte @upto, working through the segments */
+static void sandbox_dma_advance(struct sandbox_dma_dev *ud, ulong upto)
+{
+	struct dma_async_desc *desc = ud->async;
+	ulong pos = 0;
+	int i;
+
+	for (i = 0; i < desc->count && ud->async_done < upto; i++) {
+		const struct dma_sg *sg = &desc->sg[i];
+
+		if (ud->async_done < pos + sg->len) {
+			ulong start = ud->async_done - pos;
+			ulong end = min(upto - pos, (ulong)sg->len);
+
+			if (sg->src)
+				memcpy(sg->dst + start, sg->src + start,
+				       end - start);
+			else
+				memset(sg->dst + start, desc->fill,
+				       end - start);
+			ud->async_done = pos + end;
+		}
+		pos += sg->len;
+	}
+}
+
+/* Catch up with the data the engine has moved since the last call */
+static void sandbox_dma_update(struct sandbox_dma_dev *ud)
+{
+	ulong upto, done = ud->async_done;
+
+	upto = (timer_get_us() - ud->async_start) * SANDBOX_DMA_BYTES_PER_US;
+	sandbox_dma_advance(ud, min(upto, ud->async_total));
+	ud->overlap += ud->async_done - done;
+}
+
+static int sandbox_dma_submit(struct udevice *dev,
+			      struct dma_async_desc *desc)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+	int i;
+
+	if (ud->async)
+		return -EBUSY;
+
+	ud->async = desc;
+	ud->async_start = timer_get_us();
+	ud->async_done = 0;
+	ud->async_total = 0;
+	for (i = 0; i < desc->count; i++)
+		ud->async_total += desc->sg[i].len;
+
+	return 0;
+}
+
+static int sandbox_dma_poll(struct udevice *dev, struct dma_async_desc *desc)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	if (ud->async != desc)
+		return -EINVAL;
+
+	sandbox_dma_update(ud);
+	if (ud->async_done < ud->async_total)
+		return -EINPROGRESS;
+	ud->async = NULL;
+
+	return 0;
+}
+
+static int sandbox_dma_wait(struct udevice *dev, struct dma_async_desc *desc)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+	ulong done;
+
+	if (ud->async != desc)
+		return -EINVAL;
+
+	/* Rather than sleeping, finish at once and record the stall */
+	sandbox_dma_update(ud);
+	done = ud->async_done;
+	sandbox_dma_advance(ud, ud->async_total);
+	ud->stall += ud->async_done - done;
+	ud->async = NULL;
+
+	return 0;
+}
+
+void sandbox_dma_get_async_stats(struct udevice *dev, ulong *overlapp,
+				 ulong *stallp)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	*overlapp = ud->overlap;
+	*stallp = ud->stall;
+	ud->overlap = 0;
+	ud->stall = 0;
+}
+#endif /* DMA_ASYNC */
+
 static int sandbox_dma_of_xlate(struct dma *dma,
 				struct ofnode_phandle_args *args)
 {
@@ -235,6 +348,11 @@ static const struct dma_ops sandbox_dma_ops = {
 	.send		= sandbox_dma_send,
 	.receive	= sandbox_dma_receive,
 	.prepare_rcv_buf = sandbox_dma_prepare_rcv_buf,
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+	.submit		= sandbox_dma_submit,
+	.poll		= sandbox_dma_poll,
+	.wait		= sandbox_dma_wait,
+#endif
 };
 
 static int sandbox_dma_probe(struct udevice *dev)
@@ -462,8 +462,11 @@ void fastboot_mmc_erase(const char *cmd, char *response)
 		return;
 	}
 
-	/* Align blocks to erase group size to avoid erasing other partitions */
-	grp_size = mmc->erase_grp_size;
+	/*
+	 * Align blocks to erase group size to avoid erasing other partitions,
+	 * unless TRIM is used, since that acts on single blocks
+	 */
+	grp_size = mmc->can_trim ? 1 : mmc->erase_grp_size;
 	blks_start = (info.start + grp_size - 1) & ~(grp_size - 1);
 	if (info.size >= grp_size)
 		blks_size = (info.size - (blks_start - info.start)) &
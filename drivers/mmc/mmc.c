@@ -19,6 +19,7 @@
 #include <memalign.h>
 #include <linux/list.h>
 #include <div64.h>
+#include <warm_state.h>
 #include "mmc_private.h"
 
 static int mmc_set_signal_voltage(struct mmc *mmc, uint signal_voltage);
@@ -1670,6 +1671,7 @@ static int sd_select_mode_and_width(struct mmc *mmc, uint card_caps)
 #endif
 	if (!uhs_en)
 		caps &= ~UHS_CAPS;
+	caps &= ~mmc->failed_caps;
 
 	for_each_sd_mode_by_pref(caps, mwt) {
 		uint *w;
@@ -1724,6 +1726,7 @@ error:
 						MMC_CLK_ENABLE);
 			}
 		}
+		mmc->failed_caps |= MMC_CAP(mwt->mode);
 	}
 
 	pr_err("unable to select a mode\n");
@@ -1929,7 +1932,7 @@ static int mmc_select_mode_and_width(struct mmc *mmc, uint card_caps)
 #endif
 
 	/* Restrict card's capabilities by what the host can do */
-	card_caps &= mmc->host_caps;
+	card_caps &= mmc->host_caps & ~mmc->failed_caps;
 
 	/* Only version 4 of MMC supports wider bus widths */
 	if (mmc->version < MMC_VERSION_4)
@@ -2020,6 +2023,7 @@ error:
 			mmc_select_mode(mmc, MMC_LEGACY);
 			mmc_set_bus_width(mmc, 1);
 		}
+		mmc->failed_caps |= MMC_CAP(mwt->mode);
 	}
 
 	pr_err("unable to select a mode\n");
@@ -2219,6 +2223,23 @@ static int mmc_startup_v4(struct mmc *mmc)
 
 	mmc->wr_rel_set = ext_csd[EXT_CSD_WR_REL_SET];
 
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	mmc->can_trim = IS_ENABLED(CONFIG_MMC_TRIM) &&
+		mmc->version >= MMC_VERSION_4_41 &&
+		(ext_csd[EXT_CSD_SEC_FEATURE_SUPPORT] & EXT_CSD_SEC_GB_CL_EN);
+
+	mmc->cache_on = false;
+	if (IS_ENABLED(CONFIG_MMC_WRITE_CACHE) &&
+	    mmc->version >= MMC_VERSION_4_5 &&
+	    (ext_csd[EXT_CSD_CACHE_SIZE] | ext_csd[EXT_CSD_CACHE_SIZE + 1] |
+	     ext_csd[EXT_CSD_CACHE_SIZE + 2] |
+	     ext_csd[EXT_CSD_CACHE_SIZE + 3])) {
+		/* The device still works without its cache, so carry on */
+		mmc->cache_on = !mmc_switch(mmc, EXT_CSD_CMD_SET_NORMAL,
+					    EXT_CSD_CACHE_CTRL, 1);
+	}
+#endif
+
 	return 0;
 error:
 	if (mmc->ext_csd) {
@@ -2230,6 +2251,43 @@ error:
 	return err;
 }
 
+#if CONFIG_IS_ENABLED(WARM_STATE)
+/* Skip modes which failed in the previous phase, if the card is the same */
+static void mmc_warm_state_load(struct mmc *mmc)
+{
+	const struct mmc_warm_state *ws;
+
+	mmc->failed_caps = 0;
+	ws = warm_state_find(UCLASS_MMC, mmc_get_blk_desc(mmc)->devnum,
+			     sizeof(*ws));
+	if (ws && !memcmp(ws->cid, mmc->cid, sizeof(ws->cid))) {
+		mmc->failed_caps = ws->failed_caps;
+		pr_debug("skipping modes %x which failed before\n",
+			 mmc->failed_caps);
+	}
+}
+
+static void mmc_warm_state_save(struct mmc *mmc)
+{
+	struct mmc_warm_state ws;
+	int ret;
+
+	memcpy(ws.cid, mmc->cid, sizeof(ws.cid));
+	ws.failed_caps = mmc->failed_caps;
+	ret = warm_state_save(UCLASS_MMC, mmc_get_blk_desc(mmc)->devnum, &ws,
+			      sizeof(ws));
+	if (ret)
+		pr_debug("cannot save warm state (err=%d)\n", ret);
+}
+#else
+static inline void mmc_warm_state_load(struct mmc *mmc)
+{
+	mmc->failed_caps = 0;
+}
+
+static inline void mmc_warm_state_save(struct mmc *mmc) {}
+#endif
+
 static int mmc_startup(struct mmc *mmc)
 {
 	int err, i;
@@ -2413,6 +2471,7 @@ static int mmc_startup(struct mmc *mmc)
 	if (err)
 		return err;
 
+	mmc_warm_state_load(mmc);
 #if CONFIG_IS_ENABLED(MMC_TINY)
 	mmc_set_clock(mmc, mmc->legacy_speed, false);
 	mmc_select_mode(mmc, IS_SD(mmc) ? SD_LEGACY : MMC_LEGACY);
@@ -2434,6 +2493,7 @@ static int mmc_startup(struct mmc *mmc)
 		return err;
 
 	mmc->best_mode = mmc->selected_mode;
+	mmc_warm_state_save(mmc);
 
 	/* Fix the block length for DDR mode */
 	if (mmc->ddr_mode) {
@@ -11,22 +11,42 @@
 #include <mmc.h>
 #include <asm/test.h>
 
+/**
+ * struct sandbox_mmc_plat - Information about the emulated card
+ *
+ * @cfg:		MMC configuration
+ * @mmc:		MMC device
+ * @block_count:	Blocks announced by SET_BLOCK_COUNT for the next
+ *			transfer, or 0 if none
+ * @open_ended:		true if a multiple-block transfer must be ended
+ *			with STOP_TRANSMISSION
+ */
 struct sandbox_mmc_plat {
 	struct mmc_config cfg;
 	struct mmc mmc;
+	uint block_count;
+	bool open_ended;
 };
 
 /**
  * sandbox_mmc_send_cmd() - Emulate SD commands
  *
  * This emulate an SD card version 2. Single-block reads result in zero data.
- * Multiple-block reads return a test string.
+ * Multiple-block reads return a test string. Writes are discarded, but must
+ * follow the rules for pre-defined and open-ended transfers.
  */
 static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 				struct mmc_data *data)
 {
+	struct sandbox_mmc_plat *plat = dev_get_platdata(dev);
+
 	switch (cmd->cmdidx) {
 	case MMC_CMD_ALL_SEND_CID:
+		/* Manufacturer 3, OEM "SD", product "SB001", rev 1.0 */
+		cmd->response[0] = 0x03534453;
+		cmd->response[1] = 0x42303031;
+		cmd->response[2] = 0x10000000;
+		cmd->response[3] = 0x12345600;
 		break;
 	case SD_CMD_SEND_RELATIVE_ADDR:
 		cmd->response[0] = 0 << 16; /* mmc->rca */
@@ -48,9 +68,11 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		if (!data)
 			break;
 		u32 *resp = (u32 *)data->dest;
+		resp[3] = cpu_to_be32(SD_HIGHSPEED_SUPPORTED);
 		resp[7] = cpu_to_be32(SD_HIGHSPEED_BUSY);
-		if ((cmd->cmdarg & 0xF) == UHS_SDR12_BUS_SPEED)
-			resp[4] = (cmd->cmdarg & 0xF) << 24;
+		if ((cmd->cmdarg & 0xF) == UHS_SDR12_BUS_SPEED ||
+		    (cmd->cmdarg & 0xF) == HIGH_SPEED_BUS_SPEED)
+			resp[4] = cpu_to_be32((cmd->cmdarg & 0xF) << 24);
 		break;
 	}
 	case MMC_CMD_READ_SINGLE_BLOCK:
@@ -58,8 +80,27 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 		break;
 	case MMC_CMD_READ_MULTIPLE_BLOCK:
 		strcpy(data->dest, "this is a test");
+		plat->open_ended = true;
+		break;
+	case MMC_CMD_SET_BLOCK_COUNT:
+		plat->block_count = cmd->cmdarg & 0xffff;
 		break;
+	case MMC_CMD_WRITE_SINGLE_BLOCK:
+	case MMC_CMD_WRITE_MULTIPLE_BLOCK: {
+		uint count = plat->block_count;
+
+		plat->block_count = 0;
+		if (count && count != data->blocks)
+			return -EIO;
+		plat->open_ended = !count &&
+			cmd->cmdidx == MMC_CMD_WRITE_MULTIPLE_BLOCK;
+		break;
+	}
 	case MMC_CMD_STOP_TRANSMISSION:
+		/* A pre-defined transfer stops by itself */
+		if (!plat->open_ended)
+			return -EIO;
+		plat->open_ended = false;
 		break;
 	case SD_CMD_APP_SEND_OP_COND:
 		cmd->response[0] = OCR_BUSY | OCR_HCS;
@@ -74,7 +115,8 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	case SD_CMD_APP_SEND_SCR: {
 		u32 *scr = (u32 *)data->dest;
 
-		scr[0] = cpu_to_be32(2 << 24 | 1 << 15);  /* SD version 3 */
+		/* SD version 3, with SET_BLOCK_COUNT */
+		scr[0] = cpu_to_be32(2 << 24 | 1 << 15 | SD_SCR_CMD23_SUPPORT);
 		break;
 	}
 	default:
@@ -73,12 +73,6 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 {
 	unsigned int stat, rdy, mask, timeout, block = 0;
 	bool transfer_done = false;
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	unsigned char ctrl;
-	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
-	ctrl &= ~SDHCI_CTRL_DMA_MASK;
-	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
-#endif
 
 	timeout = 1000000;
 	rdy = SDHCI_INT_SPACE_AVAIL | SDHCI_INT_DATA_AVAIL;
@@ -123,6 +117,64 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 	return 0;
 }
 
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+static void sdhci_select_dma(struct sdhci_host *host, u8 dma)
+{
+	u8 ctrl;
+
+	ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	ctrl |= dma;
+	sdhci_writeb(host, ctrl, SDHCI_HOST_CONTROL);
+}
+#endif
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+/*
+ * Describe the whole transfer with a chain of ADMA2 descriptors, so that the
+ * controller runs it without stopping for the CPU. Returns false if ADMA2
+ * cannot be used for this buffer.
+ */
+static bool sdhci_adma_prepare(struct sdhci_host *host, dma_addr_t addr,
+			       uint trans_bytes)
+{
+	struct sdhci_adma_desc *desc = host->adma_desc_table;
+	ulong table = (ulong)desc;
+	uint len;
+
+	if (!desc || (addr | trans_bytes) & (ADMA_ALIGN - 1) ||
+	    trans_bytes > ADMA_TABLE_NO_ENTRIES * ADMA_MAX_LEN)
+		return false;
+
+	do {
+		len = min(trans_bytes, (uint)ADMA_MAX_LEN);
+		trans_bytes -= len;
+		desc->attr = ADMA_DESC_TRANSFER_DATA;
+		if (!trans_bytes)
+			desc->attr |= ADMA_DESC_ATTR_END;
+		desc->reserved = 0;
+		desc->len = cpu_to_le16(len);
+		desc->addr_lo = cpu_to_le32(lower_32_bits(addr));
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+		desc->addr_hi = cpu_to_le32(upper_32_bits(addr));
+#endif
+		addr += len;
+		desc++;
+	} while (trans_bytes);
+	flush_cache(table, ALIGN((ulong)desc - table, ARCH_DMA_MINALIGN));
+
+	sdhci_writel(host, lower_32_bits(table), SDHCI_ADMA_ADDRESS);
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+	sdhci_writel(host, upper_32_bits(table), SDHCI_ADMA_ADDRESS_HI);
+	sdhci_select_dma(host, SDHCI_CTRL_ADMA64);
+#else
+	sdhci_select_dma(host, SDHCI_CTRL_ADMA32);
+#endif
+
+	return true;
+}
+#endif
+
 /*
  * No command will be sent by driver if card is busy, so driver must wait
  * for card ready state.
@@ -149,8 +201,10 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	unsigned int stat = 0;
 	int ret = 0;
 	int trans_bytes = 0, is_aligned = 1;
+	bool dma = false;
 	u32 mask, flags, mode;
-	unsigned int time = 0, start_addr = 0;
+	unsigned int time = 0;
+	dma_addr_t start_addr = 0;
 	int mmc_dev = mmc_get_blk_desc(mmc)->devnum;
 	ulong start = get_timer(0);
 
@@ -219,33 +273,44 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->flags == MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
-#ifdef CONFIG_MMC_SDHCI_SDMA
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
 		if (data->flags == MMC_DATA_READ)
 			start_addr = (unsigned long)data->dest;
 		else
 			start_addr = (unsigned long)data->src;
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				(start_addr & 0x7) != 0x0) {
+#endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+		dma = sdhci_adma_prepare(host, start_addr, trans_bytes);
+#endif
+#ifdef CONFIG_MMC_SDHCI_SDMA
+		if (!dma) {
+			if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+			    (start_addr & 0x7) != 0x0) {
+				is_aligned = 0;
+				start_addr = (unsigned long)aligned_buffer;
+				if (data->flags != MMC_DATA_READ)
+					memcpy(aligned_buffer, data->src,
+					       trans_bytes);
+			}
+
+#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
+			/*
+			 * Always use this bounce-buffer when
+			 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
+			 */
 			is_aligned = 0;
 			start_addr = (unsigned long)aligned_buffer;
 			if (data->flags != MMC_DATA_READ)
 				memcpy(aligned_buffer, data->src, trans_bytes);
-		}
-
-#if defined(CONFIG_FIXED_SDHCI_ALIGNED_BUFFER)
-		/*
-		 * Always use this bounce-buffer when
-		 * CONFIG_FIXED_SDHCI_ALIGNED_BUFFER is defined
-		 */
-		is_aligned = 0;
-		start_addr = (unsigned long)aligned_buffer;
-		if (data->flags != MMC_DATA_READ)
-			memcpy(aligned_buffer, data->src, trans_bytes);
 #endif
 
-		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
-		mode |= SDHCI_TRNS_DMA;
+			sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
+			sdhci_select_dma(host, SDHCI_CTRL_SDMA);
+			dma = true;
+		}
 #endif
+		if (dma)
+			mode |= SDHCI_TRNS_DMA;
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
 				SDHCI_BLOCK_SIZE);
@@ -256,8 +321,8 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	}
 
 	sdhci_writel(host, cmd->cmdarg, SDHCI_ARGUMENT);
-#ifdef CONFIG_MMC_SDHCI_SDMA
-	if (data) {
+#if defined(CONFIG_MMC_SDHCI_SDMA) || defined(CONFIG_MMC_SDHCI_ADMA)
+	if (dma) {
 		trans_bytes = ALIGN(trans_bytes, CONFIG_SYS_CACHELINE_SIZE);
 		flush_cache(start_addr, trans_bytes);
 	}
@@ -642,6 +707,18 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 		       __func__);
 		return -EINVAL;
 	}
+#endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* Without ADMA2, fall back to SDMA or PIO */
+	if ((host->quirks & SDHCI_QUIRK_USE_ADMA) &&
+	    (caps & SDHCI_CAN_DO_ADMA2) && !host->adma_desc_table &&
+	    (!IS_ENABLED(CONFIG_DMA_ADDR_T_64BIT) ||
+	     (caps & SDHCI_CAN_64BIT))) {
+		host->adma_desc_table = memalign(ARCH_DMA_MINALIGN,
+						 ADMA_TABLE_SZ);
+		if (!host->adma_desc_table)
+			return -ENOMEM;
+	}
 #endif
 	if (host->quirks & SDHCI_QUIRK_REG32_RW)
 		host->version =
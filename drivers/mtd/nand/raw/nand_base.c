@@ -1677,6 +1677,24 @@ static int nand_setup_read_retry(struct mtd_info *mtd, int retry_mode)
 	return chip->setup_read_retry(mtd, retry_mode);
 }
 
+/**
+ * nand_can_cache_read - [INTERN] Check whether cache reads can be used
+ * @chip: nand chip info structure
+ *
+ * Sequential cache reads are only issued through the generic large-page
+ * command function, and only when the page read functions do not send a
+ * new READ0 for the same page (OOB-first ECC) or retry failed pages.
+ */
+static bool nand_can_cache_read(struct nand_chip *chip)
+{
+	return CONFIG_IS_ENABLED(NAND_CACHE_READ) &&
+	       NAND_HAS_CACHEREAD(chip) &&
+	       chip->cmdfunc == nand_command_lp &&
+	       nand_standard_page_accessors(&chip->ecc) &&
+	       chip->ecc.mode != NAND_ECC_HW_OOB_FIRST &&
+	       chip->read_retries <= 1;
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -1700,6 +1718,9 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	unsigned int max_bitflips = 0;
 	int retry_mode = 0;
 	bool ecc_fail = false;
+	bool cache_read = nand_can_cache_read(chip);
+	bool cache_seq = false, cache_next;
+	int block_mask = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
 
 	chipnr = (int)(from >> chip->chip_shift);
 	chip->select_chip(mtd, chipnr);
@@ -1728,8 +1749,17 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		else
 			use_bufpoi = 0;
 
+		/*
+		 * With a cache read, the next page in the block is read from
+		 * the array while this one is transferred from the cache
+		 * register, so the whole run is one READ0 followed by
+		 * READCACHESEQ for each page and READCACHEEND for the last.
+		 */
+		cache_next = cache_read && readlen > bytes &&
+			     ((realpage + 1) & block_mask);
+
 		/* Is the current page in the buffer? */
-		if (realpage != chip->pagebuf || oob) {
+		if (realpage != chip->pagebuf || oob || cache_seq) {
 			bufpoi = use_bufpoi ? chip->buffers->databuf : buf;
 
 			if (use_bufpoi && aligned)
@@ -1737,8 +1767,18 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 						 __func__, buf);
 
 read_retry:
-			if (nand_standard_page_accessors(&chip->ecc))
-				chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+			if (nand_standard_page_accessors(&chip->ecc)) {
+				if (!cache_seq)
+					chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00,
+						      page);
+				if (cache_seq || cache_next) {
+					chip->cmdfunc(mtd, cache_next ?
+						      NAND_CMD_READCACHESEQ :
+						      NAND_CMD_READCACHEEND,
+						      -1, -1);
+					cache_seq = cache_next;
+				}
+			}
 
 			/*
 			 * Now read the page into the buffer.  Absent an error,
@@ -1848,6 +1888,9 @@ read_retry:
 			chip->select_chip(mtd, chipnr);
 		}
 	}
+	/* Let the array finish the page it has started on */
+	if (cache_seq)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -3279,6 +3322,9 @@ static int nand_flash_detect_onfi(struct mtd_info *mtd, struct nand_chip *chip,
 	else
 		*busw = 0;
 
+	if (le16_to_cpu(p->opt_cmd) & ONFI_OPT_CMD_READ_CACHE)
+		chip->options |= NAND_CACHERD;
+
 	if (p->ecc_bits != 0xff) {
 		chip->ecc_strength_ds = p->ecc_bits;
 		chip->ecc_step_ds = 512;
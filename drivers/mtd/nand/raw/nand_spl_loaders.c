@@ -2,6 +2,7 @@ int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 {
 	unsigned int block, lastblock;
 	unsigned int page, page_offset;
+	unsigned int __maybe_unused first;
 
 	/* offs has to be aligned to a page address! */
 	block = offs / CONFIG_SYS_NAND_BLOCK_SIZE;
@@ -12,8 +13,14 @@ int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 	while (block <= lastblock) {
 		if (!nand_is_bad_block(block)) {
 			/* Skip bad blocks */
+			first = page;
 			while (page < CONFIG_SYS_NAND_PAGE_COUNT) {
+#if CONFIG_IS_ENABLED(NAND_CACHE_READ)
+				nand_read_page_cache(block, page, dst, first,
+						CONFIG_SYS_NAND_PAGE_COUNT - 1);
+#else
 				nand_read_page(block, page, dst);
+#endif
 				/*
 				 * When offs is not aligned to page address the
 				 * extra offset is copied to dst as well. Copy
@@ -136,6 +136,10 @@ static int nand_is_bad_block(int block)
 }
 
 #if defined(CONFIG_SYS_NAND_HW_ECC_OOBFIRST)
+#if CONFIG_IS_ENABLED(NAND_CACHE_READ)
+#error "NAND cache reads are not supported with CONFIG_SYS_NAND_HW_ECC_OOBFIRST"
+#endif
+
 static int nand_read_page(int block, int page, uchar *dst)
 {
 	struct nand_chip *this = mtd_to_nand(mtd);
@@ -167,7 +171,8 @@ static int nand_read_page(int block, int page, uchar *dst)
 	return 0;
 }
 #else
-static int nand_read_page(int block, int page, void *dst)
+/* Read and correct the page which the chip has ready to transfer */
+static int nand_read_page_data(void *dst)
 {
 	struct nand_chip *this = mtd_to_nand(mtd);
 	u_char ecc_calc[ECCTOTAL];
@@ -179,8 +184,6 @@ static int nand_read_page(int block, int page, void *dst)
 	int eccsteps = ECCSTEPS;
 	uint8_t *p = dst;
 
-	nand_command(block, page, 0, NAND_CMD_READ0);
-
 	for (i = 0; eccsteps; eccsteps--, i += eccbytes, p += eccsize) {
 		if (this->ecc.mode != NAND_ECC_SOFT)
 			this->ecc.hwctl(mtd, NAND_ECC_READ);
@@ -206,6 +209,48 @@ static int nand_read_page(int block, int page, void *dst)
 
 	return 0;
 }
+
+static int nand_read_page(int block, int page, void *dst)
+{
+	nand_command(block, page, 0, NAND_CMD_READ0);
+
+	return nand_read_page_data(dst);
+}
+
+#if CONFIG_IS_ENABLED(NAND_CACHE_READ)
+#if CONFIG_SYS_NAND_PAGE_SIZE <= 512
+#error "NAND cache reads need a large-page NAND device"
+#endif
+
+/*
+ * Read a page as part of a cache read of the pages from @first up to
+ * @last. The chip reads the next page from the array while this one is
+ * being transferred and corrected.
+ */
+static int nand_read_page_cache(int block, int page, void *dst, int first,
+				int last)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	u32 timeo = (CONFIG_SYS_HZ * 400) / 1000;
+	ulong time_start;
+
+	if (first == last)
+		return nand_read_page(block, page, dst);
+
+	if (page == first)
+		nand_command(block, page, 0, NAND_CMD_READ0);
+	this->cmd_ctrl(mtd, page == last ? NAND_CMD_READCACHEEND :
+		       NAND_CMD_READCACHESEQ, NAND_CTRL_CLE | NAND_CTRL_CHANGE);
+	this->cmd_ctrl(mtd, NAND_CMD_NONE, NAND_NCE | NAND_CTRL_CHANGE);
+	time_start = get_timer(0);
+	while (!this->dev_ready(mtd)) {
+		if (get_timer(time_start) >= timeo)
+			return -ETIMEDOUT;
+	}
+
+	return nand_read_page_data(dst);
+}
+#endif
 #endif
 
 /* nand_init() - initialize data to make nand usable by SPL */
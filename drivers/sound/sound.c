@@ -13,23 +13,23 @@ void sound_create_square_wave(uint sample_rate, unsigned short *data, int size,
 	const unsigned short amplitude = 16000; /* between 1 and 32767 */
 	const int period = freq ? sample_rate / freq : 0;
 	const int half = period / 2;
+	const int frame_size = channels * sizeof(*data);
 
 	assert(freq);
 
 	/* Make sure we don't overflow our buffer */
-	if (size % 2)
-		size--;
+	size -= size % frame_size;
 
 	while (size) {
 		int i, j;
 
 		for (i = 0; size && i < half; i++) {
-			size -= 2;
+			size -= frame_size;
 			for (j = 0; j < channels; j++)
 				*data++ = amplitude;
 		}
 		for (i = 0; size && i < period - half; i++) {
-			size -= 2;
+			size -= frame_size;
 			for (j = 0; j < channels; j++)
 				*data++ = -amplitude;
 		}
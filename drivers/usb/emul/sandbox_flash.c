@@ -9,16 +9,23 @@
 #include <os.h>
 #include <scsi.h>
 #include <usb.h>
+#include <linux/usb/uas.h>
 
 /*
  * This driver emulates a flash stick using the UFI command specification and
  * the BBB (bulk/bulk/bulk) protocol. It supports only a single logical unit
  * number (LUN 0).
+ *
+ * With the "sandbox,uas" property it also offers a UAS (USB Attached SCSI)
+ * alternate setting. Since sandbox devices are not SuperSpeed this works
+ * without streams, one command at a time.
  */
 
 enum {
 	SANDBOX_FLASH_EP_OUT		= 1,	/* endpoints */
 	SANDBOX_FLASH_EP_IN		= 2,
+	SANDBOX_FLASH_EP_DATA_IN	= 3,	/* UAS data endpoints */
+	SANDBOX_FLASH_EP_DATA_OUT	= 4,
 	SANDBOX_FLASH_BLOCK_LEN		= 512,
 };
 
@@ -49,6 +56,9 @@ enum {
  * @status_buff:	Data buffer for outgoing status
  * @buff_used:	Number of bytes ready to transfer back to host
  * @buff:	Data buffer for outgoing data
+ * @alt:	Alternate setting selected by the host, 1 for UAS
+ * @ready_sent:	true if a READ READY IU has been sent for the UAS command
+ * @tmf:	true if a UAS task management response is to be sent
  */
 struct sandbox_flash_priv {
 	bool error;
@@ -62,6 +72,9 @@ struct sandbox_flash_priv {
 	struct umass_bbb_csw status;
 	int buff_used;
 	u8 buff[512];
+	int alt;
+	bool ready_sent;
+	bool tmf;
 };
 
 struct sandbox_flash_plat {
@@ -167,6 +180,108 @@ static void *flash_desc_list[] = {
 	NULL,
 };
 
+static struct usb_config_descriptor flash_uas_config0 = {
+	.bLength		= sizeof(flash_uas_config0),
+	.bDescriptorType	= USB_DT_CONFIG,
+
+	/* wTotalLength is set up by usb-emul-uclass */
+	.bNumInterfaces		= 1,
+	.bConfigurationValue	= 0,
+	.iConfiguration		= 0,
+	.bmAttributes		= 1 << 7,
+	.bMaxPower		= 50,
+};
+
+static struct usb_interface_descriptor flash_uas_interface0 = {
+	.bLength		= sizeof(flash_uas_interface0),
+	.bDescriptorType	= USB_DT_INTERFACE,
+
+	.bInterfaceNumber	= 0,
+	.bAlternateSetting	= 0,
+	.bNumEndpoints		= 2,
+	.bInterfaceClass	= USB_CLASS_MASS_STORAGE,
+	.bInterfaceSubClass	= US_SC_SCSI,
+	.bInterfaceProtocol	= US_PR_BULK,
+	.iInterface		= 0,
+};
+
+static struct usb_interface_descriptor flash_uas_interface1 = {
+	.bLength		= sizeof(flash_uas_interface1),
+	.bDescriptorType	= USB_DT_INTERFACE,
+
+	.bInterfaceNumber	= 0,
+	.bAlternateSetting	= 1,
+	.bNumEndpoints		= 4,
+	.bInterfaceClass	= USB_CLASS_MASS_STORAGE,
+	.bInterfaceSubClass	= US_SC_SCSI,
+	.bInterfaceProtocol	= US_PR_UAS,
+	.iInterface		= 0,
+};
+
+static struct usb_pipe_usage_descriptor flash_uas_cmd_usage = {
+	.bLength		= sizeof(flash_uas_cmd_usage),
+	.bDescriptorType	= USB_DT_PIPE_USAGE,
+	.bPipeID		= CMD_PIPE_ID,
+};
+
+static struct usb_pipe_usage_descriptor flash_uas_status_usage = {
+	.bLength		= sizeof(flash_uas_status_usage),
+	.bDescriptorType	= USB_DT_PIPE_USAGE,
+	.bPipeID		= STATUS_PIPE_ID,
+};
+
+static struct usb_endpoint_descriptor flash_uas_data_in = {
+	.bLength		= USB_DT_ENDPOINT_SIZE,
+	.bDescriptorType	= USB_DT_ENDPOINT,
+
+	.bEndpointAddress	= SANDBOX_FLASH_EP_DATA_IN |
+				  USB_ENDPOINT_DIR_MASK,
+	.bmAttributes		= USB_ENDPOINT_XFER_BULK,
+	.wMaxPacketSize		= __constant_cpu_to_le16(1024),
+	.bInterval		= 0,
+};
+
+static struct usb_pipe_usage_descriptor flash_uas_data_in_usage = {
+	.bLength		= sizeof(flash_uas_data_in_usage),
+	.bDescriptorType	= USB_DT_PIPE_USAGE,
+	.bPipeID		= DATA_IN_PIPE_ID,
+};
+
+static struct usb_endpoint_descriptor flash_uas_data_out = {
+	.bLength		= USB_DT_ENDPOINT_SIZE,
+	.bDescriptorType	= USB_DT_ENDPOINT,
+
+	.bEndpointAddress	= SANDBOX_FLASH_EP_DATA_OUT,
+	.bmAttributes		= USB_ENDPOINT_XFER_BULK,
+	.wMaxPacketSize		= __constant_cpu_to_le16(1024),
+	.bInterval		= 0,
+};
+
+static struct usb_pipe_usage_descriptor flash_uas_data_out_usage = {
+	.bLength		= sizeof(flash_uas_data_out_usage),
+	.bDescriptorType	= USB_DT_PIPE_USAGE,
+	.bPipeID		= DATA_OUT_PIPE_ID,
+};
+
+/* Bulk-only transport in alternate setting 0, UAS in alternate setting 1 */
+static void *flash_uas_desc_list[] = {
+	&flash_device_desc,
+	&flash_uas_config0,
+	&flash_uas_interface0,
+	&flash_endpoint0_out,
+	&flash_endpoint1_in,
+	&flash_uas_interface1,
+	&flash_endpoint0_out,
+	&flash_uas_cmd_usage,
+	&flash_endpoint1_in,
+	&flash_uas_status_usage,
+	&flash_uas_data_in,
+	&flash_uas_data_in_usage,
+	&flash_uas_data_out,
+	&flash_uas_data_out_usage,
+	NULL,
+};
+
 static int sandbox_flash_control(struct udevice *dev, struct usb_device *udev,
 				 unsigned long pipe, void *buff, int len,
 				 struct devrequest *setup)
@@ -185,6 +300,18 @@ static int sandbox_flash_control(struct udevice *dev, struct usb_device *udev,
 			debug("request=%x\n", setup->request);
 			break;
 		}
+	} else if (pipe == usb_sndctrlpipe(udev, 0)) {
+		switch (setup->request) {
+		case USB_REQ_SET_INTERFACE:
+			priv->alt = le16_to_cpu(setup->value);
+			priv->phase = PHASE_START;
+			return 0;
+		case USB_REQ_CLEAR_FEATURE:
+			return 0;
+		default:
+			debug("request=%x\n", setup->request);
+			break;
+		}
 	}
 	debug("pipe=%lx\n", pipe);
 
@@ -293,6 +420,113 @@ static int handle_ufi_command(struct sandbox_flash_plat *plat,
 	return 0;
 }
 
+static int handle_data_in(struct sandbox_flash_priv *priv, void *buff, int len)
+{
+	debug("data in, len=%x, alloc_len=%x, priv->read_len=%x\n",
+	      len, priv->alloc_len, priv->read_len);
+	if (priv->read_len) {
+		ulong bytes_read;
+
+		bytes_read = os_read(priv->fd, buff, len);
+		if (bytes_read != len)
+			return -EIO;
+		priv->read_len -= len / SANDBOX_FLASH_BLOCK_LEN;
+		if (!priv->read_len)
+			priv->phase = PHASE_STATUS;
+	} else {
+		if (priv->alloc_len && len > priv->alloc_len)
+			len = priv->alloc_len;
+		memcpy(buff, priv->buff, len);
+		priv->phase = PHASE_STATUS;
+	}
+
+	return len;
+}
+
+/*
+ * Handle a bulk transfer in the UAS alternate setting. The command and
+ * status pipes use the same endpoints as bulk-only transport. Without
+ * streams the device sends READ READY on the status pipe before the data
+ * and a SENSE IU after it.
+ */
+static int sandbox_flash_uas_bulk(struct sandbox_flash_plat *plat,
+				  struct sandbox_flash_priv *priv, int ep,
+				  void *buff, int len)
+{
+	switch (ep) {
+	case SANDBOX_FLASH_EP_OUT: {
+		struct command_iu *cmd = buff;
+
+		if (len == sizeof(struct task_mgmt_iu) &&
+		    cmd->iu_id == IU_ID_TASK_MGMT) {
+			priv->tag = be16_to_cpu(cmd->tag);
+			priv->tmf = true;
+			priv->phase = PHASE_START;
+			return len;
+		}
+		if (priv->phase != PHASE_START || len != sizeof(*cmd) ||
+		    cmd->iu_id != IU_ID_COMMAND)
+			break;
+		priv->tag = be16_to_cpu(cmd->tag);
+		priv->alloc_len = 0;
+		priv->read_len = 0;
+		priv->ready_sent = false;
+		if (handle_ufi_command(plat, priv, cmd->cdb, sizeof(cmd->cdb)))
+			setup_fail_response(priv);
+		priv->phase = priv->buff_used ? PHASE_DATA : PHASE_STATUS;
+		return len;
+	}
+	case SANDBOX_FLASH_EP_IN:
+		if (priv->tmf) {
+			struct response_iu *resp = buff;
+
+			if (len < sizeof(*resp))
+				break;
+			memset(resp, '\0', sizeof(*resp));
+			resp->iu_id = IU_ID_RESPONSE;
+			resp->tag = cpu_to_be16(priv->tag);
+			resp->response_code = RC_TMF_COMPLETE;
+			priv->tmf = false;
+			return sizeof(*resp);
+		}
+		if (priv->phase == PHASE_DATA && !priv->ready_sent) {
+			struct iu *iu = buff;
+
+			if (len < sizeof(*iu))
+				break;
+			memset(iu, '\0', sizeof(*iu));
+			iu->iu_id = IU_ID_READ_READY;
+			iu->tag = cpu_to_be16(priv->tag);
+			priv->ready_sent = true;
+			return sizeof(*iu);
+		}
+		if (priv->phase == PHASE_STATUS) {
+			struct sense_iu *sense = buff;
+			int size = offsetof(struct sense_iu, sense);
+
+			if (len < size)
+				break;
+			memset(sense, '\0', size);
+			sense->iu_id = IU_ID_STATUS;
+			sense->tag = cpu_to_be16(priv->tag);
+			sense->status = priv->status.bCSWStatus ==
+					CSWSTATUS_GOOD ? S_GOOD : S_CHECK_COND;
+			priv->phase = PHASE_START;
+			return size;
+		}
+		break;
+	case SANDBOX_FLASH_EP_DATA_IN:
+		if (priv->phase == PHASE_DATA && priv->ready_sent)
+			return handle_data_in(priv, buff, len);
+		break;
+	default:
+		break;
+	}
+	debug("%s: Detected transfer error\n", __func__);
+
+	return -EIO;
+}
+
 static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 			      unsigned long pipe, void *buff, int len)
 {
@@ -303,6 +537,8 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 
 	debug("%s: dev=%s, pipe=%lx, ep=%x, len=%x, phase=%d\n", __func__,
 	      dev->name, pipe, ep, len, priv->phase);
+	if (priv->alt)
+		return sandbox_flash_uas_bulk(plat, priv, ep, buff, len);
 	switch (ep) {
 	case SANDBOX_FLASH_EP_OUT:
 		switch (priv->phase) {
@@ -330,24 +566,7 @@ static int sandbox_flash_bulk(struct udevice *dev, struct usb_device *udev,
 	case SANDBOX_FLASH_EP_IN:
 		switch (priv->phase) {
 		case PHASE_DATA:
-			debug("data in, len=%x, alloc_len=%x, priv->read_len=%x\n",
-			      len, priv->alloc_len, priv->read_len);
-			if (priv->read_len) {
-				ulong bytes_read;
-
-				bytes_read = os_read(priv->fd, buff, len);
-				if (bytes_read != len)
-					return -EIO;
-				priv->read_len -= len / SANDBOX_FLASH_BLOCK_LEN;
-				if (!priv->read_len)
-					priv->phase = PHASE_STATUS;
-			} else {
-				if (priv->alloc_len && len > priv->alloc_len)
-					len = priv->alloc_len;
-				memcpy(buff, priv->buff, len);
-				priv->phase = PHASE_STATUS;
-			}
-			return len;
+			return handle_data_in(priv, buff, len);
 		case PHASE_STATUS:
 			debug("status in, len=%x\n", len);
 			if (len > sizeof(priv->status))
@@ -387,7 +606,9 @@ static int sandbox_flash_bind(struct udevice *dev)
 	fs[2].id = STRINGID_SERIAL;
 	fs[2].s = dev->name;
 
-	return usb_emul_setup_device(dev, plat->flash_strings, flash_desc_list);
+	return usb_emul_setup_device(dev, plat->flash_strings,
+				     dev_read_bool(dev, "sandbox,uas") ?
+				     flash_uas_desc_list : flash_desc_list);
 }
 
 static int sandbox_flash_probe(struct udevice *dev)
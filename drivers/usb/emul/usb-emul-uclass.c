@@ -103,7 +103,17 @@ static int usb_emul_get_descriptor(struct usb_dev_platdata *plat, int value,
 	return upto ? upto : length ? -EIO : 0;
 }
 
-static int usb_emul_find_devnum(int devnum, int port1, struct udevice **emulp)
+/* Find the USB controller which a device or emulator is attached to */
+static struct udevice *usb_emul_get_bus(struct udevice *dev)
+{
+	while (dev && device_get_uclass_id(dev) != UCLASS_USB)
+		dev = dev->parent;
+
+	return dev;
+}
+
+static int usb_emul_find_devnum(struct udevice *bus, int devnum, int port1,
+				struct udevice **emulp)
 {
 	struct udevice *dev;
 	struct uclass *uc;
@@ -116,6 +126,10 @@ static int usb_emul_find_devnum(int devnum, int port1, struct udevice **emulp)
 	uclass_foreach_dev(dev, uc) {
 		struct usb_dev_platdata *udev = dev_get_parent_platdata(dev);
 
+		/* Addresses are only unique within each controller */
+		if (usb_emul_get_bus(dev) != bus)
+			continue;
+
 		/*
 		 * devnum is initialzied to zero at the beginning of the
 		 * enumeration process in usb_setup_device(). At this
@@ -163,14 +177,15 @@ int usb_emul_find(struct udevice *bus, ulong pipe, int port1,
 {
 	int devnum = usb_pipedevice(pipe);
 
-	return usb_emul_find_devnum(devnum, port1, emulp);
+	return usb_emul_find_devnum(bus, devnum, port1, emulp);
 }
 
 int usb_emul_find_for_dev(struct udevice *dev, struct udevice **emulp)
 {
 	struct usb_dev_platdata *udev = dev_get_parent_platdata(dev);
 
-	return usb_emul_find_devnum(udev->devnum, 0, emulp);
+	return usb_emul_find_devnum(usb_emul_get_bus(dev), udev->devnum, 0,
+				    emulp);
 }
 
 int usb_emul_control(struct udevice *emul, struct usb_device *udev,
@@ -148,9 +148,11 @@ static void xhci_free_virt_devices(struct xhci_ctrl *ctrl)
 
 		ctrl->dcbaa->dev_context_ptrs[slot_id] = 0;
 
-		for (i = 0; i < 31; ++i)
+		for (i = 0; i < 31; ++i) {
 			if (virt_dev->eps[i].ring)
 				xhci_ring_free(virt_dev->eps[i].ring);
+			xhci_free_stream_info(&virt_dev->eps[i]);
+		}
 
 		if (virt_dev->in_ctx)
 			xhci_free_container_ctx(virt_dev->in_ctx);
@@ -307,6 +309,7 @@ struct xhci_ring *xhci_ring_alloc(unsigned int num_segs, bool link_trbs)
 	ring = (struct xhci_ring *)malloc(sizeof(struct xhci_ring));
 	BUG_ON(!ring);
 
+	ring->num_segs = num_segs;
 	if (num_segs == 0)
 		return ring;
 
@@ -338,6 +341,64 @@ struct xhci_ring *xhci_ring_alloc(unsigned int num_segs, bool link_trbs)
 	return ring;
 }
 
+/**
+ * Allocates the stream context array of an endpoint, along with a ring for
+ * each stream. Stream 0 is reserved, so streams 1 to num_streams are set up.
+ *
+ * @param ep		endpoint to set up
+ * @param array_size	number of entries in the stream context array, which
+ *			must be a power of two greater than num_streams
+ * @param num_streams	number of streams
+ * @return none
+ */
+void xhci_alloc_stream_info(struct xhci_virt_ep *ep, unsigned int array_size,
+			    unsigned int num_streams)
+{
+	struct xhci_ring *ring;
+	u64 val_64;
+	int i;
+
+	ep->stream_ctx = xhci_malloc(array_size *
+				     sizeof(struct xhci_stream_ctx));
+	ep->stream_rings = calloc(num_streams + 1, sizeof(struct xhci_ring *));
+	BUG_ON(!ep->stream_rings);
+
+	for (i = 1; i <= num_streams; i++) {
+		ring = xhci_ring_alloc(BULK_RING_SEGS, true);
+		ep->stream_rings[i] = ring;
+
+		val_64 = (uintptr_t)ring->enqueue;
+		ep->stream_ctx[i].stream_ring = cpu_to_le64(val_64 |
+			SCT_FOR_CTX(SCT_PRI_TR) | ring->cycle_state);
+	}
+	ep->num_streams = num_streams;
+
+	xhci_flush_cache((uintptr_t)ep->stream_ctx,
+			 array_size * sizeof(struct xhci_stream_ctx));
+}
+
+/**
+ * Frees the stream context array and stream rings of an endpoint, if any
+ *
+ * @param ep	endpoint whose streams are to be freed
+ * @return none
+ */
+void xhci_free_stream_info(struct xhci_virt_ep *ep)
+{
+	int i;
+
+	if (!ep->stream_rings)
+		return;
+
+	for (i = 1; i <= ep->num_streams; i++)
+		xhci_ring_free(ep->stream_rings[i]);
+	free(ep->stream_rings);
+	free(ep->stream_ctx);
+	ep->stream_rings = NULL;
+	ep->stream_ctx = NULL;
+	ep->num_streams = 0;
+}
+
 /**
  * Set up the scratchpad buffer array and scratchpad buffers
  *
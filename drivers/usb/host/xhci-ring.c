@@ -351,12 +351,13 @@ static u32 xhci_v1_0_td_remainder(int running_total,
  *
  * @param udev		pointer to the USB device structure
  * @param ep_index	index of the endpoint
+ * @param stream	stream ID, or 0 if the endpoint has no streams
  * @param start_cycle	cycle flag of the first TRB
  * @param start_trb	pionter to the first TRB
  * @return none
  */
 static void giveback_first_trb(struct usb_device *udev, int ep_index,
-				int start_cycle,
+				unsigned int stream, int start_cycle,
 				struct xhci_generic_trb *start_trb)
 {
 	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
@@ -374,7 +375,7 @@ static void giveback_first_trb(struct usb_device *udev, int ep_index,
 
 	/* Ringing EP doorbell here */
 	xhci_writel(&ctrl->dba->doorbell[udev->slot_id],
-				DB_VALUE(ep_index, 0));
+				DB_VALUE(ep_index, stream));
 
 	return;
 }
@@ -513,48 +514,202 @@ static void abort_td(struct usb_device *udev, int ep_index)
 	xhci_acknowledge_event(ctrl);
 }
 
-static void record_transfer_result(struct usb_device *udev,
-				   union xhci_trb *event, int length)
+/*
+ * Returns the ring used for a stream of an endpoint, or NULL if there is no
+ * such stream. Stream 0 is the endpoint's own ring, which is only used if
+ * the endpoint has no streams.
+ */
+static struct xhci_ring *xhci_stream_ring(struct xhci_virt_ep *ep,
+					  unsigned int stream)
+{
+	if (!stream)
+		return ep->num_streams ? NULL : ep->ring;
+	if (stream > ep->num_streams)
+		return NULL;
+
+	return ep->stream_rings[stream];
+}
+
+/* Checks whether a TRB, given by its address, is on a ring */
+static bool xhci_trb_on_ring(struct xhci_ring *ring, u64 addr)
+{
+	struct xhci_segment *seg = ring->first_seg;
+
+	do {
+		if (addr >= (uintptr_t)seg->trbs &&
+		    addr < (uintptr_t)(seg->trbs + TRBS_PER_SEGMENT))
+			return true;
+		seg = seg->next;
+	} while (seg != ring->first_seg);
+
+	return false;
+}
+
+/*
+ * Queues a 'set TR dequeue pointer' command for one stream of an endpoint,
+ * moving the xHC's dequeue pointer to our enqueue pointer
+ */
+static void xhci_queue_stream_deq(struct xhci_ctrl *ctrl, u32 slot_id,
+				  u32 ep_index, unsigned int stream,
+				  struct xhci_ring *ring)
+{
+	u64 val_64 = (uintptr_t)ring->enqueue;
+	u32 fields[4];
+
+	BUG_ON(prepare_ring(ctrl, ctrl->cmd_ring, EP_STATE_RUNNING));
+
+	fields[0] = lower_32_bits(val_64) | SCT_FOR_CTX(SCT_PRI_TR) |
+		    ring->cycle_state;
+	fields[1] = upper_32_bits(val_64);
+	fields[2] = STREAM_ID_FOR_TRB(stream);
+	fields[3] = TRB_TYPE(TRB_SET_DEQ) | SLOT_ID_FOR_TRB(slot_id) |
+		    EP_ID_FOR_TRB(ep_index) | ctrl->cmd_ring->cycle_state;
+
+	queue_trb(ctrl, ctrl->cmd_ring, false, fields);
+
+	/* Ring the command ring doorbell */
+	xhci_writel(&ctrl->dba->doorbell[0], DB_VALUE_HOST);
+}
+
+/*
+ * Empties the rings of an endpoint after a failed batch of bulk transfers,
+ * so that TDs queued behind the failed one are never run. A halted endpoint
+ * is reset and a running one stopped, then the xHC's dequeue pointer for
+ * each ring is moved to our enqueue pointer, as in abort_td().
+ */
+static void xhci_flush_ep(struct usb_device *udev, int ep_index)
 {
-	udev->act_len = min(length, length -
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	struct xhci_virt_device *virt_dev = ctrl->devs[udev->slot_id];
+	struct xhci_virt_ep *ep = &virt_dev->eps[ep_index];
+	struct xhci_ep_ctx *ep_ctx;
+	struct xhci_ring *ring;
+	union xhci_trb *event;
+	unsigned int stream;
+	u32 state;
+
+	xhci_inval_cache((uintptr_t)virt_dev->out_ctx->bytes,
+			 virt_dev->out_ctx->size);
+	ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->out_ctx, ep_index);
+	state = le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK;
+
+	if (state == EP_STATE_HALTED || state == EP_STATE_RUNNING) {
+		xhci_queue_command(ctrl, NULL, udev->slot_id, ep_index,
+				   state == EP_STATE_HALTED ? TRB_RESET_EP :
+				   TRB_STOP_RING);
+		/* Any 'stopped' transfer event ahead of this is skipped */
+		event = xhci_wait_for_event(ctrl, TRB_COMPLETION);
+		if (GET_COMP_CODE(le32_to_cpu(event->event_cmd.status)) !=
+		    COMP_SUCCESS)
+			debug("XHCI failed to stop ep %d\n", ep_index);
+		xhci_acknowledge_event(ctrl);
+	}
+
+	/* With streams, each stream ring has its own dequeue pointer */
+	stream = ep->num_streams ? 1 : 0;
+	do {
+		ring = xhci_stream_ring(ep, stream);
+		if (stream)
+			xhci_queue_stream_deq(ctrl, udev->slot_id, ep_index,
+					      stream, ring);
+		else
+			xhci_queue_command(ctrl, (void *)((uintptr_t)
+				ring->enqueue | ring->cycle_state),
+				udev->slot_id, ep_index, TRB_SET_DEQ);
+		event = xhci_wait_for_event(ctrl, TRB_COMPLETION);
+		if (GET_COMP_CODE(le32_to_cpu(event->event_cmd.status)) !=
+		    COMP_SUCCESS)
+			debug("XHCI failed to set dequeue pointer for ep %d\n",
+			      ep_index);
+		xhci_acknowledge_event(ctrl);
+	} while (++stream <= ep->num_streams);
+}
+
+static unsigned long xhci_transfer_status(union xhci_trb *event, int length,
+					  int *act_len)
+{
+	*act_len = min(length, length -
 		(int)EVENT_TRB_LEN(le32_to_cpu(event->trans_event.transfer_len)));
 
 	switch (GET_COMP_CODE(le32_to_cpu(event->trans_event.transfer_len))) {
 	case COMP_SUCCESS:
-		BUG_ON(udev->act_len != length);
+		BUG_ON(*act_len != length);
 		/* fallthrough */
 	case COMP_SHORT_TX:
-		udev->status = 0;
-		break;
+		return 0;
 	case COMP_STALL:
-		udev->status = USB_ST_STALLED;
-		break;
+		return USB_ST_STALLED;
 	case COMP_DB_ERR:
 	case COMP_TRB_ERR:
-		udev->status = USB_ST_BUF_ERR;
-		break;
+		return USB_ST_BUF_ERR;
 	case COMP_BABBLE:
-		udev->status = USB_ST_BABBLE_DET;
-		break;
+		return USB_ST_BABBLE_DET;
 	default:
-		udev->status = 0x80;  /* USB_ST_TOO_LAZY_TO_MAKE_A_NEW_MACRO */
+		return 0x80;  /* USB_ST_TOO_LAZY_TO_MAKE_A_NEW_MACRO */
 	}
 }
 
+static void record_transfer_result(struct usb_device *udev,
+				   union xhci_trb *event, int length)
+{
+	udev->status = xhci_transfer_status(event, length, &udev->act_len);
+}
+
 /**** Bulk and Control transfer methods ****/
 /**
- * Queues up the BULK Request
+ * Works out how many TRBs a bulk transfer needs
+ *
+ * @param buffer	buffer to be read/written
+ * @param length	length of the buffer
+ * @return number of TRBs
+ */
+static int xhci_bulk_num_trbs(void *buffer, int length)
+{
+	u64 val_64 = (uintptr_t)buffer;
+	int running_total;
+	int num_trbs = 0;
+
+	/*
+	 * How much data is (potentially) left before the 64KB boundary?
+	 * XHCI Spec puts restriction( TABLE 49 and 6.4.1 section of XHCI Spec)
+	 * that the buffer should not span 64KB boundary. if so
+	 * we send request in more than 1 TRB by chaining them.
+	 */
+	running_total = TRB_MAX_BUFF_SIZE -
+			(lower_32_bits(val_64) & (TRB_MAX_BUFF_SIZE - 1));
+	running_total &= TRB_MAX_BUFF_SIZE - 1;
+
+	/*
+	 * If there's some data on this 64KB chunk, or we have to send a
+	 * zero-length transfer, we need at least one TRB
+	 */
+	if (running_total != 0 || length == 0)
+		num_trbs++;
+
+	/* How many more 64KB chunks to transfer, how many more TRBs? */
+	while (running_total < length) {
+		num_trbs++;
+		running_total += TRB_MAX_BUFF_SIZE;
+	}
+
+	return num_trbs;
+}
+
+/**
+ * Queues up the BULK Request and rings the doorbell, without waiting for
+ * it to complete
  *
  * @param udev		pointer to the USB device structure
  * @param pipe		contains the DIR_IN or OUT , devnum
+ * @param stream	stream ID, or 0 if the endpoint has no streams
  * @param length	length of the buffer
  * @param buffer	buffer to be read/written based on the request
- * @return returns 0 if successful else -1 on failure
+ * @return returns 0 if successful else error code on failure
  */
-int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
-			int length, void *buffer)
+static int xhci_bulk_queue(struct usb_device *udev, unsigned long pipe,
+			   unsigned int stream, int length, void *buffer)
 {
-	int num_trbs = 0;
+	int num_trbs;
 	struct xhci_generic_trb *start_trb;
 	bool first_trb = false;
 	int start_cycle;
@@ -566,7 +721,6 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 	struct xhci_virt_device *virt_dev;
 	struct xhci_ep_ctx *ep_ctx;
 	struct xhci_ring *ring;		/* EP transfer ring */
-	union xhci_trb *event;
 
 	int running_total, trb_buff_len;
 	unsigned int total_packet_count;
@@ -587,35 +741,17 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 
 	ep_ctx = xhci_get_ep_ctx(ctrl, virt_dev->out_ctx, ep_index);
 
-	ring = virt_dev->eps[ep_index].ring;
-	/*
-	 * How much data is (potentially) left before the 64KB boundary?
-	 * XHCI Spec puts restriction( TABLE 49 and 6.4.1 section of XHCI Spec)
-	 * that the buffer should not span 64KB boundary. if so
-	 * we send request in more than 1 TRB by chaining them.
-	 */
-	running_total = TRB_MAX_BUFF_SIZE -
-			(lower_32_bits(val_64) & (TRB_MAX_BUFF_SIZE - 1));
-	trb_buff_len = running_total;
-	running_total &= TRB_MAX_BUFF_SIZE - 1;
-
-	/*
-	 * If there's some data on this 64KB chunk, or we have to send a
-	 * zero-length transfer, we need at least one TRB
-	 */
-	if (running_total != 0 || length == 0)
-		num_trbs++;
-
-	/* How many more 64KB chunks to transfer, how many more TRBs? */
-	while (running_total < length) {
-		num_trbs++;
-		running_total += TRB_MAX_BUFF_SIZE;
-	}
+	ring = xhci_stream_ring(&virt_dev->eps[ep_index], stream);
+	if (!ring)
+		return -EINVAL;
+	num_trbs = xhci_bulk_num_trbs(buffer, length);
+	trb_buff_len = TRB_MAX_BUFF_SIZE -
+		       (lower_32_bits(val_64) & (TRB_MAX_BUFF_SIZE - 1));
 
 	/*
 	 * XXX: Calling routine prepare_ring() called in place of
-	 * prepare_trasfer() as there in 'Linux' since we are not
-	 * maintaining multiple TDs/transfer at the same time.
+	 * prepare_trasfer() as there in 'Linux'. When several TDs are
+	 * queued, xhci_bulk_batch() makes sure that they fit on the ring.
 	 */
 	ret = prepare_ring(ctrl, ring,
 			   le32_to_cpu(ep_ctx->ep_info) & EP_STATE_MASK);
@@ -709,7 +845,33 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		trb_buff_len = min((length - running_total), TRB_MAX_BUFF_SIZE);
 	} while (running_total < length);
 
-	giveback_first_trb(udev, ep_index, start_cycle, start_trb);
+	giveback_first_trb(udev, ep_index, stream, start_cycle, start_trb);
+
+	return 0;
+}
+
+/**
+ * Sends a BULK Request and waits for it to complete
+ *
+ * @param udev		pointer to the USB device structure
+ * @param pipe		contains the DIR_IN or OUT , devnum
+ * @param length	length of the buffer
+ * @param buffer	buffer to be read/written based on the request
+ * @return returns 0 if successful else -1 on failure
+ */
+int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
+			int length, void *buffer)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	int slot_id = udev->slot_id;
+	int ep_index = usb_pipe_ep_index(pipe);
+	union xhci_trb *event;
+	u32 field;
+	int ret;
+
+	ret = xhci_bulk_queue(udev, pipe, 0, length, buffer);
+	if (ret < 0)
+		return ret;
 
 	event = xhci_wait_for_event(ctrl, TRB_TRANSFER);
 	if (!event) {
@@ -733,6 +895,152 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 	return (udev->status != USB_ST_NOT_PROC) ? 0 : -1;
 }
 
+/*
+ * Checks whether xfer[next] fits on its ring, along with the TDs from
+ * xfer[first] onwards which are still on that ring
+ */
+static bool xhci_bulk_fits(struct usb_device *udev,
+			   struct usb_bulk_xfer *xfer, int first, int next)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	int ep_index = usb_pipe_ep_index(xfer[next].pipe);
+	unsigned int stream = xfer[next].stream;
+	struct xhci_ring *ring;
+	int used = 0;
+	int i;
+
+	ring = xhci_stream_ring(&ctrl->devs[udev->slot_id]->eps[ep_index],
+				stream);
+	/* Let xhci_bulk_queue() report a bad stream */
+	if (!ring)
+		return true;
+
+	for (i = first; i <= next; i++) {
+		if (xfer[i].status == USB_ST_NOT_PROC &&
+		    usb_pipe_ep_index(xfer[i].pipe) == ep_index &&
+		    xfer[i].stream == stream)
+			used += xhci_bulk_num_trbs(xfer[i].buffer,
+						   xfer[i].length);
+	}
+
+	/* Keep one TRB free, so that a full ring never looks empty */
+	return used < ring->num_segs * (TRBS_PER_SEGMENT - 1);
+}
+
+/**
+ * Sends a batch of BULK Requests, keeping as many of them queued on the
+ * xHC as the endpoint rings allow
+ *
+ * TDs on each ring complete in order, so each transfer event is matched to
+ * the oldest outstanding transfer on its ring: that of the endpoint, or if
+ * the endpoint has streams, whichever stream ring holds the event's TRB.
+ * Processing stops at the first transfer which fails; TDs still queued
+ * behind it are thrown away.
+ *
+ * @param udev		pointer to the USB device structure
+ * @param xfer		transfers to carry out
+ * @param count		number of transfers
+ * @return returns 0 if successful else error code on failure
+ */
+int xhci_bulk_batch(struct usb_device *udev, struct usb_bulk_xfer *xfer,
+		    int count)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	struct xhci_virt_device *virt_dev = ctrl->devs[udev->slot_id];
+	int queued = 0, done = 0;
+	union xhci_trb *event;
+	int i, j, ep_index;
+	u64 trb_addr;
+	u32 field;
+	int ret;
+
+	for (i = 0; i < count; i++) {
+		xfer[i].act_len = 0;
+		xfer[i].status = USB_ST_NOT_PROC;
+	}
+
+	while (done < count) {
+		/* Queue as much as the barriers and the ring space allow */
+		while (queued < count) {
+			struct usb_bulk_xfer *x = &xfer[queued];
+
+			if ((x->flags & USB_BULK_BARRIER) && queued != done)
+				break;
+			if (!xhci_bulk_fits(udev, xfer, done, queued))
+				break;
+			ret = xhci_bulk_queue(udev, x->pipe, x->stream,
+					      x->length, x->buffer);
+			if (ret < 0)
+				goto cancel;
+			queued++;
+		}
+		if (queued == done) {
+			/* Too large even for an empty ring */
+			ret = -EINVAL;
+			goto cancel;
+		}
+
+		event = xhci_wait_for_event(ctrl, TRB_TRANSFER);
+		if (!event) {
+			debug("XHCI bulk batch timed out, aborting...\n");
+			ret = -ETIMEDOUT;
+			goto cancel;
+		}
+		field = le32_to_cpu(event->trans_event.flags);
+		ep_index = TRB_TO_EP_INDEX(field);
+		trb_addr = le64_to_cpu(event->trans_event.buffer);
+		for (i = done; i < queued; i++) {
+			struct xhci_virt_ep *ep = &virt_dev->eps[ep_index];
+
+			if (xfer[i].status != USB_ST_NOT_PROC ||
+			    usb_pipe_ep_index(xfer[i].pipe) != ep_index)
+				continue;
+			if (!ep->num_streams ||
+			    xhci_trb_on_ring(xhci_stream_ring(ep,
+					     xfer[i].stream), trb_addr))
+				break;
+		}
+		if (TRB_TO_SLOT_ID(field) != udev->slot_id || i == queued) {
+			debug("XHCI bulk batch: unexpected event, skipping\n");
+			xhci_acknowledge_event(ctrl);
+			continue;
+		}
+
+		xfer[i].status = xhci_transfer_status(event, xfer[i].length,
+						      &xfer[i].act_len);
+		xhci_acknowledge_event(ctrl);
+		xhci_inval_cache((uintptr_t)xfer[i].buffer, xfer[i].length);
+		if (xfer[i].status) {
+			ret = -EIO;
+			goto cancel;
+		}
+		while (done < queued && xfer[done].status != USB_ST_NOT_PROC)
+			done++;
+	}
+
+	return 0;
+
+cancel:
+	/*
+	 * Empty each ring which still holds TDs from this batch, along with
+	 * the ring of the transfer which failed, since it may be halted
+	 */
+	for (i = done; i < queued; i++) {
+		if (!xfer[i].status)
+			continue;
+		ep_index = usb_pipe_ep_index(xfer[i].pipe);
+		for (j = done; j < i; j++) {
+			if (xfer[j].status &&
+			    usb_pipe_ep_index(xfer[j].pipe) == ep_index)
+				break;
+		}
+		if (j == i)
+			xhci_flush_ep(udev, ep_index);
+	}
+
+	return ret;
+}
+
 /**
  * Queues up the Control Transfer Request
  *
@@ -906,7 +1214,7 @@ int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 
 	queue_trb(ctrl, ep_ring, false, trb_fields);
 
-	giveback_first_trb(udev, ep_index, start_cycle, start_trb);
+	giveback_first_trb(udev, ep_index, 0, start_cycle, start_trb);
 
 	event = xhci_wait_for_event(ctrl, TRB_TRANSFER);
 	if (!event)
@@ -28,6 +28,7 @@
 #include <asm/cache.h>
 #include <asm/unaligned.h>
 #include <linux/errno.h>
+#include <linux/log2.h>
 #include "xhci.h"
 
 #ifndef CONFIG_USB_MAX_CONTROLLER_COUNT
@@ -570,7 +571,9 @@ static int xhci_set_configuration(struct usb_device *udev)
 		ep_ctx[ep_index] = xhci_get_ep_ctx(ctrl, in_ctx, ep_index);
 
 		/* Allocate the ep rings */
-		virt_dev->eps[ep_index].ring = xhci_ring_alloc(1, true);
+		virt_dev->eps[ep_index].ring = xhci_ring_alloc(
+			usb_endpoint_xfer_bulk(endpt_desc) ? BULK_RING_SEGS : 1,
+			true);
 		if (!virt_dev->eps[ep_index].ring)
 			return -ENOMEM;
 
@@ -1145,6 +1148,88 @@ static int _xhci_submit_bulk_msg(struct usb_device *udev, unsigned long pipe,
 	return xhci_bulk_tx(udev, pipe, length, buffer);
 }
 
+/**
+ * Sets up streams on some bulk endpoints, giving each endpoint a stream
+ * context array with a ring per stream, then reconfigures the endpoints to
+ * use them
+ *
+ * @param udev		pointer to the USB device
+ * @param pipes		bulk pipes of the endpoints to set up
+ * @param num_pipes	number of pipes
+ * @param num_streams	number of streams wanted
+ * @return number of streams set up, else error code on failure
+ */
+static int _xhci_alloc_streams(struct usb_device *udev,
+			       const unsigned long *pipes, int num_pipes,
+			       int num_streams)
+{
+	struct xhci_ctrl *ctrl = xhci_get_ctrl(udev);
+	struct xhci_virt_device *virt_dev = ctrl->devs[udev->slot_id];
+	struct xhci_container_ctx *in_ctx = virt_dev->in_ctx;
+	struct xhci_container_ctx *out_ctx = virt_dev->out_ctx;
+	struct xhci_input_control_ctx *ctrl_ctx;
+	struct xhci_ep_ctx *ep_ctx;
+	struct xhci_virt_ep *ep;
+	unsigned int array_size;
+	u32 ep_flags = 0;
+	int i, ep_index;
+	int ret;
+	u32 hcc;
+
+	/* A MaxPSASize of 0 means that the xHC does not support streams */
+	hcc = xhci_readl(&ctrl->hccr->cr_hccparams);
+	if (udev->speed < USB_SPEED_SUPER || HCC_MAX_PSA(hcc) < 4)
+		return -ENOSYS;
+	if (num_streams < 1)
+		return -EINVAL;
+
+	/* Stream 0 is reserved, and the array holds at least 4 entries */
+	num_streams = min(num_streams, HCC_MAX_PSA(hcc) - 1);
+	array_size = max(roundup_pow_of_two(num_streams + 1), 4UL);
+
+	xhci_inval_cache((uintptr_t)out_ctx->bytes, out_ctx->size);
+	xhci_slot_copy(ctrl, in_ctx, out_ctx);
+
+	for (i = 0; i < num_pipes; i++) {
+		if (usb_pipetype(pipes[i]) != PIPE_BULK) {
+			ret = -EINVAL;
+			goto err;
+		}
+		ep_index = usb_pipe_ep_index(pipes[i]);
+		ep = &virt_dev->eps[ep_index];
+		xhci_free_stream_info(ep);
+		xhci_alloc_stream_info(ep, array_size, num_streams);
+
+		xhci_endpoint_copy(ctrl, in_ctx, out_ctx, ep_index);
+		ep_ctx = xhci_get_ep_ctx(ctrl, in_ctx, ep_index);
+		ep_ctx->ep_info &= cpu_to_le32(~(EP_MAXPSTREAMS_MASK |
+						 EP_HAS_LSA));
+		ep_ctx->ep_info |= cpu_to_le32(EP_HAS_LSA |
+				EP_MAXPSTREAMS(ilog2(array_size) - 1));
+		ep_ctx->deq = cpu_to_le64((uintptr_t)ep->stream_ctx);
+		ep_flags |= 1 << (ep_index + 1);
+	}
+
+	/* Drop and add the endpoints, so that the xHC picks up the changes */
+	ctrl_ctx = xhci_get_input_control_ctx(in_ctx);
+	ctrl_ctx->add_flags = cpu_to_le32(SLOT_FLAG | ep_flags);
+	ctrl_ctx->drop_flags = cpu_to_le32(ep_flags);
+
+	ret = xhci_configure_endpoints(udev, false);
+	if (ret)
+		goto err;
+
+	return num_streams;
+
+err:
+	for (i = 0; i < num_pipes; i++) {
+		ep_index = usb_pipe_ep_index(pipes[i]);
+		xhci_free_stream_info(&virt_dev->eps[ep_index]);
+	}
+
+	return ret;
+}
+
 /**
  * submit the control type of request to the Root hub/Device based on the devnum
  *
@@ -1282,6 +1367,18 @@ int submit_int_msg(struct usb_device *udev, unsigned long pipe, void *buffer,
 	return _xhci_submit_int_msg(udev, pipe, buffer, length, interval);
 }
 
+int submit_bulk_batch(struct usb_device *udev, struct usb_bulk_xfer *xfer,
+		      int count)
+{
+	return xhci_bulk_batch(udev, xfer, count);
+}
+
+int usb_alloc_streams(struct usb_device *udev, const unsigned long *pipes,
+		      int num_pipes, int num_streams)
+{
+	return _xhci_alloc_streams(udev, pipes, num_pipes, num_streams);
+}
+
 /**
  * Intialises the XHCI host controller
  * and allocates the necessary data structures
@@ -1384,6 +1481,22 @@ static int xhci_submit_bulk_msg(struct udevice *dev, struct usb_device *udev,
 	return _xhci_submit_bulk_msg(udev, pipe, buffer, length);
 }
 
+static int xhci_submit_bulk_batch(struct udevice *dev,
+				  struct usb_device *udev,
+				  struct usb_bulk_xfer *xfer, int count)
+{
+	debug("%s: dev='%s', udev=%p\n", __func__, dev->name, udev);
+	return xhci_bulk_batch(udev, xfer, count);
+}
+
+static int xhci_alloc_streams(struct udevice *dev, struct usb_device *udev,
+			      const unsigned long *pipes, int num_pipes,
+			      int num_streams)
+{
+	debug("%s: dev='%s', udev=%p\n", __func__, dev->name, udev);
+	return _xhci_alloc_streams(udev, pipes, num_pipes, num_streams);
+}
+
 static int xhci_submit_int_msg(struct udevice *dev, struct usb_device *udev,
 			       unsigned long pipe, void *buffer, int length,
 			       int interval)
@@ -1467,13 +1580,16 @@ static int xhci_update_hub_device(struct udevice *dev, struct usb_device *udev)
 static int xhci_get_max_xfer_size(struct udevice *dev, size_t *size)
 {
 	/*
-	 * xHCD allocates one segment which includes 64 TRBs for each endpoint
-	 * and the last TRB in this segment is configured as a link TRB to form
-	 * a TRB ring. Each TRB can transfer up to 64K bytes, however data
-	 * buffers referenced by transfer TRBs shall not span 64KB boundaries.
-	 * Hence the maximum number of TRBs we can use in one transfer is 62.
+	 * xHCD allocates BULK_RING_SEGS segments of 64 TRBs for each bulk
+	 * endpoint, and the last TRB in each segment is a link TRB. Each TRB
+	 * can transfer up to 64K bytes, however data buffers referenced by
+	 * transfer TRBs shall not span 64KB boundaries, so an unaligned buffer
+	 * needs an extra TRB. Also leave room for a short transfer queued
+	 * behind this one (e.g. a mass-storage status block) and for the TRB
+	 * which stops the ring from filling up.
 	 */
-	*size = (TRBS_PER_SEGMENT - 2) * TRB_MAX_BUFF_SIZE;
+	*size = (BULK_RING_SEGS * (TRBS_PER_SEGMENT - 1) - 3) *
+		TRB_MAX_BUFF_SIZE;
 
 	return 0;
 }
@@ -1528,6 +1644,8 @@ int xhci_deregister(struct udevice *dev)
 struct dm_usb_ops xhci_usb_ops = {
 	.control = xhci_submit_control_msg,
 	.bulk = xhci_submit_bulk_msg,
+	.bulk_batch = xhci_submit_bulk_batch,
+	.alloc_streams = xhci_alloc_streams,
 	.interrupt = xhci_submit_int_msg,
 	.alloc_device = xhci_alloc_device,
 	.update_hub_device = xhci_update_hub_device,
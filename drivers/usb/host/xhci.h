@@ -626,6 +626,26 @@ struct xhci_ep_ctx {
 /* Endpoint is set up with a Linear Stream Array (vs. Secondary Stream Array) */
 #define	EP_HAS_LSA			(1 << 15)
 
+/**
+ * struct xhci_stream_ctx - one entry of an endpoint's stream context array
+ * @stream_ring:	dequeue pointer of the stream's ring, along with the
+ *			dequeue cycle state and stream context type
+ *
+ * Stream Context - section 6.2.4.1
+ */
+struct xhci_stream_ctx {
+	__le64	stream_ring;
+	/* offset 0x08 - 0x0f reserved for HC internal use */
+	__le32	reserved[2];
+};
+
+/* Stream Context Type - bits 3:1 of the stream ring pointer */
+#define SCT_FOR_CTX(p)		(((p) & 0x7) << 1)
+/* Secondary stream array type, dequeue pointer is to a transfer ring */
+#define SCT_SEC_TR		0
+/* Primary stream array type, dequeue pointer is to a transfer ring */
+#define SCT_PRI_TR		1
+
 /* ep_info2 bitmasks */
 /*
  * Force Event - generate transfer events for all TRBs for this endpoint
@@ -991,6 +1011,11 @@ typedef enum {
 #define TRBS_PER_SEGMENT	64
 /* Allow two commands + a link TRB, along with any reserved command TRBs */
 #define MAX_RSVD_CMD_TRBS	(TRBS_PER_SEGMENT - 3)
+/*
+ * Bulk endpoint rings have several segments, so that large transfers can be
+ * queued, along with other transfers behind them (see xhci_bulk_batch())
+ */
+#define BULK_RING_SEGS		4
 #define SEGMENT_SIZE		(TRBS_PER_SEGMENT*16)
 /* SEGMENT_SHIFT should be log2(SEGMENT_SIZE).
  * Change this if you change TRBS_PER_SEGMENT!
@@ -1067,6 +1092,10 @@ struct xhci_virt_ep {
 #define EP_HAS_STREAMS		(1 << 4)
 /* Transitioning the endpoint to not using streams, don't enqueue URBs */
 #define EP_GETTING_NO_STREAMS	(1 << 5)
+	/* Set up by xhci_alloc_stream_info() if the endpoint uses streams */
+	struct xhci_stream_ctx		*stream_ctx;
+	struct xhci_ring		**stream_rings;
+	unsigned int			num_streams;
 };
 
 #define CTX_SIZE(_hcc) (HCC_64BYTE_CONTEXT(_hcc) ? 64 : 32)
@@ -1255,6 +1284,8 @@ void xhci_acknowledge_event(struct xhci_ctrl *ctrl);
 union xhci_trb *xhci_wait_for_event(struct xhci_ctrl *ctrl, trb_type expected);
 int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		 int length, void *buffer);
+int xhci_bulk_batch(struct usb_device *udev, struct usb_bulk_xfer *xfer,
+		    int count);
 int xhci_ctrl_tx(struct usb_device *udev, unsigned long pipe,
 		 struct devrequest *req, int length, void *buffer);
 int xhci_check_maxpacket(struct usb_device *udev);
@@ -1262,6 +1293,9 @@ void xhci_flush_cache(uintptr_t addr, u32 type_len);
 void xhci_inval_cache(uintptr_t addr, u32 type_len);
 void xhci_cleanup(struct xhci_ctrl *ctrl);
 struct xhci_ring *xhci_ring_alloc(unsigned int num_segs, bool link_trbs);
+void xhci_alloc_stream_info(struct xhci_virt_ep *ep, unsigned int array_size,
+			    unsigned int num_streams);
+void xhci_free_stream_info(struct xhci_virt_ep *ep);
 int xhci_alloc_virt_device(struct xhci_ctrl *ctrl, unsigned int slot_id);
 int xhci_mem_init(struct xhci_ctrl *ctrl, struct xhci_hccr *hccr,
 		  struct xhci_hcor *hcor);
@@ -32,6 +32,7 @@ static int sandbox_sdl_probe(struct udevice *dev)
 	}
 	uc_priv->xsize = plat->xres;
 	uc_priv->ysize = plat->yres;
+	uc_priv->ysize_virt = plat->yres * 2;
 	uc_priv->bpix = plat->bpix;
 	uc_priv->rot = plat->rot;
 	uc_priv->vidconsole_drv_name = plat->vidconsole_drv_name;
@@ -51,12 +52,24 @@ static int sandbox_sdl_bind(struct udevice *dev)
 	plat->xres = fdtdec_get_int(blob, node, "xres", LCD_MAX_WIDTH);
 	plat->yres = fdtdec_get_int(blob, node, "yres", LCD_MAX_HEIGHT);
 	plat->bpix = VIDEO_BPP16;
-	uc_plat->size = plat->xres * plat->yres * (1 << plat->bpix) / 8;
+
+	/* Allow the display to be panned down by a whole screen */
+	uc_plat->size = plat->xres * plat->yres * 2 * (1 << plat->bpix) / 8;
 	debug("%s: Frame buffer size %x\n", __func__, uc_plat->size);
 
 	return ret;
 }
 
+static int sandbox_sdl_set_yoffset(struct udevice *dev, uint yoffset)
+{
+	/* video_sync() passes the top of the display to SDL, so nothing to do */
+	return 0;
+}
+
+static const struct video_ops sandbox_sdl_ops = {
+	.set_yoffset	= sandbox_sdl_set_yoffset,
+};
+
 static const struct udevice_id sandbox_sdl_ids[] = {
 	{ .compatible = "sandbox,lcd-sdl" },
 	{ }
@@ -68,5 +81,6 @@ U_BOOT_DRIVER(sdl_sandbox) = {
 	.of_match = sandbox_sdl_ids,
 	.bind	= sandbox_sdl_bind,
 	.probe	= sandbox_sdl_probe,
+	.ops	= &sandbox_sdl_ops,
 	.platdata_auto_alloc_size	= sizeof(struct sandbox_sdl_plat),
 };
@@ -38,6 +38,15 @@
  * video_post_probe(). This function also clears the frame buffer and
  * allocates a suitable text console device. This can then be used to write
  * text to the video device.
+ *
+ * With CONFIG_VIDEO_COPY a second buffer of the same size is reserved below
+ * each frame buffer (at plat->shadow_base). U-Boot draws into that and
+ * video_sync() copies the damaged area to the frame buffer which is
+ * displayed.
+ *
+ * If the driver can pan the display, video_move_lines() scrolls by moving
+ * the top of the display down the frame buffer, only copying the display
+ * back to the start when it reaches the end.
  */
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -60,6 +69,10 @@ static ulong alloc_fb(struct udevice *dev, ulong *addrp)
 	base = *addrp - plat->size;
 	base &= ~(align - 1);
 	plat->base = base;
+	if (IS_ENABLED(CONFIG_VIDEO_COPY)) {
+		base = (base - plat->size) & ~(align - 1);
+		plat->shadow_base = base;
+	}
 	size = *addrp - base;
 	*addrp = base;
 
@@ -86,31 +99,39 @@ int video_reserve(ulong *addrp)
 	return 0;
 }
 
-int video_clear(struct udevice *dev)
+/* Fill @count pixel rows of the display, from row @y, with the background */
+static void video_fill_lines(struct video_priv *priv, int y, int count)
 {
-	struct video_priv *priv = dev_get_uclass_priv(dev);
+	void *start = priv->fb + y * priv->line_length;
+	void *end = start + count * priv->line_length;
 
 	switch (priv->bpix) {
 	case VIDEO_BPP16: {
-		u16 *ppix = priv->fb;
-		u16 *end = priv->fb + priv->fb_size;
+		u16 *ppix = start;
 
-		while (ppix < end)
+		while (ppix < (u16 *)end)
 			*ppix++ = priv->colour_bg;
 		break;
 	}
 	case VIDEO_BPP32: {
-		u32 *ppix = priv->fb;
-		u32 *end = priv->fb + priv->fb_size;
+		u32 *ppix = start;
 
-		while (ppix < end)
+		while (ppix < (u32 *)end)
 			*ppix++ = priv->colour_bg;
 		break;
 	}
 	default:
-		memset(priv->fb, priv->colour_bg, priv->fb_size);
+		memset(start, priv->colour_bg, end - start);
 		break;
 	}
+}
+
+int video_clear(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	video_fill_lines(priv, 0, priv->ysize);
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 
 	return 0;
 }
@@ -140,31 +161,213 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = vid_console_color(priv, back);
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	int x1 = min(x + width, (int)priv->xsize);
+	int y1 = min(y + height, (int)priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= x1 || y >= y1)
+		return;
+	if (damage->x0 >= damage->x1) {
+		damage->x0 = x;
+		damage->y0 = y;
+		damage->x1 = x1;
+		damage->y1 = y1;
+	} else {
+		damage->x0 = min(damage->x0, x);
+		damage->y0 = min(damage->y0, y);
+		damage->x1 = max(damage->x1, x1);
+		damage->y1 = max(damage->y1, y1);
+	}
+}
+#endif
+
+/* Point @fb and @copy_fb at the top of the display */
+static void video_set_fb(struct video_priv *priv, int yoffset)
+{
+	priv->yoffset = yoffset;
+	priv->fb = priv->fb_base + yoffset * priv->line_length;
+	if (priv->copy_base)
+		priv->copy_fb = priv->copy_base + yoffset * priv->line_length;
+}
+
+/* Scroll the display up by @lines pixel rows by panning it */
+static int video_pan(struct udevice *vid, int lines)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	struct video_ops *ops = video_get_ops(vid);
+	int yoffset = priv->yoffset + lines;
+	bool wrap = false;
+	int ret;
+
+	if (yoffset + priv->ysize > priv->ysize_virt) {
+		/* Start again with the rows which stay on the display */
+		memmove(priv->fb_base, priv->fb + lines * priv->line_length,
+			(priv->ysize - lines) * priv->line_length);
+		yoffset = 0;
+		wrap = true;
+	}
+	ret = ops->set_yoffset(vid, yoffset);
+	if (ret) {
+		priv->pan = false;
+		return ret;
+	}
+	video_set_fb(priv, yoffset);
+
+	/* Anything not yet synced has moved up with the display */
+	if (wrap) {
+		video_damage(vid, 0, 0, priv->xsize, priv->ysize);
+	} else if (damage->x0 < damage->x1) {
+		damage->y0 = max(damage->y0 - lines, 0);
+		damage->y1 -= lines;
+		if (damage->y1 <= damage->y0)
+			damage->x1 = damage->x0;
+	}
+	video_fill_lines(priv, priv->ysize - lines, lines);
+	video_damage(vid, 0, priv->ysize - lines, priv->xsize, lines);
+
+	return 0;
+}
+
+void video_move_lines(struct udevice *vid, int ydst, int ysrc, int count)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	if (priv->pan && !ydst && ysrc > 0 && ysrc < priv->ysize &&
+	    !video_pan(vid, ysrc))
+		return;
+	memmove(priv->fb + ydst * priv->line_length,
+		priv->fb + ysrc * priv->line_length,
+		count * priv->line_length);
+	video_damage(vid, 0, ydst, priv->xsize, count);
+}
+
+int video_set_pan(struct udevice *dev, bool enable)
+{
+	struct video_uc_platdata *plat = dev_get_uclass_platdata(dev);
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	int ret;
+
+	if (enable) {
+		if (!ops || !ops->set_yoffset || priv->ysize_virt <= priv->ysize ||
+		    priv->ysize_virt * priv->line_length > plat->size)
+			return -ENOSYS;
+		priv->pan = true;
+		return 0;
+	}
+	priv->pan = false;
+	if (!priv->yoffset)
+		return 0;
+	memmove(priv->fb_base, priv->fb, priv->fb_size);
+	ret = ops->set_yoffset(dev, 0);
+	video_set_fb(priv, 0);
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
+	video_sync(dev, true);
+
+	return ret;
+}
+
+/* Copy the damaged part of the shadow frame buffer to the one displayed */
+static void video_copy_damage(struct video_priv *priv)
+{
+	struct video_bbox *damage = &priv->damage;
+	int offset, size, y;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		memcpy(priv->copy_fb, priv->fb, priv->fb_size);
+		return;
+	}
+	if (damage->x0 >= damage->x1)
+		return;
+	offset = damage->y0 * priv->line_length;
+	if (!damage->x0 && damage->x1 == priv->xsize) {
+		memcpy(priv->copy_fb + offset, priv->fb + offset,
+		       (damage->y1 - damage->y0) * priv->line_length);
+		return;
+	}
+	offset += damage->x0 * VNBITS(priv->bpix) / 8;
+	size = DIV_ROUND_UP(damage->x1 * VNBITS(priv->bpix), 8) -
+		damage->x0 * VNBITS(priv->bpix) / 8;
+	for (y = damage->y0; y < damage->y1; y++) {
+		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+		offset += priv->line_length;
+	}
+}
+
+#if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
+static void video_flush_range(void *start, void *end)
+{
+	flush_dcache_range(ALIGN_DOWN((ulong)start, CONFIG_SYS_CACHELINE_SIZE),
+			   ALIGN((ulong)end, CONFIG_SYS_CACHELINE_SIZE));
+}
+
+/* Flush the damaged part of frame buffer @fb, line by line if necessary */
+static void video_flush_dcache(struct video_priv *priv, void *fb)
+{
+	struct video_bbox *damage = &priv->damage;
+	void *line;
+	int y;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		video_flush_range(fb, fb + priv->fb_size);
+		return;
+	}
+	if (damage->x0 >= damage->x1)
+		return;
+	line = fb + damage->y0 * priv->line_length;
+	if (!damage->x0 && damage->x1 == priv->xsize) {
+		video_flush_range(line, line + (damage->y1 - damage->y0) *
+				  priv->line_length);
+		return;
+	}
+	for (y = damage->y0; y < damage->y1; y++) {
+		video_flush_range(line + damage->x0 * VNBITS(priv->bpix) / 8,
+				  line + DIV_ROUND_UP(damage->x1 *
+						      VNBITS(priv->bpix), 8));
+		line += priv->line_length;
+	}
+}
+#endif
+
 /* Flush video activity to the caches */
 void video_sync(struct udevice *vid, bool force)
 {
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	void *fb = priv->fb;
+#ifdef CONFIG_VIDEO_SANDBOX_SDL
+	static ulong last_sync;
+
+	/* Keep the damage until the next sync */
+	if (!force && get_timer(last_sync) <= 10)
+		return;
+#endif
+
+	if (IS_ENABLED(CONFIG_VIDEO_COPY) && priv->copy_fb) {
+		video_copy_damage(priv);
+		fb = priv->copy_fb;
+	}
+
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
-	}
+	if (priv->flush_dcache)
+		video_flush_dcache(priv, fb);
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-	static ulong last_sync;
-
-	if (force || get_timer(last_sync) > 10) {
-		sandbox_sdl_sync(priv->fb);
-		last_sync = get_timer(0);
-	}
+	sandbox_sdl_sync(fb);
+	last_sync = get_timer(0);
 #endif
+	priv->damage.x0 = 0;
+	priv->damage.x1 = 0;
 }
 
 void video_sync_all(void)
@@ -209,6 +412,7 @@ static int video_pre_remove(struct udevice *dev)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
+	video_set_pan(dev, false);
 	free(priv->cmap);
 
 	return 0;
@@ -225,9 +429,14 @@ static int video_post_probe(struct udevice *dev)
 	int ret;
 
 	/* Set up the line and display size */
-	priv->fb = map_sysmem(plat->base, plat->size);
+	priv->fb_base = map_sysmem(plat->base, plat->size);
+	if (IS_ENABLED(CONFIG_VIDEO_COPY) && plat->shadow_base) {
+		priv->copy_base = priv->fb_base;
+		priv->fb_base = map_sysmem(plat->shadow_base, plat->size);
+	}
 	if (!priv->line_length)
 		priv->line_length = priv->xsize * VNBYTES(priv->bpix);
+	video_set_fb(priv, 0);
 
 	priv->fb_size = priv->line_length * priv->ysize;
 
@@ -236,6 +445,11 @@ static int video_post_probe(struct udevice *dev)
 
 	if (!CONFIG_IS_ENABLED(NO_FB_CLEAR))
 		video_clear(dev);
+	else if (priv->copy_fb)
+		memcpy(priv->fb, priv->copy_fb, priv->fb_size);
+
+	/* Scroll by panning the display if the driver supports it */
+	video_set_pan(dev, true);
 
 	/*
 	 * Create a text console device. For now we always do this, although
@@ -344,6 +344,7 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		break;
 	};
 
+	video_damage(dev, x, y, width, height);
 	video_sync(dev, false);
 
 	return 0;
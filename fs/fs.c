@@ -11,15 +11,23 @@
 #include <ext4fs.h>
 #include <fat.h>
 #include <fs.h>
+#include <image.h>
+#include <lmb.h>
+#include <malloc.h>
 #include <sandboxfs.h>
 #include <ubifs_uboot.h>
 #include <btrfs.h>
 #include <asm/io.h>
 #include <div64.h>
 #include <linux/math64.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Size of each chunk of a gzipped file read by fs_read_gunzip() */
+#define FS_GUNZIP_CHUNK_SIZE	SZ_256K
+#define FS_STACK_MARGIN		SZ_1M
+
 static struct blk_desc *fs_dev_desc;
 static int fs_dev_part;
 static disk_partition_t fs_partition;
@@ -443,6 +451,7 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	buf = map_sysmem(addr, len);
 	ret = info->read(filename, buf, offset, len, actread);
 	unmap_sysmem(buf);
+	fit_handoff_invalidate(addr, ret ? len : *actread);
 
 	/* If we requested a specific number of bytes, check we got it */
 	if (ret == 0 && len && *actread != len)
@@ -452,6 +461,73 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return ret;
 }
 
+/**
+ * struct fs_gunzip_priv - State of a gzipped file being read in chunks
+ *
+ * @info:	Filesystem to read from
+ * @filename:	Name of file to read
+ * @pos:	Position of the next chunk in the file
+ * @size:	Size of the file in bytes
+ */
+struct fs_gunzip_priv {
+	struct fstype_info *info;
+	const char *filename;
+	loff_t pos;
+	loff_t size;
+};
+
+static int fs_gunzip_read(void *priv, void *buf, int size)
+{
+	struct fs_gunzip_priv *st = priv;
+	loff_t actread;
+
+	if (size > st->size - st->pos)
+		size = st->size - st->pos;
+	if (!size)
+		return 0;
+	if (st->info->read(st->filename, buf, st->pos, size, &actread) ||
+	    !actread)
+		return -EIO;
+	st->pos += actread;
+
+	return actread;
+}
+
+int fs_read_gunzip(const char *filename, ulong addr, loff_t maxsize,
+		   loff_t *actread)
+{
+	struct fs_gunzip_priv st;
+	void *buf, *dst;
+	ulong len = 0;
+	int ret;
+
+	st.info = fs_get_info(fs_type);
+	st.filename = filename;
+	st.pos = 0;
+	ret = st.info->size(filename, &st.size);
+	if (ret)
+		goto out;
+
+	buf = malloc(FS_GUNZIP_CHUNK_SIZE);
+	if (!buf) {
+		printf("** Cannot allocate %d bytes **\n",
+		       FS_GUNZIP_CHUNK_SIZE);
+		ret = -1;
+		goto out;
+	}
+	dst = map_sysmem(addr, maxsize);
+	ret = gunzip_stream(dst, maxsize, fs_gunzip_read, &st, buf,
+			    FS_GUNZIP_CHUNK_SIZE, &len);
+	unmap_sysmem(dst);
+	free(buf);
+	fit_handoff_invalidate(addr, ret ? maxsize : len);
+	*actread = len;
+out:
+	fs_close();
+
+	return ret;
+}
+
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite)
 {
@@ -571,8 +647,43 @@ int do_size(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	return 0;
 }
 
-int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
-		int fstype)
+/**
+ * fs_get_free_size() - Get the space which is free at an address
+ *
+ * @addr:	Address to check
+ * @return number of bytes which can be written at @addr without overwriting
+ *	U-Boot or anything else which is in use
+ */
+static loff_t fs_get_free_size(ulong addr)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+
+	lmb_init_and_reserve(&lmb, env_get_bootm_low(), env_get_bootm_size());
+
+	return lmb_get_free_size(&lmb, addr);
+#else
+	/*
+	 * Everything U-Boot uses is above its stack, so stay below that,
+	 * allowing room for the stack to grow
+	 */
+	ulong top = gd->start_addr_sp - FS_STACK_MARGIN;
+
+	return addr < top ? top - addr : 0;
+#endif
+}
+
+/**
+ * fs_load() - Load a file, optionally uncompressing it
+ *
+ * This implements the load and loadz commands.
+ *
+ * @gunzip:	true to uncompress a gzipped file as it is read. In this case
+ *		there is no 'pos' argument and 'bytes' limits the size of the
+ *		uncompressed data
+ */
+static int fs_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		   int fstype, bool gunzip)
 {
 	unsigned long addr;
 	const char *addr_str;
@@ -586,7 +697,7 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 
 	if (argc < 2)
 		return CMD_RET_USAGE;
-	if (argc > 7)
+	if (argc > (gunzip ? 6 : 7))
 		return CMD_RET_USAGE;
 
 	if (fs_set_blk_dev(argv[1], (argc >= 3) ? argv[2] : NULL, fstype))
@@ -622,12 +733,24 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		pos = 0;
 
 	time = get_timer(0);
-	ret = fs_read(filename, addr, pos, bytes, &len_read);
+	if (gunzip) {
+		if (!bytes) {
+			bytes = fs_get_free_size(addr);
+			if (!bytes) {
+				printf("** Address %lx is in use **\n", addr);
+				return 1;
+			}
+		}
+		ret = fs_read_gunzip(filename, addr, bytes, &len_read);
+	} else {
+		ret = fs_read(filename, addr, pos, bytes, &len_read);
+	}
 	time = get_timer(time);
 	if (ret < 0)
 		return 1;
 
-	printf("%llu bytes read in %lu ms", len_read, time);
+	printf("%llu bytes %s in %lu ms", len_read,
+	       gunzip ? "uncompressed" : "read", time);
 	if (time > 0) {
 		puts(" (");
 		print_size(div_u64(len_read, time) * 1000, "/s");
@@ -641,6 +764,18 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	return 0;
 }
 
+int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		int fstype)
+{
+	return fs_load(cmdtp, flag, argc, argv, fstype, false);
+}
+
+int do_loadz(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+	     int fstype)
+{
+	return fs_load(cmdtp, flag, argc, argv, fstype, true);
+}
+
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	int fstype)
 {
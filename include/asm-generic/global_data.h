@@ -77,6 +77,9 @@ typedef struct global_data {
 #ifdef CONFIG_OF_LIVE
 	struct device_node *of_root;
 #endif
+#if CONFIG_IS_ENABLED(OF_PHANDLE_CACHE)
+	struct fdtdec_phandle_cache *phandle_cache;	/* phandle lookups */
+#endif
 
 #if CONFIG_IS_ENABLED(MULTI_DTB_FIT)
 	const void *multi_dtb_fit;	/* uncompressed multi-dtb FIT image */
@@ -125,6 +128,7 @@ typedef struct global_data {
 	int default_log_level;		/* For devices with no filters */
 	struct list_head log_head;	/* List of struct log_device */
 	int log_fmt;			/* Mask containing log format info */
+	struct log_ring_hdr *log_ring;	/* In-memory log ring, if enabled */
 #endif
 #if CONFIG_IS_ENABLED(BLOBLIST)
 	struct bloblist_hdr *bloblist;	/* Bloblist information */
@@ -27,6 +27,9 @@ enum bloblist_tag_t {
 	BLOBLISTT_SPL_HANDOFF,		/* Hand-off info from SPL */
 	BLOBLISTT_VBOOT_CTX,		/* Chromium OS verified boot context */
 	BLOBLISTT_VBOOT_HANDOFF,	/* Chromium OS internal handoff info */
+	BLOBLISTT_LOG_RING,		/* In-memory log ring */
+	BLOBLISTT_WARM_STATE,		/* Probed device state, see warm_state.h */
+	BLOBLISTT_FIT_HANDOFF,		/* FIT images verified by SPL */
 };
 
 /**
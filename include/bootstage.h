@@ -199,6 +199,7 @@ enum bootstage_id {
 	BOOTSTATE_ID_ACCUM_DM_SPL,
 	BOOTSTATE_ID_ACCUM_DM_F,
 	BOOTSTATE_ID_ACCUM_DM_R,
+	BOOTSTAGE_ID_ACCUM_MMU,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
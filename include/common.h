@@ -438,6 +438,28 @@ int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
 
+/**
+ * gunzip_stream() - Uncompress gzipped data which is read a chunk at a time
+ *
+ * Only @bufsize bytes of the compressed data need to be in memory at once,
+ * so it can be uncompressed as it is read from storage. The gzip trailer is
+ * checked, so corrupted data is detected.
+ *
+ * @dst:	Destination for uncompressed data
+ * @dstlen:	Size of @dst in bytes
+ * @read:	Function to read the next chunk of compressed data into @buf,
+ *		up to @size bytes. It returns the number of bytes read, 0 at
+ *		the end of the data or -ve on error
+ * @priv:	Private data to pass to @read
+ * @buf:	Buffer to hold compressed data
+ * @bufsize:	Size of @buf in bytes
+ * @lenp:	Returns the number of bytes uncompressed
+ * @return 0 if OK, -1 on error
+ */
+int gunzip_stream(void *dst, ulong dstlen,
+		  int (*read)(void *priv, void *buf, int size), void *priv,
+		  void *buf, int bufsize, ulong *lenp);
+
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
  * overrides:
@@ -20,12 +20,15 @@ typedef u32 phandle;
  * @length: Length of property in bytes
  * @value: Pointer to property value
  * @next: Pointer to next property, or NULL if none
+ * @id: ID of the property name in the live-tree index (see
+ *	of_prop_name_id()), or -1 if the name is not in the index
  */
 struct property {
 	char *name;
 	int length;
 	void *value;
 	struct property *next;
+	int id;
 };
 
 /**
@@ -52,6 +55,52 @@ struct device_node {
 	struct device_node *sibling;
 };
 
+/**
+ * struct of_strtab - Table of strings interned to small integer IDs
+ *
+ * IDs are allocated in order from 0. The table is an open-addressed hash
+ * table and cannot grow, so it must be created with enough room.
+ *
+ * @str: String for each ID
+ * @slot: Hash slots, each holding an ID + 1, or 0 if empty
+ * @count: Number of strings in the table
+ * @max: Maximum number of strings the table can hold
+ * @mask: Number of hash slots - 1
+ * @nocase: true to ignore case when comparing strings
+ */
+struct of_strtab {
+	const char **str;
+	uint *slot;
+	uint count;
+	uint max;
+	uint mask;
+	bool nocase;
+};
+
+/**
+ * struct of_live_index - Lookup tables for a live tree
+ *
+ * These are built along with the live tree so that finding a property or
+ * a compatible node does not need a string compare against every property
+ * or node in the tree.
+ *
+ * @root: Root node of the tree this index was built for. Its nodes and
+ *	properties lie between @root and the index, in the same allocation
+ * @names: Property names; each struct property holds the ID of its name
+ * @compats: Compatible strings (ignoring case), NULL if not available
+ * @compat_start: Index into @compat_nodes of the first node for each
+ *	compatible ID. There is an extra entry at the end, so the nodes for ID
+ *	n are compat_nodes[compat_start[n]] to compat_nodes[compat_start[n + 1]]
+ * @compat_nodes: Nodes for each compatible string, in tree order
+ */
+struct of_live_index {
+	struct device_node *root;
+	struct of_strtab names;
+	struct of_strtab *compats;
+	uint *compat_start;
+	struct device_node **compat_nodes;
+};
+
 #define OF_MAX_PHANDLE_ARGS 16
 
 /**
@@ -441,4 +441,80 @@ int of_alias_get_highest_id(const char *stem);
  */
 struct device_node *of_get_stdout(void);
 
+/**
+ * of_strtab_size() - Get the memory needed for a string table
+ *
+ * @max: Maximum number of strings to hold
+ * @return number of bytes needed by of_strtab_init()
+ */
+size_t of_strtab_size(uint max);
+
+/**
+ * of_strtab_init() - Set up an empty string table
+ *
+ * The strings themselves are not copied, so must remain valid for the life
+ * of the table.
+ *
+ * @tab: Table to set up
+ * @buf: Memory to use, of size of_strtab_size(@max), pointer-aligned
+ * @max: Maximum number of strings to hold
+ * @nocase: true to ignore case when comparing strings
+ */
+void of_strtab_init(struct of_strtab *tab, void *buf, uint max, bool nocase);
+
+/**
+ * of_strtab_add() - Intern a string
+ *
+ * @tab: Table to update
+ * @str: String to add
+ * @return ID of the string (existing or new), or -ENOSPC if the table is full
+ */
+int of_strtab_add(struct of_strtab *tab, const char *str);
+
+/**
+ * of_strtab_find() - Look up the ID of a string
+ *
+ * @tab: Table to search
+ * @str: String to find
+ * @return ID of the string, or -ENOENT if it is not in the table
+ */
+int of_strtab_find(const struct of_strtab *tab, const char *str);
+
+/**
+ * of_live_set_index() - Set the lookup tables for the live tree
+ *
+ * This is called by of_live_build() once the tree has been created.
+ *
+ * @index: Index to use, or NULL if none
+ */
+void of_live_set_index(struct of_live_index *index);
+
+/**
+ * of_prop_name_id() - Get the ID of a property name in the live tree
+ *
+ * @name: Property name
+ * @return ID of the name, or -ENOENT if no property in the live tree had
+ *	this name when it was built
+ */
+int of_prop_name_id(const char *name);
+
+/**
+ * of_compat_index_build() - Build the compatible-string index
+ *
+ * This records the nodes that list each compatible string, so that
+ * of_find_compatible_node() does not need to check every node.
+ *
+ * @return 0 if OK, -ENOENT if there is no index or it is not for the tree
+ *	at gd->of_root, -ENOMEM if out of memory
+ */
+int of_compat_index_build(void);
+
+/**
+ * of_compat_index_drop() - Stop using the compatible-string index
+ *
+ * This must be called when a compatible property is changed. Lookups fall
+ * back to checking every node.
+ */
+void of_compat_index_drop(void);
+
 #endif
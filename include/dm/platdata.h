@@ -22,12 +22,15 @@
  * @name:	Driver name
  * @platdata:	Driver-specific platform data
  * @platdata_size: Size of platform data structure
+ * @flags:	Device flags (DM_FLAG_PRE_RELOC to bind the device before
+ *		relocation even if its driver does not have that flag)
  */
 struct driver_info {
 	const char *name;
 	const void *platdata;
 #if CONFIG_IS_ENABLED(OF_PLATDATA)
 	uint platdata_size;
+	uint flags;
 #endif
 };
 
@@ -123,6 +123,43 @@ struct dma_ops {
 	 */
 	int (*transfer)(struct udevice *dev, int direction, void *dst,
 			void *src, size_t len);
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+	/**
+	 * submit() - Start an asynchronous memory-to-memory transfer
+	 *
+	 * The uclass has already written back the source and destination
+	 * from the data cache, and checked that no segment overlaps itself
+	 * and that each destination is cache-line aligned. The uclass
+	 * invalidates the destinations once the transfer is complete. The
+	 * implementation must not wait for the transfer to finish.
+	 *
+	 * @dev: The DMA device
+	 * @desc: The transfer to start; the driver may use desc->cookie
+	 * @return zero on success, -EBUSY if the device cannot accept
+	 *   another transfer, or other -ve error code.
+	 */
+	int (*submit)(struct udevice *dev, struct dma_async_desc *desc);
+	/**
+	 * poll() - Check an asynchronous transfer
+	 *
+	 * @dev: The DMA device
+	 * @desc: A transfer started by submit()
+	 * @return zero if complete, -EINPROGRESS if still running, or other
+	 *   -ve error code.
+	 */
+	int (*poll)(struct udevice *dev, struct dma_async_desc *desc);
+	/**
+	 * wait() - Wait for an asynchronous transfer to complete
+	 *
+	 * This is optional. If it is not provided, the uclass calls poll()
+	 * until the transfer completes or times out.
+	 *
+	 * @dev: The DMA device
+	 * @desc: A transfer started by submit()
+	 * @return zero on success, or -ve error code.
+	 */
+	int (*wait)(struct udevice *dev, struct dma_async_desc *desc);
+#endif
 };
 
 #endif /* _DMA_UCLASS_H */
@@ -316,4 +316,98 @@ int dma_get_device(u32 transfer_type, struct udevice **devp);
  */
 int dma_memcpy(void *dst, void *src, size_t len);
 
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+/**
+ * struct dma_sg - One segment of a memory-to-memory DMA transfer
+ *
+ * @dst: Destination address, aligned to ARCH_DMA_MINALIGN
+ * @src: Source address, or NULL to fill @len bytes at @dst with the
+ *	 fill value of the descriptor
+ * @len: Number of bytes, a multiple of ARCH_DMA_MINALIGN
+ */
+struct dma_sg {
+	void *dst;
+	const void *src;
+	size_t len;
+};
+
+/**
+ * struct dma_async_desc - An asynchronous memory-to-memory DMA transfer
+ *
+ * The caller fills in @sg, @count and (for fills) @fill, then passes the
+ * descriptor to dma_async_submit(). The descriptor and its segment list
+ * must stay valid, and the memory they describe must not be touched by
+ * the CPU, until dma_async_poll() or dma_async_wait() reports that the
+ * transfer is complete. Segments are processed in order.
+ *
+ * @sg: Segments to transfer
+ * @count: Number of segments in @sg
+ * @fill: Byte value written by segments with a NULL source
+ * @dev: DMA device handling the transfer (set by dma_async_submit())
+ * @cookie: Driver-private transfer ID
+ * @status: -EINPROGRESS while running, then 0 or -ve error code
+ */
+struct dma_async_desc {
+	const struct dma_sg *sg;
+	int count;
+	int fill;
+	struct udevice *dev;
+	unsigned long cookie;
+	int status;
+};
+
+/**
+ * dma_async_submit() - Start an asynchronous memory-to-memory transfer
+ *
+ * This writes back the source and destination from the data cache, then
+ * starts the transfer on the first DMA device that supports
+ * DMA_SUPPORTS_MEM_TO_MEM. Devices which only provide a synchronous
+ * transfer() method complete the transfer before this returns. The
+ * destination is invalidated from the data cache when the transfer is
+ * found to be complete.
+ *
+ * The CPU is never used to do the work: if this fails, the caller should
+ * do the transfer itself (see dma_memmove() for a helper which does this).
+ *
+ * @desc: Transfer to start
+ * @return 0 if started, -ENODEV if there is no suitable DMA device, -EBUSY
+ *	if the device cannot accept another transfer, -EINVAL if a segment
+ *	overlaps itself or its destination is not cache-line aligned, or
+ *	other -ve error code
+ */
+int dma_async_submit(struct dma_async_desc *desc);
+
+/**
+ * dma_async_poll() - Check whether a transfer has finished
+ *
+ * @desc: Transfer previously started by dma_async_submit()
+ * @return 0 if complete, -EINPROGRESS if still running, or other -ve error
+ *	code if the transfer failed
+ */
+int dma_async_poll(struct dma_async_desc *desc);
+
+/**
+ * dma_async_wait() - Wait for a transfer to finish
+ *
+ * @desc: Transfer previously started by dma_async_submit()
+ * @return 0 if complete, -ETIMEDOUT if the device did not finish in time,
+ *	or other -ve error code if the transfer failed
+ */
+int dma_async_wait(struct dma_async_desc *desc);
+
+/**
+ * dma_memmove() - Copy memory, using DMA if possible
+ *
+ * This copies using dma_async_submit() and dma_async_wait() if a DMA
+ * device is available, and falls back to memmove() otherwise, e.g. if the
+ * regions overlap or the destination is not cache-line aligned.
+ *
+ * @dst: Destination address
+ * @src: Source address
+ * @len: Number of bytes to copy
+ * @return 0 if OK, -ve error code if the DMA transfer failed
+ */
+int dma_memmove(void *dst, const void *src, size_t len);
+#endif /* DMA_ASYNC */
+
 #endif	/* _DMA_H_ */
@@ -677,6 +677,71 @@ const char *fdtdec_get_compatible(enum fdt_compat_id id);
  */
 int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name);
 
+/**
+ * struct fdtdec_phandle_cache - phandle to node-offset map for a flat tree
+ *
+ * This is built the first time a phandle is looked up in a blob and is
+ * keyed on the blob address and the size of its structure and strings
+ * blocks, so that any change to the tree (other than an in-place property
+ * update) drops the cache.
+ *
+ * @blob:		Blob the cache was built for
+ * @size_dt_struct:	Size of the structure block when the cache was built
+ * @size_dt_strings:	Size of the strings block when the cache was built
+ * @max_phandle:	Highest phandle in the cache
+ * @size:		Number of entries allocated in @offset
+ * @offset:		Node offset for each phandle, -1 if unused
+ * @hits:		Number of lookups resolved from the cache
+ * @misses:		Number of lookups which fell back to scanning the tree
+ * @builds:		Number of times the cache has been (re)built
+ */
+struct fdtdec_phandle_cache {
+	const void *blob;
+	uint size_dt_struct;
+	uint size_dt_strings;
+	uint max_phandle;
+	uint size;
+	int *offset;
+	uint hits;
+	uint misses;
+	uint builds;
+};
+
+/**
+ * fdtdec_node_offset_by_phandle() - Find a node given its phandle
+ *
+ * This is equivalent to fdt_node_offset_by_phandle() but, with
+ * CONFIG_OF_PHANDLE_CACHE enabled, uses a cache to avoid walking the whole
+ * tree on every call. The result is checked against the tree before being
+ * returned, so a stale cache is rebuilt rather than producing a wrong answer.
+ *
+ * @blob:	FDT blob
+ * @phandle:	phandle to look up
+ * @return node offset if found, -ve FDT_ERR_... on error
+ */
+int fdtdec_node_offset_by_phandle(const void *blob, uint phandle);
+
+/**
+ * fdtdec_phandle_cache_build() - Build the phandle cache for a blob
+ *
+ * This replaces any existing cache. It is not normally necessary to call
+ * this, since the cache is built on first use.
+ *
+ * @blob:	FDT blob
+ * @return 0 if OK, -ENOMEM if out of memory, -ENOSPC if the phandles in the
+ *	tree are too sparse to cache, -EINVAL if the blob is invalid
+ */
+int fdtdec_phandle_cache_build(const void *blob);
+
+/**
+ * fdtdec_phandle_cache_invalidate() - Drop the phandle cache
+ *
+ * This should be called after modifying a blob in a way that moves nodes
+ * without changing the size of the blob, e.g. when replacing it at the same
+ * address.
+ */
+void fdtdec_phandle_cache_invalidate(void);
+
 /**
  * Look up a property in a node and return its contents in an integer
  * array of given length. The property must have at least enough data for
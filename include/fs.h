@@ -85,6 +85,22 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+/*
+ * fs_read_gunzip - Read and uncompress a gzipped file from the partition
+ * previously set by fs_set_blk_dev()
+ *
+ * The file is read a chunk at a time and each chunk is uncompressed as soon
+ * as it is read, so the compressed file does not need to fit in memory.
+ *
+ * @filename: Name of file to read from
+ * @addr: The address to uncompress into
+ * @maxsize: Maximum number of bytes to write at @addr
+ * @actread: Returns the number of bytes uncompressed
+ * @return 0 if ok with valid *actread, -ve on error conditions
+ */
+int fs_read_gunzip(const char *filename, ulong addr, loff_t maxsize,
+		   loff_t *actread);
+
 /*
  * fs_write - Write file to the partition previously set by fs_set_blk_dev()
  * Note that not all filesystem types support offset!=0.
@@ -181,6 +197,8 @@ int do_size(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
 int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
+int do_loadz(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+	     int fstype);
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
 int file_exists(const char *dev_type, const char *dev_part, const char *file,
@@ -37,6 +37,8 @@ struct fdt_region;
 
 #define IMAGE_ENABLE_IGNORE	0
 #define IMAGE_INDENT_STRING	""
+#define IMAGE_ENABLE_HASH_JOBS	1
+#define IMAGE_ENABLE_HANDOFF	0
 
 #else
 
@@ -48,6 +50,21 @@ struct fdt_region;
 #define IMAGE_ENABLE_IGNORE	1
 #define IMAGE_INDENT_STRING	"   "
 
+/*
+ * Calculate the hashes of several images in parallel on secondary CPUs.
+ * This is not done with hardware hashing, which cannot be shared, nor with a
+ * watchdog, since the hash functions reset it and jobs must not use drivers.
+ */
+#if CONFIG_IS_ENABLED(SMP_JOB) && !defined(CONFIG_SHA_HW_ACCEL) && \
+	!defined(CONFIG_WATCHDOG) && !defined(CONFIG_HW_WATCHDOG)
+#define IMAGE_ENABLE_HASH_JOBS	1
+#else
+#define IMAGE_ENABLE_HASH_JOBS	0
+#endif
+
+/* Skip hashing images which the previous boot phase verified */
+#define IMAGE_ENABLE_HANDOFF	CONFIG_IS_ENABLED(FIT_HANDOFF)
+
 #define IMAGE_ENABLE_FIT	CONFIG_IS_ENABLED(FIT)
 #define IMAGE_ENABLE_OF_LIBFDT	CONFIG_IS_ENABLED(OF_LIBFDT)
 
@@ -706,6 +723,21 @@ int boot_relocate_fdt(struct lmb *lmb, char **of_flat_tree, ulong *of_size);
 
 int boot_ramdisk_high(struct lmb *lmb, ulong rd_data, ulong rd_len,
 		  ulong *initrd_start, ulong *initrd_end);
+
+/**
+ * boot_ramdisk_wait() - Wait for the ramdisk to be relocated
+ *
+ * boot_ramdisk_high() may leave a DMA engine copying the ramdisk in the
+ * background. This waits for the copy to finish and must be called before
+ * the ramdisk is used or the OS is started.
+ */
+#ifdef CONFIG_SYS_BOOT_RAMDISK_HIGH
+void boot_ramdisk_wait(void);
+#else
+static inline void boot_ramdisk_wait(void)
+{
+}
+#endif
 int boot_get_cmdline(struct lmb *lmb, ulong *cmd_start, ulong *cmd_end);
 #ifdef CONFIG_SYS_BOOT_GET_KBD
 int boot_get_kbd(struct lmb *lmb, bd_t **kbd);
@@ -934,6 +966,7 @@ int booti_setup(ulong image, ulong *relocated_addr, ulong *size,
 #define FIT_FPGA_PROP		"fpga"
 #define FIT_FIRMWARE_PROP	"firmware"
 #define FIT_STANDALONE_PROP	"standalone"
+#define FIT_COMPAT_PROP		"compatible"
 
 #define FIT_MAX_HASH_LEN	HASH_MAX_DIGEST_SIZE
 
@@ -1005,15 +1038,34 @@ int fit_image_get_data_and_size(const void *fit, int noffset,
 int fit_image_hash_get_algo(const void *fit, int noffset, char **algo);
 int fit_image_hash_get_value(const void *fit, int noffset, uint8_t **value,
 				int *value_len);
+int fit_image_hash_get_ignore(const void *fit, int noffset, int *ignore);
 
 int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
 
+/**
+ * struct fit_ext_data - Image data which is kept outside a FIT
+ *
+ * This is used while building a FIT with external data, which is not
+ * appended to the FIT until the hashes and signatures have been added.
+ *
+ * @data:	Data for images with a data-offset or data-position property
+ * @size:	Size of @data in bytes
+ * @position:	Position of @data from the start of the FIT file, used for
+ *		images with a data-position property
+ */
+struct fit_ext_data {
+	const void *data;
+	size_t size;
+	int position;
+};
+
 /**
  * fit_add_verification_data() - add verification data to FIT image nodes
  *
  * @keydir:	Directory containing keys
  * @kwydest:	FDT blob to write public key information to
  * @fit:	Pointer to the FIT format image header
+ * @ext:	External image data, or NULL if all data is inside the FIT
  * @comment:	Comment to add to signature nodes
  * @require_keys: Mark all keys as 'required'
  * @engine_id:	Engine to use for signing
@@ -1022,6 +1074,8 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
  * Adds hash values for all component images in the FIT blob.
  * Hashes are calculated for all component images which have hash subnodes
  * with algorithm property set to one of the supported hash algorithms.
+ * The hashes of all images are calculated in parallel, before anything
+ * is signed.
  *
  * Also add signatures if signature nodes are present.
  *
@@ -1030,9 +1084,131 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
  *     libfdt error code, on failure
  */
 int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
+			      const struct fit_ext_data *ext,
 			      const char *comment, int require_keys,
 			      const char *engine_id, const char *cmdname);
 
+#if IMAGE_ENABLE_HASH_JOBS
+/**
+ * fit_hash_jobs_start() - Start calculating the hashes of all images
+ *
+ * The hashes are calculated in parallel, where possible. The results are
+ * used by fit_image_verify() in place of calculating the hashes again, so
+ * this is worthwhile before verifying several images. The FIT must not
+ * change until fit_hash_jobs_finish() is called. Nothing is done if memory
+ * cannot be allocated.
+ *
+ * @fit:	FIT to process
+ * @images_noffset: Offset of the /images node
+ */
+void fit_hash_jobs_start(const void *fit, int images_noffset);
+
+/**
+ * fit_hash_jobs_finish() - Wait for all hash calculations and free them
+ */
+void fit_hash_jobs_finish(void);
+#else
+static inline void fit_hash_jobs_start(const void *fit, int images_noffset)
+{
+}
+
+static inline void fit_hash_jobs_finish(void)
+{
+}
+#endif
+
+/**
+ * struct fit_handoff_hdr - header of the verified-image blob in the bloblist
+ *
+ * Records (struct fit_handoff_rec) follow this header
+ *
+ * @count: Number of records
+ * @chksum: CRC32 of the records, checked before they are used
+ */
+struct fit_handoff_hdr {
+	uint32_t count;
+	uint32_t chksum;
+};
+
+/**
+ * struct fit_handoff_rec - a hash of an image which SPL has verified
+ *
+ * @addr: Address of the image data in memory
+ * @size: Size of the image data in bytes
+ * @value_len: Length of @value in bytes
+ * @algo: Hash algorithm (e.g. "sha256"), nul-terminated
+ * @value: Hash value, which matched the FIT
+ */
+struct fit_handoff_rec {
+	uint64_t addr;
+	uint32_t size;
+	uint32_t value_len;
+	char algo[16];
+	uint8_t value[FIT_MAX_HASH_LEN];
+};
+
+#if IMAGE_ENABLE_HANDOFF
+/**
+ * fit_handoff_save() - Record that an image has been verified
+ *
+ * This adds a record for each hash of the image, so that the next boot phase
+ * need not calculate the hashes again. Only call this once the image has been
+ * verified, after it has been copied to @addr.
+ *
+ * @fit:	FIT containing the image
+ * @image_noffset: Offset of the image node
+ * @addr:	Address of the verified image data
+ * @size:	Size of the verified image data in bytes
+ * @return 0 if OK, -ENOSPC if there is not enough space, other -ve on other
+ *	error (e.g. -ENOENT if there is no bloblist)
+ */
+int fit_handoff_save(const void *fit, int image_noffset, ulong addr,
+		     ulong size);
+
+/**
+ * fit_handoff_find() - Check if image data has already been verified
+ *
+ * @addr:	Address of the image data
+ * @size:	Size of the image data in bytes
+ * @algo:	Hash algorithm
+ * @value:	Hash value which the data is expected to have
+ * @value_len:	Length of @value in bytes
+ * @return true if a previous boot phase verified that the data at @addr has
+ *	this hash, false if not, or if the records are corrupted
+ */
+bool fit_handoff_find(ulong addr, ulong size, const char *algo,
+		      const uint8_t *value, int value_len);
+
+/**
+ * fit_handoff_use() - Use the record that image data has been verified
+ *
+ * This is the same as fit_handoff_find() except that a matching record is
+ * removed, so the next check calculates the hash.
+ *
+ * Parameters and return value are as for fit_handoff_find()
+ */
+bool fit_handoff_use(ulong addr, ulong size, const char *algo,
+		     const uint8_t *value, int value_len);
+#else
+static inline int fit_handoff_save(const void *fit, int image_noffset,
+				   ulong addr, ulong size)
+{
+	return 0;
+}
+
+static inline bool fit_handoff_find(ulong addr, ulong size, const char *algo,
+				    const uint8_t *value, int value_len)
+{
+	return false;
+}
+
+static inline bool fit_handoff_use(ulong addr, ulong size, const char *algo,
+				   const uint8_t *value, int value_len)
+{
+	return false;
+}
+#endif
+
 int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       const void *data, size_t size);
 int fit_image_verify(const void *fit, int noffset);
@@ -1122,6 +1298,24 @@ struct image_region {
 	int size;
 };
 
+#if IMAGE_ENABLE_HANDOFF
+/**
+ * fit_handoff_invalidate() - Forget verified images in a region of memory
+ *
+ * Call this when loading data into memory, since the data may overwrite an
+ * image which the previous boot phase verified.
+ *
+ * @addr:	Start of the region
+ * @size:	Size of the region in bytes, or 0 if not known, meaning all
+ *		memory from @addr onwards
+ */
+void fit_handoff_invalidate(ulong addr, ulong size);
+#else
+static inline void fit_handoff_invalidate(ulong addr, ulong size)
+{
+}
+#endif
+
 #if IMAGE_ENABLE_FIT
 
 #if IMAGE_ENABLE_VERIFY
@@ -12,6 +12,9 @@
 
 #define MAX_LMB_REGIONS 8
 
+/* Pass as max_addr to lmb_alloc_base() to allocate at any address */
+#define LMB_ALLOC_ANYWHERE	0
+
 struct lmb_property {
 	phys_addr_t base;
 	phys_size_t size;
@@ -31,6 +34,18 @@ struct lmb {
 extern struct lmb lmb;
 
 extern void lmb_init(struct lmb *lmb);
+
+/**
+ * lmb_init_and_reserve() - Set up an lmb with memory which is free to use
+ *
+ * This adds a memory region and reserves the parts of it which are in use,
+ * by calling arch_lmb_reserve() and board_lmb_reserve().
+ *
+ * @lmb:	lmb to set up
+ * @base:	Base address of memory
+ * @size:	Size of memory in bytes
+ */
+void lmb_init_and_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 extern long lmb_add(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 extern long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 extern phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align);
@@ -39,6 +54,16 @@ extern phys_addr_t lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align
 extern phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align,
 			      phys_addr_t max_addr);
 extern int lmb_is_reserved(struct lmb *lmb, phys_addr_t addr);
+
+/**
+ * lmb_get_free_size() - Get the amount of free memory at an address
+ *
+ * @lmb:	lmb to check
+ * @addr:	Address to check
+ * @return number of bytes from @addr to the next reserved region or the end
+ *	of its memory region, or 0 if @addr is reserved or not in memory
+ */
+phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr);
 extern long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 
 extern void lmb_dump_all(struct lmb *lmb);
@@ -402,4 +402,145 @@ static inline int log_init(void)
 }
 #endif
 
+/**
+ * log_dispatch() - Send a log record to all log devices for processing
+ *
+ * The log record is sent to each log device in turn, skipping those which have
+ * filters which block the record
+ *
+ * @rec: Log record to dispatch
+ * @return 0 (meaning success)
+ */
+int log_dispatch(struct log_rec *rec);
+
+/* Magic number at the start of the log ring ('ULOG') */
+#define LOG_RING_MAGIC		0x474f4c55
+
+/* Records in the log ring are aligned to this many bytes */
+#define LOG_RING_ALIGN		8
+
+/**
+ * struct log_ring_hdr - Header at the start of the in-memory log ring
+ *
+ * The ring holds binary log records (struct log_ring_rec) so that they can be
+ * formatted and output later, or examined by the OS after U-Boot has finished.
+ * Offsets are free-running and are taken modulo @size to find a record. A
+ * record never wraps around the end of the ring: a padding record fills any
+ * space left at the end.
+ *
+ * The ring is only written by the boot CPU. A record is complete once @head
+ * has moved past it.
+ *
+ * @magic: LOG_RING_MAGIC
+ * @hdr_size: Size of this header in bytes
+ * @size: Number of bytes available for records, after this header
+ * @head: Offset at which the next record will be written
+ * @tail: Offset of the oldest record still in the ring
+ * @emit: Offset of the oldest record not yet passed to the log drivers
+ * @seq: Sequence number for the next record
+ * @drop_count: Number of records dropped because there was no space
+ */
+struct log_ring_hdr {
+	u32 magic;
+	u32 hdr_size;
+	u32 size;
+	u32 head;
+	u32 tail;
+	u32 emit;
+	u32 seq;
+	u32 drop_count;
+};
+
+/* Flags for struct log_ring_rec */
+enum log_ring_rec_flags {
+	LOGRF_PAD	= 1 << 0,	/* Padding to the end of the ring */
+};
+
+/**
+ * struct log_ring_rec - A log record stored in the log ring
+ *
+ * @size: Total size of the record including this header, aligned to
+ *	LOG_RING_ALIGN
+ * @cat: Category (enum log_category_t)
+ * @level: Level (enum log_level_t)
+ * @flags: Record flags (enum log_ring_rec_flags)
+ * @msg_len: Length of the message, excluding the terminator
+ * @line: Line number where the record was generated
+ * @seq: Sequence number, which increments with each record
+ * @time_us: Time at which the record was generated, in microseconds
+ * @file: Address of the file name (only valid within U-Boot)
+ * @func: Address of the function name (only valid within U-Boot)
+ * @msg: Log message, nul-terminated
+ */
+struct log_ring_rec {
+	u16 size;
+	u16 cat;
+	u8 level;
+	u8 flags;
+	u16 msg_len;
+	u32 line;
+	u32 seq;
+	u64 time_us;
+	u64 file;
+	u64 func;
+	char msg[];
+};
+
+#if CONFIG_IS_ENABLED(LOG_RING)
+/**
+ * log_ring_init() - Set up the in-memory log ring
+ *
+ * The ring is placed in the bloblist if available, else it is allocated.
+ *
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int log_ring_init(void);
+
+/**
+ * log_ring_add() - Add a record to the log ring
+ *
+ * If the ring is full the oldest records are discarded, after first passing
+ * them to the log drivers if they have not been output yet.
+ *
+ * @rec: Record to add
+ * @return 0 if OK, -ENOSPC if the record was dropped
+ */
+int log_ring_add(struct log_rec *rec);
+
+/**
+ * log_flush() - Pass any deferred log records to the log drivers
+ */
+void log_flush(void);
+
+/**
+ * log_ring_dump() - Show all records in the log ring on the console
+ *
+ * This shows the records which have already been output as well as those
+ * which are pending. Afterwards there are no records pending.
+ *
+ * @return number of records shown
+ */
+int log_ring_dump(void);
+
+/**
+ * log_ring_fdt_fixup() - Tell the OS where to find the log ring
+ *
+ * This reserves the memory used by the ring and adds its address and size to
+ * the /chosen node as 'u-boot,log-ring'.
+ *
+ * @blob: Device tree to update
+ * @return 0 if OK, -ve on error
+ */
+int log_ring_fdt_fixup(void *blob);
+#else
+static inline void log_flush(void)
+{
+}
+
+static inline int log_ring_fdt_fixup(void *blob)
+{
+	return 0;
+}
+#endif
+
 #endif
@@ -958,6 +958,108 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/* Largest request which is handled by the slab allocator */
+#define MALLOC_SLAB_MAX		512
+
+/**
+ * struct malloc_slab_stats - Statistics for a slab size class
+ *
+ * @obj_size:	Size of each object in this class
+ * @pages:	Number of pages currently holding objects of this class
+ * @allocs:	Number of objects allocated
+ * @frees:	Number of objects freed
+ * @in_use:	Number of objects currently allocated
+ * @misses:	Number of requests passed to dlmalloc as the slab area was full
+ */
+struct malloc_slab_stats {
+	uint obj_size;
+	uint pages;
+	ulong allocs;
+	ulong frees;
+	ulong in_use;
+	ulong misses;
+};
+
+/**
+ * malloc_slab_alloc() - Allocate a small object from the slab area
+ *
+ * The slab area is allocated from the dlmalloc() heap on first use.
+ *
+ * @bytes:	Number of bytes to allocate, must be <= MALLOC_SLAB_MAX
+ * @return pointer to the object, or NULL if the slab allocator cannot handle
+ *	the request, in which case dlmalloc() should be used
+ */
+void *malloc_slab_alloc(size_t bytes);
+
+/**
+ * malloc_slab_free() - Free an object if it was allocated from the slab area
+ *
+ * @mem:	Pointer to object
+ * @return true if the object was freed, false if it does not belong to the
+ *	slab area
+ */
+bool malloc_slab_free(void *mem);
+
+/**
+ * malloc_slab_owns() - Check whether an object is in the slab area
+ *
+ * @mem:	Pointer to check
+ * @return true if @mem was allocated by malloc_slab_alloc()
+ */
+bool malloc_slab_owns(const void *mem);
+
+/**
+ * malloc_slab_usable_size() - Get the usable size of a slab object
+ *
+ * @mem:	Pointer to object, which must be in the slab area
+ * @return number of bytes which can be used
+ */
+size_t malloc_slab_usable_size(const void *mem);
+
+/**
+ * malloc_slab_get_usage() - Get the memory used by the slab area
+ *
+ * This allows mallinfo() to report the objects in use rather than the whole
+ * slab area, so that leak checks still work.
+ *
+ * @reservedp:	Returns the number of bytes taken from the heap for the area
+ * @in_usep:	Returns the number of bytes in allocated objects
+ */
+void malloc_slab_get_usage(ulong *reservedp, ulong *in_usep);
+
+/**
+ * malloc_slab_get_stats() - Get statistics for a size class
+ *
+ * @bytes:	Request size, used to select the size class
+ * @stats:	Returns the statistics
+ * @return 0 if OK, -E2BIG if @bytes is too large for the slab allocator
+ */
+int malloc_slab_get_stats(size_t bytes, struct malloc_slab_stats *stats);
+
+/**
+ * malloc_slab_enable() - Enable or disable new slab allocations
+ *
+ * Objects which are already in the slab area can still be freed when it is
+ * disabled. This is mostly useful for comparing performance.
+ *
+ * @enable:	true to allocate small objects from the slab area
+ * @return previous setting
+ */
+bool malloc_slab_enable(bool enable);
+
+/**
+ * malloc_slab_print_stats() - Show statistics for each size class
+ */
+void malloc_slab_print_stats(void);
+
+/**
+ * malloc_slab_reset() - Forget the slab area
+ *
+ * This is called when the heap is set up, after which the slab area is
+ * allocated again on first use.
+ */
+void malloc_slab_reset(void);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
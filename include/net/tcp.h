@@ -0,0 +1,166 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Minimal TCP support, enough to receive a stream from a server
+ */
+
+#ifndef __NET_TCP_H__
+#define __NET_TCP_H__
+
+#include <net.h>
+
+/*
+ *	Internet Protocol (IP) + TCP header.
+ */
+struct ip_tcp_hdr {
+	u8		ip_hl_v;	/* header length and version	*/
+	u8		ip_tos;		/* type of service		*/
+	u16		ip_len;		/* total length			*/
+	u16		ip_id;		/* identification		*/
+	u16		ip_off;		/* fragment offset field	*/
+	u8		ip_ttl;		/* time to live			*/
+	u8		ip_p;		/* protocol			*/
+	u16		ip_sum;		/* checksum			*/
+	struct in_addr	ip_src;		/* Source IP address		*/
+	struct in_addr	ip_dst;		/* Destination IP address	*/
+	u16		tcp_src;	/* TCP source port		*/
+	u16		tcp_dst;	/* TCP destination port		*/
+	u32		tcp_seq;	/* TCP sequence number		*/
+	u32		tcp_ack;	/* TCP acknowledgment number	*/
+	u8		tcp_hlen;	/* 4 bits header length		*/
+	u8		tcp_flags;	/* TCP flags			*/
+	u16		tcp_win;	/* TCP window size		*/
+	u16		tcp_xsum;	/* Checksum			*/
+	u16		tcp_urg;	/* Urgent pointer		*/
+} __attribute__((packed));
+
+#define IP_TCP_HDR_SIZE		(sizeof(struct ip_tcp_hdr))
+#define TCP_HDR_SIZE		(IP_TCP_HDR_SIZE - IP_HDR_SIZE)
+
+/* TCP flags, as passed in the 'action' argument of net_send_ip_packet() */
+#define TCP_FIN		0x01
+#define TCP_SYN		0x02
+#define TCP_RST		0x04
+#define TCP_PUSH	0x08
+#define TCP_ACK		0x10
+
+/* TCP options */
+#define TCP_O_END	0
+#define TCP_O_NOP	1
+#define TCP_O_MSS	2
+#define TCP_O_SCL	3
+
+/* Largest segment we accept: a 1500-byte IP packet less the headers */
+#define TCP_MSS		1460
+
+/*
+ * Receive window. Data is written straight to its final location, so the
+ * window is not limited by buffering; it only bounds how far ahead of a
+ * missing segment we will accept data.
+ */
+#define TCP_WND_SHIFT	7
+#define TCP_RCV_WND	(64 * TCP_MSS)
+
+/* Number of out-of-order ranges that can be held while waiting for a hole */
+#define TCP_OOO_RANGES	8
+
+enum tcp_state {
+	TCP_CLOSED,
+	TCP_SYN_SENT,
+	TCP_ESTABLISHED,
+	TCP_CLOSE_WAIT,		/* peer has closed; we have sent our FIN */
+	TCP_FIN_WAIT,		/* we have closed; waiting for the peer */
+};
+
+/**
+ * rxhand_tcp_f() - Handler for data received on a TCP connection
+ *
+ * This is called for each new segment of data, which may arrive out of
+ * order. It is also called with @len == 0 when the connection state
+ * changes; use tcp_get_state() to find out the new state.
+ *
+ * @pkt:	Data received
+ * @offset:	Offset of the data from the start of the stream
+ * @len:	Number of bytes of data
+ * @return 0 if the data was used, -ve to drop it; it is then not
+ *	acknowledged, so the peer sends it again later
+ */
+typedef int rxhand_tcp_f(uchar *pkt, u32 offset, u32 len);
+
+/**
+ * tcp_set_tcp_handler() - Set the handler for received data
+ *
+ * @f:	Handler to call, or NULL to ignore received data
+ */
+void tcp_set_tcp_handler(rxhand_tcp_f *f);
+
+/**
+ * tcp_connect() - Open a connection to a server
+ *
+ * This sends a SYN and returns. The handler is called once the connection
+ * is established, or when it fails. Retransmission is handled using the
+ * network-loop timeout handler, so the caller must not change that while
+ * the connection is open.
+ *
+ * @dest:	Server IP address
+ * @dport:	Server TCP port
+ * @return 0 if OK, -ve on error
+ */
+int tcp_connect(struct in_addr dest, u16 dport);
+
+/**
+ * tcp_send() - Send data on an established connection
+ *
+ * Only a single segment is supported, and it must be acknowledged before
+ * another can be sent.
+ *
+ * @data:	Data to send
+ * @len:	Number of bytes, at most TCP_MSS
+ * @return 0 if OK, -EBUSY if data is still unacknowledged, -ENOTCONN if
+ *	not connected, -E2BIG if @len is too large
+ */
+int tcp_send(const void *data, int len);
+
+/**
+ * tcp_close() - Close the connection
+ *
+ * This sends a FIN if one has not been sent already.
+ */
+void tcp_close(void);
+
+/**
+ * tcp_get_state() - Get the current connection state
+ *
+ * @return current state
+ */
+enum tcp_state tcp_get_state(void);
+
+/**
+ * tcp_receive() - Process a received TCP packet
+ *
+ * This is called by net_process_received_packet().
+ *
+ * @ip:		IP/TCP packet received
+ * @len:	Length of the IP packet
+ */
+void tcp_receive(struct ip_tcp_hdr *ip, int len);
+
+/**
+ * tcp_set_tcp_header() - Set up the IP and TCP headers for a packet
+ *
+ * The payload must already be in place at @pkt + IP_TCP_HDR_SIZE. SYN
+ * packets carry options instead of a payload.
+ *
+ * @pkt:	Start of the IP header
+ * @dest:	Destination IP address
+ * @dport:	Destination port
+ * @sport:	Source port
+ * @payload_len: Number of bytes of payload
+ * @action:	TCP flags to send
+ * @seq:	Sequence number
+ * @ack:	Acknowledgment number
+ * @return size of the IP and TCP headers
+ */
+int tcp_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 action, u32 seq, u32 ack);
+
+#endif /* __NET_TCP_H__ */
@@ -154,6 +154,43 @@ void *os_realloc(void *ptr, size_t length);
  */
 void os_usleep(unsigned long usec);
 
+/**
+ * os_thread_create() - Start a host thread
+ *
+ * The thread runs in parallel with U-Boot, so @func must not use any
+ * U-Boot state which is not safe for concurrent access.
+ *
+ * @func:	Function to run in the new thread
+ * @arg:	Argument to pass to @func
+ * @return handle for the thread, or NULL on error
+ */
+void *os_thread_create(void (*func)(void *arg), void *arg);
+
+/**
+ * os_thread_join() - Wait for a host thread to finish
+ *
+ * @handle:	Handle returned by os_thread_create(), which is then freed
+ */
+void os_thread_join(void *handle);
+
+/**
+ * os_prof_start() - Start a timer signal for the sampling profiler
+ *
+ * The timer counts the CPU time used by the process. The signal handler
+ * passes the program counter at the time of the signal to @func, which must
+ * be safe to call from a signal handler.
+ *
+ * @hz:		Number of signals for each second of CPU time
+ * @func:	Function to call for each signal
+ * @return 0 if OK, -ve on error
+ */
+int os_prof_start(unsigned int hz, void (*func)(unsigned long pc));
+
+/**
+ * os_prof_stop() - Stop the timer signal for the sampling profiler
+ */
+void os_prof_stop(void);
+
 /**
  * Gets a monotonic increasing number of nano seconds from the OS
  *
@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ *
+ * A periodic timer interrupt records the program counter in a histogram
+ * which covers the U-Boot image. Unlike function tracing this needs no
+ * compiler instrumentation, so it can be used on production builds. The
+ * histogram can be shown on the console, or written to memory in the trace
+ * output format and decoded on the host with 'proftool dump-prof'.
+ */
+
+#ifndef __PROF_H
+#define __PROF_H
+
+#include <trace.h>
+
+/* Default sampling rate for 'prof start' */
+#define PROF_DEFAULT_HZ		1000
+
+#if CONFIG_IS_ENABLED(PROF)
+
+/**
+ * prof_start() - Start sampling the program counter
+ *
+ * Any previous samples are discarded.
+ *
+ * @hz:		Number of samples to take each second
+ * @return 0 if OK, -ENOMEM if there is no memory for the histogram, -EBUSY if
+ *	the profiler is already running, other -ve value if the timer
+ *	interrupt could not be set up
+ */
+int prof_start(uint hz);
+
+/**
+ * prof_stop() - Stop sampling the program counter
+ *
+ * The samples are kept until the profiler is started again. This does
+ * nothing if the profiler is not running.
+ */
+void prof_stop(void);
+
+/**
+ * prof_sample() - Record a sample
+ *
+ * This is called from the timer interrupt.
+ *
+ * @pc:		Program counter at the time of the interrupt
+ */
+void prof_sample(ulong pc);
+
+/**
+ * prof_get_stats() - Get the number of samples taken
+ *
+ * @samplesp:	Returns the number of samples in the histogram
+ * @outsidep:	Returns the number of samples outside the U-Boot image
+ */
+void prof_get_stats(ulong *samplesp, ulong *outsidep);
+
+/**
+ * prof_list_samples() - Write the histogram to a buffer
+ *
+ * This writes a struct trace_output_hdr of type TRACE_CHUNK_SAMPLES followed
+ * by a struct trace_output_func for each non-empty bucket. The offset is
+ * relative to the start of the U-Boot text and the call count holds the
+ * number of samples.
+ *
+ * @buff:	Buffer in which to place data
+ * @buff_size:	Size of buffer
+ * @needed:	Returns number of bytes used / needed
+ * @return 0 if ok, -ENOSPC if the buffer is too small
+ */
+int prof_list_samples(void *buff, int buff_size, uint *needed);
+
+/**
+ * prof_print_report() - Show the places which have the most samples
+ *
+ * With CONFIG_KALLSYMS, samples are grouped by function and the function
+ * names are shown. Otherwise each line shows a link-time address.
+ *
+ * @count:	Maximum number of lines to show
+ */
+void prof_print_report(int count);
+
+/**
+ * arch_prof_start() - Start the periodic timer interrupt
+ *
+ * The interrupt handler must call prof_sample() with the interrupted program
+ * counter.
+ *
+ * @hz:		Number of interrupts each second
+ * @return 0 if OK, -ve on error
+ */
+int arch_prof_start(uint hz);
+
+/**
+ * arch_prof_stop() - Stop the periodic timer interrupt
+ */
+void arch_prof_stop(void);
+
+#else
+
+static inline void prof_stop(void)
+{
+}
+
+#endif
+
+#endif
@@ -204,6 +204,7 @@
 /* 55-57 reserved */
 
 #define SDHCI_ADMA_ADDRESS	0x58
+#define SDHCI_ADMA_ADDRESS_HI	0x5C
 
 /* 60-FB reserved */
 
@@ -244,6 +245,8 @@
 #define SDHCI_QUIRK_WAIT_SEND_CMD	(1 << 6)
 #define SDHCI_QUIRK_USE_WIDE8		(1 << 8)
 #define SDHCI_QUIRK_NO_1_8_V		(1 << 9)
+/* The driver has checked that ADMA2 works, so it is used if available */
+#define SDHCI_QUIRK_USE_ADMA		(1 << 10)
 
 /*
  * mmc host capabilities
@@ -260,6 +263,47 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/* ADMA2 descriptor attributes */
+#define ADMA_DESC_ATTR_VALID		BIT(0)
+#define ADMA_DESC_ATTR_END		BIT(1)
+#define ADMA_DESC_ATTR_ACT_TRAN		(2 << 4)
+#define ADMA_DESC_TRANSFER_DATA		(ADMA_DESC_ATTR_VALID | \
+					 ADMA_DESC_ATTR_ACT_TRAN)
+
+/* Largest length in one descriptor which keeps the next one word-aligned */
+#define ADMA_MAX_LEN			65532
+
+/* Buffers for ADMA2 must be word-aligned, others use SDMA or PIO */
+#define ADMA_ALIGN			4
+
+#define ADMA_TABLE_NO_ENTRIES		DIV_ROUND_UP( \
+	CONFIG_SYS_MMC_MAX_BLK_COUNT * MMC_MAX_BLOCK_LEN, ADMA_MAX_LEN)
+#define ADMA_TABLE_SZ			(ADMA_TABLE_NO_ENTRIES * \
+					 sizeof(struct sdhci_adma_desc))
+
+/**
+ * struct sdhci_adma_desc - ADMA2 descriptor
+ *
+ * With 64-bit DMA addresses this is the 96-bit form, which the controller
+ * uses when 64-bit ADMA2 is selected
+ *
+ * @attr:	Attributes (ADMA_DESC_ATTR_...)
+ * @reserved:	Must be zero
+ * @len:	Number of bytes to transfer, little-endian
+ * @addr_lo:	Lower 32 bits of the buffer address, little-endian
+ * @addr_hi:	Upper 32 bits of the buffer address, little-endian
+ */
+struct sdhci_adma_desc {
+	u8 attr;
+	u8 reserved;
+	u16 len;
+	u32 addr_lo;
+#ifdef CONFIG_DMA_ADDR_T_64BIT
+	u32 addr_hi;
+#endif
+};
+
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32	(*read_l)(struct sdhci_host *host, int reg);
@@ -297,6 +341,10 @@ struct sdhci_host {
 	uint	voltages;
 
 	struct mmc_config cfg;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	/* Descriptors for ADMA2 transfers, or NULL if it cannot be used */
+	struct sdhci_adma_desc *adma_desc_table;
+#endif
 };
 
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
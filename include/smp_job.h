@@ -0,0 +1,196 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Running jobs on secondary CPUs
+ *
+ * U-Boot normally runs only on the boot CPU. This API allows work which
+ * can be split up (such as hashing several images) to be handed to the
+ * other CPUs in the system. Secondary CPUs are started the first time a
+ * job is queued and are parked again by smp_job_stop(), which is called
+ * before booting an OS.
+ *
+ * Jobs must only do computation on memory: they must not use the console,
+ * malloc(), driver model or any other state which is not protected against
+ * concurrent access. A job may run on any CPU, including the boot CPU, so
+ * the same code works when there are no secondary CPUs available.
+ */
+
+#ifndef __SMP_JOB_H
+#define __SMP_JOB_H
+
+/* Maximum number of jobs which can be queued at once */
+#define SMP_JOB_QUEUE_LEN	32
+
+/* Host tools run jobs in a thread for each host CPU, up to this limit */
+#ifdef USE_HOSTCC
+#define CONFIG_SMP_JOB_MAX_WORKERS	31
+#define SMP_JOB_ENABLED		1
+#else
+#define SMP_JOB_ENABLED		CONFIG_IS_ENABLED(SMP_JOB)
+#endif
+
+/**
+ * struct smp_job - A unit of work to run on any CPU
+ *
+ * @func:	Function to call
+ * @arg:	Argument to pass to @func
+ * @ret:	Return value from @func, valid once the job is done
+ * @done:	true once the job has finished (private to smp_job)
+ */
+struct smp_job {
+	int (*func)(void *arg);
+	void *arg;
+	int ret;
+	int done;
+};
+
+#if SMP_JOB_ENABLED
+
+/**
+ * smp_job_init() - Set up a job ready for queueing
+ *
+ * @job:	Job to set up
+ * @func:	Function to call
+ * @arg:	Argument to pass to @func
+ */
+static inline void smp_job_init(struct smp_job *job, int (*func)(void *arg),
+				void *arg)
+{
+	job->func = func;
+	job->arg = arg;
+	job->ret = 0;
+	job->done = 0;
+}
+
+/**
+ * smp_job_queue() - Queue a job to run on the next available CPU
+ *
+ * This must only be called from the boot CPU. If the queue is full, queued
+ * jobs are run on the boot CPU until there is space. The job must remain
+ * valid until smp_job_wait() has returned.
+ *
+ * @job:	Job to queue, set up with smp_job_init()
+ */
+void smp_job_queue(struct smp_job *job);
+
+/**
+ * smp_job_wait() - Wait for a job to finish
+ *
+ * While waiting, the boot CPU runs any jobs which are still queued.
+ *
+ * @job:	Job to wait for
+ * @return return value of the job's function
+ */
+int smp_job_wait(struct smp_job *job);
+
+/**
+ * smp_job_run() - Run a number of jobs and wait for them to finish
+ *
+ * @jobs:	Array of jobs, set up with smp_job_init()
+ * @count:	Number of jobs
+ * @return 0 if all jobs returned 0, else the first non-zero return value
+ */
+int smp_job_run(struct smp_job *jobs, int count);
+
+/**
+ * smp_job_stop() - Finish all jobs and park the secondary CPUs
+ *
+ * This does nothing if no secondary CPUs were started. They are started
+ * again if another job is queued.
+ */
+void smp_job_stop(void);
+
+/**
+ * smp_job_get_workers() - Get the number of secondary CPUs running jobs
+ *
+ * @return number of secondary CPUs started (0 if none)
+ */
+int smp_job_get_workers(void);
+
+/**
+ * smp_job_worker() - Run jobs on a secondary CPU
+ *
+ * This is called by the architecture code on each secondary CPU that it
+ * starts. It returns when smp_job_stop() is called, after which the CPU
+ * should be parked.
+ *
+ * @worker:	Worker number, from 0
+ */
+void smp_job_worker(int worker);
+
+/**
+ * arch_smp_job_start() - Start secondary CPUs to run jobs
+ *
+ * Each CPU which is started must call smp_job_worker().
+ *
+ * @max_workers: Maximum number of CPUs to start
+ * @return number of CPUs started, or -ve on error
+ */
+int arch_smp_job_start(int max_workers);
+
+/**
+ * arch_smp_job_stop() - Wait for all secondary CPUs to park
+ *
+ * This is called once smp_job_worker() has been told to return on each
+ * secondary CPU.
+ */
+void arch_smp_job_stop(void);
+
+/**
+ * arch_smp_job_idle() - Wait briefly for a job to be queued
+ *
+ * This may return at any time, but should avoid spinning at full speed.
+ */
+void arch_smp_job_idle(void);
+
+/**
+ * arch_smp_job_notify() - Wake up CPUs waiting in arch_smp_job_idle()
+ */
+void arch_smp_job_notify(void);
+
+#else
+
+static inline void smp_job_init(struct smp_job *job, int (*func)(void *arg),
+				void *arg)
+{
+	job->func = func;
+	job->arg = arg;
+	job->done = 0;
+}
+
+static inline void smp_job_queue(struct smp_job *job)
+{
+	job->ret = job->func(job->arg);
+	job->done = 1;
+}
+
+static inline int smp_job_wait(struct smp_job *job)
+{
+	return job->ret;
+}
+
+static inline int smp_job_run(struct smp_job *jobs, int count)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		smp_job_queue(&jobs[i]);
+		if (!ret)
+			ret = jobs[i].ret;
+	}
+
+	return ret;
+}
+
+static inline void smp_job_stop(void)
+{
+}
+
+static inline int smp_job_get_workers(void)
+{
+	return 0;
+}
+
+#endif
+
+#endif
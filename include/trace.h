@@ -28,6 +28,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,	/* Program-counter samples, see prof.h */
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -60,6 +60,23 @@ void sha1_update(sha1_context *ctx, const unsigned char *input,
  */
 void sha1_finish( sha1_context *ctx, unsigned char output[20] );
 
+/**
+ * sha1_process() - Process whole 64-byte blocks of data
+ *
+ * This is weak so that an architecture can supply an accelerated version,
+ * falling back to sha1_generic_process() if it finds that it cannot be used.
+ *
+ * @ctx:	Context to update
+ * @data:	Data to process
+ * @blocks:	Number of 64-byte blocks in @data
+ */
+void sha1_process(sha1_context *ctx, const unsigned char *data,
+		  unsigned int blocks);
+
+/* Portable C version of sha1_process() */
+void sha1_generic_process(sha1_context *ctx, const unsigned char *data,
+			  unsigned int blocks);
+
 /**
  * \brief	   Output = SHA-1( input buffer )
  *
@@ -19,6 +19,23 @@ void sha256_starts(sha256_context * ctx);
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length);
 void sha256_finish(sha256_context * ctx, uint8_t digest[SHA256_SUM_LEN]);
 
+/**
+ * sha256_process() - Process whole 64-byte blocks of data
+ *
+ * This is weak so that an architecture can supply an accelerated version,
+ * falling back to sha256_generic_process() if it finds that it cannot be used.
+ *
+ * @ctx:	Context to update
+ * @data:	Data to process
+ * @blocks:	Number of 64-byte blocks in @data
+ */
+void sha256_process(sha256_context *ctx, const uint8_t *data,
+		    unsigned int blocks);
+
+/* Portable C version of sha256_process() */
+void sha256_generic_process(sha256_context *ctx, const uint8_t *data,
+			    unsigned int blocks);
+
 void sha256_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
@@ -179,8 +179,36 @@ int usb_reset_root_port(struct usb_device *dev);
 #define usb_reset_root_port(dev)
 #endif
 
+/**
+ * struct usb_bulk_xfer - One transfer in a batch sent by usb_bulk_batch()
+ *
+ * @pipe: Bulk pipe to use
+ * @stream: Stream ID to use, or 0 if the endpoint does not use streams
+ *	(see usb_alloc_streams())
+ * @buffer: Data to send, or buffer to receive into
+ * @length: Number of bytes to transfer
+ * @flags: USB_BULK_BARRIER to hold this transfer back until all earlier
+ *	transfers in the batch have completed
+ * @act_len: Returns the number of bytes transferred
+ * @status: Returns the USB_ST_... status, or USB_ST_NOT_PROC if the
+ *	transfer was not carried out
+ */
+struct usb_bulk_xfer {
+	unsigned long pipe;
+	unsigned int stream;
+	void *buffer;
+	int length;
+	int flags;
+	int act_len;
+	unsigned long status;
+};
+
+#define USB_BULK_BARRIER	(1 << 0)
+
 int submit_bulk_msg(struct usb_device *dev, unsigned long pipe,
 			void *buffer, int transfer_len);
+int submit_bulk_batch(struct usb_device *dev, struct usb_bulk_xfer *xfer,
+			int count);
 int submit_control_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 			int transfer_len, struct devrequest *setup);
 int submit_int_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
@@ -261,6 +289,43 @@ int usb_control_msg(struct usb_device *dev, unsigned int pipe,
 			void *data, unsigned short size, int timeout);
 int usb_bulk_msg(struct usb_device *dev, unsigned int pipe,
 			void *data, int len, int *actual_length, int timeout);
+/**
+ * usb_bulk_batch() - Send several bulk messages
+ *
+ * The transfers are carried out in order. If the host controller supports
+ * it, they are all queued on the hardware ahead of time (subject to any
+ * USB_BULK_BARRIER flags), which avoids a software round trip between one
+ * transfer and the next. Processing stops at the first transfer which
+ * fails. A short IN transfer is not a failure.
+ *
+ * @dev:	USB device
+ * @xfer:	Transfers to carry out; the results are written back here
+ * @count:	Number of transfers
+ * @timeout:	Timeout for each transfer in milliseconds, where the
+ *		controller does not have its own
+ * @return 0 if all transfers completed, -ve on error
+ */
+int usb_bulk_batch(struct usb_device *dev, struct usb_bulk_xfer *xfer,
+		   int count, int timeout);
+/**
+ * usb_alloc_streams() - Set up bulk streams on some endpoints
+ *
+ * Streams allow a SuperSpeed device to have several transfers in progress
+ * on one bulk endpoint at once, each identified by its stream ID. Once
+ * they are set up, every transfer on the endpoints must go through
+ * usb_bulk_batch() with a stream ID from 1 up to the value returned.
+ *
+ * @dev:	USB device
+ * @pipes:	Bulk pipes of the endpoints to set up
+ * @num_pipes:	Number of pipes
+ * @num_streams: Number of streams wanted. This must not be more than the
+ *		endpoints support, according to their SuperSpeed endpoint
+ *		companion descriptors
+ * @return number of streams set up (at least 1), -ENOSYS if the device or
+ *	host controller does not support streams, other -ve on error
+ */
+int usb_alloc_streams(struct usb_device *dev, const unsigned long *pipes,
+		      int num_pipes, int num_streams);
 int usb_submit_int_msg(struct usb_device *dev, unsigned long pipe,
 			void *buffer, int transfer_len, int interval);
 int usb_disable_asynch(int disable);
@@ -699,6 +764,35 @@ struct dm_usb_ops {
 	 */
 	int (*bulk)(struct udevice *bus, struct usb_device *udev,
 		    unsigned long pipe, void *buffer, int length);
+	/**
+	 * bulk_batch() - Send several bulk messages
+	 *
+	 * This is optional. It allows the controller to queue transfers on
+	 * the hardware ahead of time, rather than one at a time, while
+	 * honouring USB_BULK_BARRIER. Transfers must complete in order on
+	 * each endpoint (and stream). Processing stops at the first transfer
+	 * which fails, and transfers still queued behind it must be
+	 * discarded.
+	 *
+	 * @xfer: Transfers to carry out
+	 * @count: Number of transfers
+	 * @return 0 if all transfers completed, -ve on error
+	 */
+	int (*bulk_batch)(struct udevice *bus, struct usb_device *udev,
+			  struct usb_bulk_xfer *xfer, int count);
+	/**
+	 * alloc_streams() - Set up bulk streams on some endpoints
+	 *
+	 * This is optional. See usb_alloc_streams() for details.
+	 *
+	 * @pipes: Bulk pipes of the endpoints to set up
+	 * @num_pipes: Number of pipes
+	 * @num_streams: Number of streams wanted
+	 * @return number of streams set up, -ve on error
+	 */
+	int (*alloc_streams)(struct udevice *bus, struct usb_device *udev,
+			     const unsigned long *pipes, int num_pipes,
+			     int num_streams);
 	/**
 	 * interrupt() - Send an interrupt message
 	 *
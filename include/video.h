@@ -17,10 +17,20 @@
 
 #include <stdio_dev.h>
 
+/**
+ * struct video_uc_platdata - uclass platform data for a video device
+ *
+ * @align:	Frame-buffer alignment, set by the driver in bind()
+ * @size:	Frame-buffer size, set by the driver in bind()
+ * @base:	Base address of the frame buffer which is displayed
+ * @shadow_base:	Base address of the shadow frame buffer which U-Boot
+ *		draws into, or 0 if none (see CONFIG_VIDEO_COPY)
+ */
 struct video_uc_platdata {
 	uint align;
 	uint size;
 	ulong base;
+	ulong shadow_base;
 };
 
 enum video_polarity {
@@ -49,17 +59,38 @@ enum video_log2_bpp {
 
 #define VNBITS(bpix)	(1 << (bpix))
 
+/**
+ * struct video_bbox - Rectangle in a frame buffer, in pixels
+ *
+ * The rectangle is empty if @x0 >= @x1
+ *
+ * @x0:	Left edge
+ * @y0:	Top edge
+ * @x1:	Right edge (exclusive)
+ * @y1:	Bottom edge (exclusive)
+ */
+struct video_bbox {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
  * @xsize:	Number of pixel columns (e.g. 1366)
  * @ysize:	Number of pixels rows (e.g.. 768)
+ * @ysize_virt:	Number of pixel rows in the frame buffer, if the driver can
+ *		pan the display with set_yoffset(). Set this to allow scrolling
+ *		by panning, which needs @ysize_virt rows of frame-buffer memory
+ *		in struct video_uc_platdata
  * @rot:	Display rotation (0=none, 1=90 degrees clockwise, etc.)
  * @bpix:	Encoded bits per pixel (enum video_log2_bpp)
  * @vidconsole_drv_name:	Driver to use for the text console, NULL to
  *		select automatically
  * @font_size:	Font size in pixels (0 to use a default value)
- * @fb:		Frame buffer
+ * @fb:		Frame buffer, at the top of the display
  * @fb_size:	Frame buffer size
  * @line_length:	Length of each frame buffer line, in bytes. This can be
  *		set by the driver, but if not, the uclass will set it after
@@ -70,11 +101,20 @@ enum video_log2_bpp {
  *		the LCD is updated
  * @cmap:	Colour map for 8-bit-per-pixel displays
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Area of the frame buffer which has changed since the last sync
+ * @copy_fb:	Frame buffer which is displayed, at the top of the display, if
+ *		@fb is a shadow buffer. This is updated by video_sync(). NULL
+ *		if there is no shadow buffer
+ * @fb_base:	Start of the frame buffer which holds @fb
+ * @copy_base:	Start of the frame buffer which holds @copy_fb
+ * @yoffset:	Number of pixel rows by which the display is panned
+ * @pan:	true to scroll the display by panning
  */
 struct video_priv {
 	/* Things set up by the driver: */
 	ushort xsize;
 	ushort ysize;
+	ushort ysize_virt;
 	ushort rot;
 	enum video_log2_bpp bpix;
 	const char *vidconsole_drv_name;
@@ -92,10 +132,34 @@ struct video_priv {
 	bool flush_dcache;
 	ushort *cmap;
 	u8 fg_col_idx;
+	struct video_bbox damage;
+	void *copy_fb;
+	void *fb_base;
+	void *copy_base;
+	int yoffset;
+	bool pan;
 };
 
-/* Placeholder - there are no video operations at present */
+/**
+ * struct video_ops - Operations for video devices
+ *
+ * All operations are optional.
+ */
 struct video_ops {
+	/**
+	 * set_yoffset() - Pan the display vertically
+	 *
+	 * The display should show the frame buffer starting @yoffset pixel
+	 * rows from its start. The uclass uses this to scroll the display
+	 * without moving the frame-buffer contents, if @ysize_virt is set in
+	 * struct video_priv. It resets the offset to 0 before the device is
+	 * removed.
+	 *
+	 * @dev:	Video device
+	 * @yoffset:	Offset in pixel rows, from 0 to @ysize_virt - @ysize
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_yoffset)(struct udevice *dev, uint yoffset);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -126,12 +190,64 @@ int video_reserve(ulong *addrp);
  */
 int video_clear(struct udevice *dev);
 
+/**
+ * video_damage() - Record that part of the frame buffer has changed
+ *
+ * Anything which writes to the frame buffer must call this, so that
+ * video_sync() knows what to flush. The area is clipped to the display.
+ *
+ * @vid:	Device which was written to
+ * @x:		Left edge of the area, in pixels
+ * @y:		Top edge of the area, in pixels
+ * @width:	Width of the area, in pixels
+ * @height:	Height of the area, in pixels
+ */
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
+/**
+ * video_move_lines() - Move pixel rows within the display
+ *
+ * This works like memmove() on whole rows. If the display can pan and @ydst
+ * is 0, it is scrolled up by @ysrc rows instead, so that the rows below
+ * @count hold what was below the moved rows, with new rows at the bottom
+ * set to the background colour.
+ *
+ * @vid:	Video device
+ * @ydst:	Destination row, in pixels
+ * @ysrc:	Source row, in pixels
+ * @count:	Number of rows to move
+ */
+void video_move_lines(struct udevice *vid, int ydst, int ysrc, int count);
+
+/**
+ * video_set_pan() - Enable or disable scrolling by panning the display
+ *
+ * Panning is enabled when the device is probed, if supported. When it is
+ * disabled the display is moved back to the start of the frame buffer, so
+ * that the frame buffer can be passed to software which does not know
+ * about panning.
+ *
+ * @dev:	Video device
+ * @enable:	true to enable panning, false to disable it
+ * @return 0 if OK, -ENOSYS if the device cannot pan, other -ve on error
+ */
+int video_set_pan(struct udevice *dev, bool enable);
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
  * Some frame buffers are cached or have a secondary frame buffer. This
  * function syncs these up so that the current contents of the U-Boot frame
- * buffer are displayed to the user.
+ * buffer are displayed to the user. With CONFIG_VIDEO_DAMAGE, only the area
+ * recorded by video_damage() is copied from the shadow frame buffer and
+ * flushed from the cache.
  *
  * @dev:	Device to sync
  * @force:	True to force a sync even if there was one recently (this is
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Passing the state of probed devices from one boot phase to the next
+ *
+ * Drivers which discover things about their hardware at some expense (e.g. by
+ * trying bus modes until one works) can record what they found, so that the
+ * next phase can start from there instead of repeating the work. The records
+ * are kept in a single bloblist blob.
+ */
+
+#ifndef __WARM_STATE_H
+#define __WARM_STATE_H
+
+#include <dm/uclass-id.h>
+
+/**
+ * struct warm_state_hdr - header of the warm-state blob
+ *
+ * Records follow this header, each a struct warm_state_rec followed by its
+ * data, padded to a multiple of 4 bytes
+ *
+ * @used: Number of bytes used by records, excluding this header
+ * @count: Number of records
+ */
+struct warm_state_hdr {
+	u32 used;
+	u32 count;
+};
+
+/**
+ * struct warm_state_rec - header of a warm-state record
+ *
+ * @uclass_id: Uclass of the device which owns the record (enum uclass_id)
+ * @size: Size of the data in bytes, excluding this header
+ * @key: Key chosen by the uclass to identify the device, typically its
+ *	sequence number
+ */
+struct warm_state_rec {
+	u16 uclass_id;
+	u16 size;
+	u32 key;
+};
+
+/**
+ * warm_state_save() - Save the state of a device for the next phase
+ *
+ * This adds a new record, or updates the existing one for the same @id and
+ * @key
+ *
+ * @id: Uclass of the device
+ * @key: Key identifying the device within the uclass
+ * @data: Data to save
+ * @size: Size of data in bytes
+ * @return 0 if OK, -ESPIPE if there is an existing record with a different
+ *	size, -ENOSPC if there is not enough space, other -ve on other error
+ *	(e.g. -ENOENT if there is no bloblist)
+ */
+int warm_state_save(enum uclass_id id, u32 key, const void *data, int size);
+
+/**
+ * warm_state_find() - Find the state saved for a device
+ *
+ * The bloblist is moved when U-Boot relocates, so callers should copy the
+ * data rather than holding on to the pointer.
+ *
+ * @id: Uclass of the device
+ * @key: Key identifying the device within the uclass
+ * @size: Expected size of the data in bytes
+ * @return pointer to the data, or NULL if not found or the size does not
+ *	match
+ */
+const void *warm_state_find(enum uclass_id id, u32 key, int size);
+
+/**
+ * warm_state_count() - Get the number of records saved
+ *
+ * @return number of records, or 0 if there is no warm state
+ */
+int warm_state_count(void);
+
+#endif
@@ -660,10 +660,129 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
+#if CONFIG_IS_ENABLED(OF_PHANDLE_CACHE)
+static bool phandle_cache_valid(struct fdtdec_phandle_cache *cache,
+				const void *blob)
+{
+	return cache && cache->blob == blob &&
+		cache->size_dt_struct == fdt_size_dt_struct(blob) &&
+		cache->size_dt_strings == fdt_size_dt_strings(blob);
+}
+
+int fdtdec_phandle_cache_build(const void *blob)
+{
+	struct fdtdec_phandle_cache *cache = gd->phandle_cache;
+	uint max_phandle = 0, count = 0;
+	uint phandle;
+	int offset;
+
+	if (fdt_check_header(blob))
+		return -EINVAL;
+	if (!cache) {
+		cache = calloc(1, sizeof(*cache));
+		if (!cache)
+			return -ENOMEM;
+		gd->phandle_cache = cache;
+	}
+	cache->blob = NULL;
+
+	/* Size the table first so that it can be allocated in one go */
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle && phandle != -1U) {
+			count++;
+			max_phandle = max(max_phandle, phandle);
+		}
+	}
+
+	/*
+	 * dtc allocates phandles sequentially, but overlays and hand-written
+	 * trees may not. Don't waste memory on a mostly empty table.
+	 */
+	if (max_phandle > count * 4 + 32) {
+		debug("%s: phandles too sparse (%u of %u)\n", __func__, count,
+		      max_phandle);
+		max_phandle = 0;
+	} else if (max_phandle >= cache->size) {
+		free(cache->offset);
+		cache->size = 0;
+		cache->offset = malloc((max_phandle + 1) * sizeof(int));
+		if (!cache->offset)
+			return -ENOMEM;
+		cache->size = max_phandle + 1;
+	}
+
+	if (max_phandle) {
+		memset(cache->offset, '\xff', (max_phandle + 1) * sizeof(int));
+		for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+		     offset = fdt_next_node(blob, offset, NULL)) {
+			phandle = fdt_get_phandle(blob, offset);
+			if (phandle && phandle <= max_phandle)
+				cache->offset[phandle] = offset;
+		}
+	}
+
+	/* A sparse tree still records the blob, so we don't retry each time */
+	cache->blob = blob;
+	cache->size_dt_struct = fdt_size_dt_struct(blob);
+	cache->size_dt_strings = fdt_size_dt_strings(blob);
+	cache->max_phandle = max_phandle;
+	cache->builds++;
+
+	return count && !max_phandle ? -ENOSPC : 0;
+}
+
+void fdtdec_phandle_cache_invalidate(void)
+{
+	if (gd->phandle_cache)
+		gd->phandle_cache->blob = NULL;
+}
+
+int fdtdec_node_offset_by_phandle(const void *blob, uint phandle)
+{
+	struct fdtdec_phandle_cache *cache = gd->phandle_cache;
+	int offset;
+
+	if (!phandle || phandle == -1U)
+		return -FDT_ERR_BADPHANDLE;
+
+	if (!phandle_cache_valid(cache, blob)) {
+		int ret = fdtdec_phandle_cache_build(blob);
+
+		if (ret && ret != -ENOSPC)
+			return fdt_node_offset_by_phandle(blob, phandle);
+		cache = gd->phandle_cache;
+	}
+
+	if (phandle <= cache->max_phandle) {
+		offset = cache->offset[phandle];
+		if (offset >= 0 && fdt_get_phandle(blob, offset) == phandle) {
+			cache->hits++;
+			return offset;
+		}
+	}
+
+	cache->misses++;
+	offset = fdt_node_offset_by_phandle(blob, phandle);
+
+	/* The tree was changed in place, so the cache is out of date */
+	if (offset >= 0 && phandle <= cache->max_phandle)
+		fdtdec_phandle_cache_invalidate();
+
+	return offset;
+}
+#else
+int fdtdec_node_offset_by_phandle(const void *blob, uint phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+#endif
+
 /**
  * Look up a property in a node and check that it has a minimum length.
  *
@@ -791,8 +910,8 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
-								  phandle);
+				node = fdtdec_node_offset_by_phandle(blob,
+								     phandle);
 				if (!node) {
 					debug("%s: could not find phandle\n",
 					      fdt_get_name(blob, src_node,
@@ -79,6 +79,51 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+int gunzip_stream(void *dst, ulong dstlen,
+		  int (*read)(void *priv, void *buf, int size), void *priv,
+		  void *buf, int bufsize, ulong *lenp)
+{
+	z_stream s;
+	int err = 0;
+	int ret;
+	int r;
+
+	memset(&s, '\0', sizeof(s));
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+
+	/* Let zlib parse the gzip header and check the trailer */
+	r = inflateInit2(&s, 16 + MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		return -1;
+	}
+	s.next_out = dst;
+	s.avail_out = min_t(ulong, dstlen, UINT_MAX);
+	do {
+		if (!s.avail_in) {
+			ret = read(priv, buf, bufsize);
+			if (ret <= 0) {
+				if (!ret)
+					puts("Error: gunzip out of data\n");
+				err = -1;
+				break;
+			}
+			s.next_in = buf;
+			s.avail_in = ret;
+		}
+		r = inflate(&s, Z_NO_FLUSH);
+		if (r != Z_OK && r != Z_STREAM_END) {
+			printf("Error: inflate() returned %d\n", r);
+			err = -1;
+		}
+	} while (r == Z_OK);
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+
+	return err;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(u64 expectedsize)
@@ -9,8 +9,6 @@
 #include <common.h>
 #include <lmb.h>
 
-#define LMB_ALLOC_ANYWHERE	0
-
 void lmb_dump_all(struct lmb *lmb)
 {
 #ifdef DEBUG
@@ -104,6 +102,14 @@ void lmb_init(struct lmb *lmb)
 	lmb->reserved.size = 0;
 }
 
+void lmb_init_and_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size)
+{
+	lmb_init(lmb);
+	lmb_add(lmb, base, size);
+	arch_lmb_reserve(lmb);
+	board_lmb_reserve(lmb);
+}
+
 /* This routine called with relocation disabled. */
 static long lmb_add_region(struct lmb_region *rgn, phys_addr_t base, phys_size_t size)
 {
@@ -321,6 +327,29 @@ phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phy
 	return 0;
 }
 
+phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
+{
+	phys_size_t size;
+	long i;
+
+	i = lmb_overlaps_region(&lmb->memory, addr, 1);
+	if (i < 0)
+		return 0;
+	size = lmb->memory.region[i].base + lmb->memory.region[i].size - addr;
+
+	/* Reserved regions are sorted, so the first one above addr is next */
+	for (i = 0; i < lmb->reserved.cnt; i++) {
+		phys_addr_t base = lmb->reserved.region[i].base;
+
+		if (addr < base)
+			return min(size, (phys_size_t)(base - addr));
+		if (addr < base + lmb->reserved.region[i].size)
+			return 0;
+	}
+
+	return size;
+}
+
 int lmb_is_reserved(struct lmb *lmb, phys_addr_t addr)
 {
 	int i;
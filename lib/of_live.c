@@ -35,13 +35,15 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
  * @dad: Parent struct device_node
  * @nodepp: The device_node tree created by the call
  * @fpsize: Size of the node path up at t05he current depth.
+ * @names: Table to use for interning property names
  * @dryrun: If true, do not allocate device nodes but still calculate needed
  * memory size
  */
 static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 			       struct device_node *dad,
 			       struct device_node **nodepp,
-			       unsigned long fpsize, bool dryrun)
+			       unsigned long fpsize, struct of_strtab *names,
+			       bool dryrun)
 {
 	const __be32 *p;
 	struct device_node *np;
@@ -161,6 +163,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 			if (strcmp(pname, "ibm,phandle") == 0)
 				np->phandle = be32_to_cpup(p);
 			pp->name = (char *)pname;
+			pp->id = of_strtab_add(names, pname);
 			pp->length = sz;
 			pp->value = (__be32 *)p;
 			*prev_pp = pp;
@@ -189,6 +192,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 					__alignof__(struct property));
 		if (!dryrun) {
 			pp->name = "name";
+			pp->id = of_strtab_add(names, pp->name);
 			pp->length = sz;
 			pp->value = pp + 1;
 			*prev_pp = pp;
@@ -215,7 +219,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		depth = 0;
 	while (*poffset > 0 && depth > old_depth) {
 		mem = unflatten_dt_node(blob, mem, poffset, np, NULL,
-					fpsize, dryrun);
+					fpsize, names, dryrun);
 		if (!mem)
 			return NULL;
 	}
@@ -247,6 +251,49 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
+/**
+ * count_prop_names() - Count the distinct property-name offsets in a blob
+ *
+ * Properties with the same name normally share a string, so this is a
+ * tight upper bound on the number of distinct property names.
+ *
+ * @blob: The blob to check
+ * @return number of distinct name offsets, or -ve on error
+ */
+static int count_prop_names(const void *blob)
+{
+	int size = fdt_size_dt_strings(blob);
+	const struct fdt_property *prop;
+	int offset, next, count = 0;
+	u8 *seen;
+	u32 tag;
+
+	seen = calloc(1, size / 8 + 1);
+	if (!seen)
+		return -ENOMEM;
+	for (offset = 0; (tag = fdt_next_tag(blob, offset, &next)) != FDT_END;
+	     offset = next) {
+		if (next < 0) {
+			count = -EFAULT;
+			break;
+		}
+		if (tag == FDT_PROP) {
+			uint nameoff;
+
+			prop = fdt_offset_ptr(blob, offset, sizeof(*prop));
+			nameoff = fdt32_to_cpu(prop->nameoff);
+			if (nameoff < size &&
+			    !(seen[nameoff / 8] & BIT(nameoff % 8))) {
+				seen[nameoff / 8] |= BIT(nameoff % 8);
+				count++;
+			}
+		}
+	}
+	free(seen);
+
+	return count;
+}
+
 /**
  * unflatten_device_tree() - create tree of device_nodes from flat blob
  *
@@ -254,16 +301,24 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
  * tree of struct device_node. It also fills the "name" and "type"
  * pointers of the nodes so the normal device-tree walking functions
  * can be used.
+ *
+ * The index of property names is placed in the same allocation, after the
+ * nodes.
+ *
  * @blob: The blob to expand
  * @mynodes: The device_node tree created by the call
+ * @indexp: Returns the index of the tree
  * @return 0 if OK, -ve on error
  */
 static int unflatten_device_tree(const void *blob,
-				 struct device_node **mynodes)
+				 struct device_node **mynodes,
+				 struct of_live_index **indexp)
 {
+	struct of_live_index *index;
 	unsigned long size;
 	int start;
 	void *mem;
+	int names;
 
 	debug(" -> unflatten_device_tree()\n");
 
@@ -285,29 +340,45 @@ static int unflatten_device_tree(const void *blob,
 	/* First pass, scan for size */
 	start = 0;
 	size = (unsigned long)unflatten_dt_node(blob, NULL, &start, NULL, NULL,
-						0, true);
+						0, NULL, true);
 	if (!size)
 		return -EFAULT;
-	size = ALIGN(size, 4);
+	size = ALIGN(size, sizeof(void *));
 
-	debug("  size is %lx, allocating...\n", size);
+	/* Allow for the "name" properties which are created */
+	names = count_prop_names(blob);
+	if (names < 0)
+		return names;
+	names++;
 
-	/* Allocate memory for the expanded device tree */
-	mem = malloc(size + 4);
+	debug("  size is %lx, %d names, allocating...\n", size, names);
+
+	/* Allocate memory for the expanded device tree and its index */
+	mem = malloc(size + sizeof(void *) + sizeof(*index) +
+		     of_strtab_size(names));
+	if (!mem)
+		return -ENOMEM;
 	memset(mem, '\0', size);
 
 	*(__be32 *)(mem + size) = cpu_to_be32(0xdeadbeef);
 
+	index = mem + size + sizeof(void *);
+	memset(index, '\0', sizeof(*index));
+	of_strtab_init(&index->names, index + 1, names, false);
+
 	debug("  unflattening %p...\n", mem);
 
 	/* Second pass, do actual unflattening */
 	start = 0;
-	unflatten_dt_node(blob, mem, &start, NULL, mynodes, 0, false);
+	unflatten_dt_node(blob, mem, &start, NULL, mynodes, 0, &index->names,
+			  false);
 	if (be32_to_cpup(mem + size) != 0xdeadbeef) {
 		debug("End of tree marker overwritten: %08x\n",
 		      be32_to_cpup(mem + size));
 		return -ENOSPC;
 	}
+	index->root = *mynodes;
+	*indexp = index;
 
 	debug(" <- unflatten_device_tree()\n");
 
@@ -316,14 +387,21 @@ static int unflatten_device_tree(const void *blob,
 
 int of_live_build(const void *fdt_blob, struct device_node **rootp)
 {
+	struct of_live_index *index;
 	int ret;
 
 	debug("%s: start\n", __func__);
-	ret = unflatten_device_tree(fdt_blob, rootp);
+	ret = unflatten_device_tree(fdt_blob, rootp, &index);
 	if (ret) {
 		debug("Failed to create live tree: err=%d\n", ret);
 		return ret;
 	}
+	of_live_set_index(index);
+	ret = of_compat_index_build();
+	if (ret && ret != -ENOENT) {
+		debug("Failed to index live tree: err=%d\n", ret);
+		return ret;
+	}
 	ret = of_alias_scan();
 	if (ret) {
 		debug("Failed to scan live tree aliases: err=%d\n", ret);
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * The histogram has one counter for each CONFIG_PROF_GRANULE bytes of the
+ * U-Boot image. Offsets are relative to the start of the text, as with
+ * function tracing, so proftool can match them against System.map.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <prof.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct prof_info - State of the profiler
+ *
+ * @hist:	Histogram of samples, one counter for each bucket
+ * @hist_count:	Number of buckets in @hist
+ * @outside:	Number of samples outside the U-Boot image
+ * @running:	true if the timer interrupt is running
+ */
+static struct prof_info {
+	u32 *hist;
+	ulong hist_count;
+	ulong outside;
+	bool running;
+} prof;
+
+/* An entry in the report, covering a bucket or a whole function */
+struct prof_entry {
+	ulong addr;
+	ulong count;
+	const char *name;
+};
+
+__weak int arch_prof_start(uint hz)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_prof_stop(void)
+{
+}
+
+/* Get the link-time address of the start of the U-Boot text */
+static ulong prof_text_base(void)
+{
+#ifdef CONFIG_SANDBOX
+	return (ulong)&_init;
+#else
+	return CONFIG_SYS_TEXT_BASE;
+#endif
+}
+
+static ulong prof_pc_to_offset(ulong pc)
+{
+#ifdef CONFIG_SANDBOX
+	return pc - (ulong)&_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		return pc - gd->relocaddr;
+	return pc - CONFIG_SYS_TEXT_BASE;
+#endif
+}
+
+void prof_sample(ulong pc)
+{
+	ulong bucket = prof_pc_to_offset(pc) / CONFIG_PROF_GRANULE;
+
+	if (bucket < prof.hist_count)
+		prof.hist[bucket]++;
+	else
+		prof.outside++;
+}
+
+int prof_start(uint hz)
+{
+	ulong count = DIV_ROUND_UP(gd->mon_len, CONFIG_PROF_GRANULE);
+	int ret;
+
+	if (prof.running)
+		return -EBUSY;
+	if (!hz)
+		return -EINVAL;
+	if (prof.hist_count != count) {
+		free(prof.hist);
+		prof.hist_count = 0;
+		prof.hist = calloc(count, sizeof(*prof.hist));
+		if (!prof.hist)
+			return -ENOMEM;
+		prof.hist_count = count;
+	} else {
+		memset(prof.hist, '\0', count * sizeof(*prof.hist));
+	}
+	prof.outside = 0;
+	ret = arch_prof_start(hz);
+	if (ret)
+		return ret;
+	prof.running = true;
+
+	return 0;
+}
+
+void prof_stop(void)
+{
+	if (!prof.running)
+		return;
+	arch_prof_stop();
+	prof.running = false;
+}
+
+void prof_get_stats(ulong *samplesp, ulong *outsidep)
+{
+	ulong samples = 0;
+	ulong i;
+
+	for (i = 0; i < prof.hist_count; i++)
+		samples += prof.hist[i];
+	*samplesp = samples;
+	*outsidep = prof.outside;
+}
+
+int prof_list_samples(void *buff, int buff_size, uint *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	ulong bucket;
+	int upto;
+
+	end = buff ? buff + buff_size : NULL;
+
+	/* Place some header information */
+	if (ptr + sizeof(struct trace_output_hdr) <= end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	/* Add a record for each bucket with samples */
+	for (bucket = upto = 0; bucket < prof.hist_count; bucket++) {
+		if (!prof.hist[bucket])
+			continue;
+
+		if (ptr + sizeof(struct trace_output_func) <= end) {
+			struct trace_output_func *stats = ptr;
+
+			stats->offset = bucket * CONFIG_PROF_GRANULE;
+			stats->call_count = prof.hist[bucket];
+			upto++;
+		}
+		ptr += sizeof(struct trace_output_func);
+	}
+
+	/* Update the header */
+	if (output_hdr) {
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+	}
+
+	/* Work out how much of the buffer we used */
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -ENOSPC;
+
+	return 0;
+}
+
+static int h_cmp_count(const void *v1, const void *v2)
+{
+	const struct prof_entry *e1 = v1, *e2 = v2;
+
+	if (e1->count != e2->count)
+		return e1->count < e2->count ? 1 : -1;
+
+	return e1->addr < e2->addr ? -1 : e1->addr > e2->addr;
+}
+
+void prof_print_report(int count)
+{
+	struct prof_entry *entries, *entry;
+	ulong samples, outside;
+	ulong bucket;
+	int num, i;
+
+	prof_get_stats(&samples, &outside);
+	printf("Samples: %lu, outside U-Boot: %lu\n", samples, outside);
+	if (!samples)
+		return;
+
+	/* Buckets are in address order, so each function is contiguous */
+	entries = calloc(min(prof.hist_count, samples), sizeof(*entries));
+	if (!entries) {
+		printf("Out of memory\n");
+		return;
+	}
+	for (bucket = num = 0; bucket < prof.hist_count; bucket++) {
+		ulong addr = prof_text_base() + bucket * CONFIG_PROF_GRANULE;
+		const char *name = NULL;
+
+		if (!prof.hist[bucket])
+			continue;
+#ifdef CONFIG_KALLSYMS
+		name = symbol_lookup(addr, &addr);
+		if (num && name && entries[num - 1].name == name) {
+			entries[num - 1].count += prof.hist[bucket];
+			continue;
+		}
+#endif
+		entry = &entries[num++];
+		entry->addr = addr;
+		entry->count = prof.hist[bucket];
+		entry->name = name;
+	}
+	qsort(entries, num, sizeof(*entries), h_cmp_count);
+
+	printf("   Count      %%  Address           Function\n");
+	for (i = 0, entry = entries; i < min(num, count); i++, entry++) {
+		ulong permille = entry->count * 1000 / samples;
+
+		printf("%8lu %3lu.%lu%%  %016lx  %s\n", entry->count,
+		       permille / 10, permille % 10, entry->addr,
+		       entry->name ? entry->name : "");
+	}
+	free(entries);
+}
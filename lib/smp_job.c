@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs on secondary CPUs
+ *
+ * Jobs are held in a ring which is filled only by the boot CPU. Any CPU
+ * (including the boot CPU while it waits) may claim the job at the tail
+ * by advancing the tail index with a compare-and-swap.
+ */
+
+#ifdef USE_HOSTCC
+#include "mkimage.h"
+#else
+#include <common.h>
+#endif
+#include <smp_job.h>
+
+static struct smp_job *smp_job_ring[SMP_JOB_QUEUE_LEN];
+static uint smp_job_head;	/* next slot to fill, written by boot CPU */
+static uint smp_job_tail;	/* next slot to claim */
+static int smp_job_workers;	/* number of secondary CPUs running */
+static int smp_job_stopping;	/* tells the workers to return */
+static bool smp_job_started;	/* true once we have tried to start CPUs */
+
+/* Host tools provide all of these, in tools/smp_job-host.c */
+#ifndef USE_HOSTCC
+__weak int arch_smp_job_start(int max_workers)
+{
+	return 0;
+}
+
+__weak void arch_smp_job_stop(void)
+{
+}
+
+__weak void arch_smp_job_idle(void)
+{
+}
+
+__weak void arch_smp_job_notify(void)
+{
+}
+#endif
+
+/**
+ * smp_job_claim() - Claim the next queued job
+ *
+ * @return job claimed, or NULL if the queue is empty
+ */
+static struct smp_job *smp_job_claim(void)
+{
+	struct smp_job *job;
+	uint tail;
+
+	do {
+		tail = __atomic_load_n(&smp_job_tail, __ATOMIC_ACQUIRE);
+		if (tail == __atomic_load_n(&smp_job_head, __ATOMIC_ACQUIRE))
+			return NULL;
+		job = smp_job_ring[tail % SMP_JOB_QUEUE_LEN];
+	} while (!__atomic_compare_exchange_n(&smp_job_tail, &tail, tail + 1,
+					      false, __ATOMIC_ACQ_REL,
+					      __ATOMIC_ACQUIRE));
+
+	return job;
+}
+
+/**
+ * smp_job_run_one() - Claim and run the next queued job
+ *
+ * @return true if a job was run, false if the queue is empty
+ */
+static bool smp_job_run_one(void)
+{
+	struct smp_job *job;
+
+	job = smp_job_claim();
+	if (!job)
+		return false;
+	job->ret = job->func(job->arg);
+	__atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+	arch_smp_job_notify();
+
+	return true;
+}
+
+void smp_job_worker(int worker)
+{
+	debug("smp_job: worker %d started\n", worker);
+	while (!__atomic_load_n(&smp_job_stopping, __ATOMIC_ACQUIRE)) {
+		if (!smp_job_run_one())
+			arch_smp_job_idle();
+	}
+}
+
+static void smp_job_start(void)
+{
+	int ret;
+
+	smp_job_started = true;
+	smp_job_stopping = 0;
+	ret = arch_smp_job_start(CONFIG_SMP_JOB_MAX_WORKERS);
+	if (ret < 0) {
+		debug("smp_job: Cannot start secondary CPUs (err=%d)\n", ret);
+		return;
+	}
+	smp_job_workers = ret;
+	debug("smp_job: %d workers\n", ret);
+}
+
+void smp_job_queue(struct smp_job *job)
+{
+	uint head = smp_job_head;
+
+	if (!smp_job_started)
+		smp_job_start();
+	job->done = 0;
+
+	/* If the ring is full, help to empty it */
+	while (head - __atomic_load_n(&smp_job_tail, __ATOMIC_ACQUIRE) >=
+	       SMP_JOB_QUEUE_LEN)
+		smp_job_run_one();
+
+	smp_job_ring[head % SMP_JOB_QUEUE_LEN] = job;
+	__atomic_store_n(&smp_job_head, head + 1, __ATOMIC_RELEASE);
+	arch_smp_job_notify();
+}
+
+int smp_job_wait(struct smp_job *job)
+{
+	while (!__atomic_load_n(&job->done, __ATOMIC_ACQUIRE)) {
+		if (!smp_job_run_one())
+			arch_smp_job_idle();
+	}
+
+	return job->ret;
+}
+
+int smp_job_run(struct smp_job *jobs, int count)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < count; i++)
+		smp_job_queue(&jobs[i]);
+	for (i = 0; i < count; i++) {
+		smp_job_wait(&jobs[i]);
+		if (!ret)
+			ret = jobs[i].ret;
+	}
+
+	return ret;
+}
+
+void smp_job_stop(void)
+{
+	if (!smp_job_started)
+		return;
+
+	/* Run anything still queued, so that no job is lost */
+	while (smp_job_run_one())
+		;
+	if (smp_job_workers) {
+		__atomic_store_n(&smp_job_stopping, 1, __ATOMIC_RELEASE);
+		arch_smp_job_notify();
+		arch_smp_job_stop();
+		debug("smp_job: %d workers stopped\n", smp_job_workers);
+	}
+	smp_job_workers = 0;
+	smp_job_started = false;
+}
+
+int smp_job_get_workers(void)
+{
+	return smp_job_workers;
+}
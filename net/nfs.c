@@ -28,6 +28,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <image.h>
 #include <net.h>
 #include <malloc.h>
 #include <mapmem.h>
@@ -47,10 +48,32 @@
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static ulong nfs_timeout = NFS_TIMEOUT;
 
+/**
+ * struct nfs_read_slot - an outstanding READ request
+ *
+ * @xid:	RPC transaction ID of the request, 0 if the slot is free
+ * @offset:	File offset being read
+ * @len:	Number of bytes requested
+ * @time:	Time the request was last sent, from get_timer()
+ * @retries:	Number of times the request has been retransmitted
+ */
+struct nfs_read_slot {
+	ulong xid;
+	uint offset;
+	uint len;
+	ulong time;
+	int retries;
+};
+
+static struct nfs_read_slot nfs_read_slots[CONFIG_NFS_READ_WINDOW];
+static uint nfs_read_size;	/* bytes to ask for in each READ */
+static uint nfs_read_next;	/* offset of the next READ to send */
+static uint nfs_read_end;	/* file size, or UINT_MAX if not yet known */
+static uint nfs_read_bytes;	/* bytes received since the last hash */
+static int nfs_hashes;		/* number of hashes printed */
+
 static char dirfh[NFS_FHSIZE];	/* NFSv2 / NFSv3 file handle of directory */
 static char filefh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle */
 static int filefh3_length;	/* (variable) length of filefh when NFSv3 */
@@ -69,6 +92,7 @@ static int nfs_state;
 #define STATE_LOOKUP_REQ		5
 #define STATE_READ_REQ			6
 #define STATE_READLINK_REQ		7
+#define STATE_FSINFO_REQ		8
 
 static char *nfs_filename;
 static char *nfs_path;
@@ -103,6 +127,7 @@ static inline int store_block(uchar *src, unsigned offset, unsigned len)
 	{
 		void *ptr = map_sysmem(load_addr + offset, len);
 
+		fit_handoff_invalidate(load_addr + offset, len);
 		memcpy(ptr, src, len);
 		unmap_sysmem(ptr);
 	}
@@ -386,6 +411,108 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+/**************************************************************************
+NFS_FSINFO - Get the NFSv3 server's preferred transfer sizes
+**************************************************************************/
+static void nfs_fsinfo_req(void)
+{
+	uint32_t data[1024];
+	uint32_t *p;
+	int len;
+
+	p = &(data[0]);
+	p = rpc_add_credentials(p);
+
+	*p++ = htonl(filefh3_length);
+	memcpy(p, filefh, filefh3_length);
+	p += (filefh3_length / 4);
+
+	len = (uint32_t *)p - (uint32_t *)&(data[0]);
+
+	rpc_req(PROG_NFS, NFS3PROC_FSINFO, data, len);
+}
+
+/**************************************************************************
+Pipelined reads: keep up to CONFIG_NFS_READ_WINDOW READ requests outstanding
+**************************************************************************/
+static void nfs_read_send(struct nfs_read_slot *slot)
+{
+	nfs_read_req(slot->offset, slot->len);
+	slot->xid = rpc_id;
+	slot->time = get_timer(0);
+}
+
+static void nfs_read_start(void)
+{
+	memset(nfs_read_slots, '\0', sizeof(nfs_read_slots));
+	nfs_read_next = 0;
+	nfs_read_end = UINT_MAX;
+	nfs_read_bytes = 0;
+	nfs_hashes = 0;
+}
+
+/* Send new READ requests until the window is full or the file is covered */
+static void nfs_read_fill(void)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		slot = &nfs_read_slots[i];
+		if (slot->xid)
+			continue;
+		if (nfs_read_next >= nfs_read_end)
+			break;
+		slot->offset = nfs_read_next;
+		slot->len = nfs_read_size;
+		slot->retries = 0;
+		nfs_read_next += nfs_read_size;
+		nfs_read_send(slot);
+	}
+}
+
+/* Resend READ requests which have had no reply for at least @age ms */
+static int nfs_read_retransmit(ulong age)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		slot = &nfs_read_slots[i];
+		if (!slot->xid || get_timer(slot->time) < age)
+			continue;
+		if (++slot->retries > NFS_RETRY_COUNT)
+			return -ETIMEDOUT;
+		nfs_read_send(slot);
+	}
+
+	return 0;
+}
+
+static struct nfs_read_slot *nfs_read_find(ulong xid)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		if (nfs_read_slots[i].xid && nfs_read_slots[i].xid == xid)
+			return &nfs_read_slots[i];
+	}
+
+	return NULL;
+}
+
+static bool nfs_read_busy(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NFS_READ_WINDOW; i++) {
+		if (nfs_read_slots[i].xid)
+			return true;
+	}
+
+	return false;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -416,11 +543,14 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_fill();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
 		break;
+	case STATE_FSINFO_REQ:
+		nfs_fsinfo_req();
+		break;
 	}
 }
 
@@ -652,21 +782,64 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
-static int nfs_read_reply(uchar *pkt, unsigned len)
+static int nfs_fsinfo_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
-	uchar *data_ptr;
+	int nfsv3_data_offset;
+	uint rtmax;
 
 	debug("%s\n", __func__);
 
-	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
+	/* The reply may be larger than rpc_pkt with IP_DEFRAG */
+	memcpy(&rpc_pkt.u.data[0], pkt, min_t(uint, len,
+					      sizeof(rpc_pkt.u.data)));
 
 	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
 		return -NFS_RPC_ERR;
 	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
 		return -NFS_RPC_DROP;
 
+	if (rpc_pkt.u.reply.rstatus  ||
+	    rpc_pkt.u.reply.verifier ||
+	    rpc_pkt.u.reply.astatus  ||
+	    rpc_pkt.u.reply.data[0])
+		return -1;
+
+	nfsv3_data_offset = nfs3_get_attributes_offset(rpc_pkt.u.reply.data);
+	rtmax = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+	if (rtmax) {
+		/* Use whole multiples of the default size where possible */
+		rtmax = min_t(uint, rtmax, NFS_MAX_READ_SIZE);
+		nfs_read_size = rtmax < NFS_READ_SIZE ? rtmax :
+				rounddown(rtmax, NFS_READ_SIZE);
+	}
+	debug("NFS server rtmax %u, using read size %u\n",
+	      ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]),
+	      nfs_read_size);
+
+	return 0;
+}
+
+static int nfs_read_reply(uchar *pkt, unsigned len,
+			  struct nfs_read_slot **slotp)
+{
+	struct nfs_read_slot *slot;
+	struct rpc_t rpc_pkt;
+	uint rlen;
+	uchar *data_ptr;
+	int data_offset;
+
+	debug("%s\n", __func__);
+
+	/* Copy only the header; the data is stored directly from the packet */
+	memcpy(&rpc_pkt.u.data[0], pkt, min_t(uint, len,
+					      sizeof(rpc_pkt.u.reply)));
+
+	slot = nfs_read_find(ntohl(rpc_pkt.u.reply.id));
+	if (!slot)
+		return -NFS_RPC_DROP;
+	*slotp = slot;
+
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
 	    rpc_pkt.u.reply.astatus  ||
@@ -678,13 +851,9 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
 	if (supported_nfs_versions & NFSV2_FLAG) {
+		/* The file attributes give the file size */
+		nfs_read_end = ntohl(rpc_pkt.u.reply.data[6]);
 		rlen = ntohl(rpc_pkt.u.reply.data[18]);
 		data_ptr = (uchar *)&(rpc_pkt.u.reply.data[19]);
 	} else {  /* NFSV3_FLAG */
@@ -693,16 +862,32 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 
 		/* count value */
 		rlen = ntohl(rpc_pkt.u.reply.data[1 + nfsv3_data_offset]);
+		/* EOF flag */
+		if (rpc_pkt.u.reply.data[2 + nfsv3_data_offset])
+			nfs_read_end = min(nfs_read_end, slot->offset + rlen);
 		/* Skip unused values :
-			EOF:		32 bits value,
 			data_size:	32 bits value,
 		*/
 		data_ptr = (uchar *)
 			&(rpc_pkt.u.reply.data[4 + nfsv3_data_offset]);
 	}
-
-	if (store_block(data_ptr, nfs_offset, rlen))
-			return -9999;
+	if (!rlen)
+		nfs_read_end = min(nfs_read_end, slot->offset);
+
+	data_offset = data_ptr - &rpc_pkt.u.data[0];
+	if (rlen > slot->len || data_offset + rlen > len)
+		return -9999;
+	if (store_block(pkt + data_offset, slot->offset, rlen))
+		return -9999;
+
+	nfs_read_bytes += rlen;
+	while (nfs_read_bytes >= (NFS_READ_SIZE / 2) * 10) {
+		nfs_read_bytes -= (NFS_READ_SIZE / 2) * 10;
+		if (nfs_hashes && !(nfs_hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		nfs_hashes++;
+	}
 
 	return rlen;
 }
@@ -712,7 +897,16 @@ Interfaces of U-BOOT
 **************************************************************************/
 static void nfs_timeout_handler(void)
 {
-	if (++nfs_timeout_count > NFS_RETRY_COUNT) {
+	if (nfs_state == STATE_READ_REQ) {
+		/* Each outstanding request has its own retry count */
+		puts("T ");
+		if (nfs_read_retransmit(nfs_timeout)) {
+			puts("\nRetry count exceeded; starting again\n");
+			net_start_again();
+			return;
+		}
+		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
+	} else if (++nfs_timeout_count > NFS_RETRY_COUNT) {
 		puts("\nRetry count exceeded; starting again\n");
 		net_start_again();
 	} else {
@@ -727,6 +921,7 @@ static void nfs_timeout_handler(void)
 static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			unsigned src, unsigned len)
 {
+	struct nfs_read_slot *slot;
 	int rlen;
 	int reply;
 
@@ -794,14 +989,29 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			/* And retry with another supported version */
 			nfs_state = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
 			nfs_send();
-		} else {
+		} else if (supported_nfs_versions & NFSV2_FLAG) {
 			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
+			nfs_read_size = min_t(uint, NFS_MAX_READ_SIZE,
+					      NFS2_MAX_READ_SIZE);
+			nfs_read_start();
+			nfs_send();
+		} else {
+			nfs_state = STATE_FSINFO_REQ;
 			nfs_send();
 		}
 		break;
 
+	case STATE_FSINFO_REQ:
+		/* Use the smallest read size if the server does not say */
+		nfs_read_size = NFS_READ_SIZE;
+		reply = nfs_fsinfo_reply(pkt, len);
+		if (reply == -NFS_RPC_DROP)
+			break;
+		nfs_state = STATE_READ_REQ;
+		nfs_read_start();
+		nfs_send();
+		break;
+
 	case STATE_READLINK_REQ:
 		reply = nfs_readlink_reply(pkt, len);
 		if (reply == -NFS_RPC_DROP) {
@@ -821,22 +1031,38 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		break;
 
 	case STATE_READ_REQ:
-		rlen = nfs_read_reply(pkt, len);
+		rlen = nfs_read_reply(pkt, len, &slot);
 		if (rlen == -NFS_RPC_DROP)
 			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen >= 0) {
+			if (rlen < slot->len &&
+			    slot->offset + rlen < nfs_read_end) {
+				/* Short read: ask for the rest of the block */
+				slot->offset += rlen;
+				slot->len -= rlen;
+				slot->retries = 0;
+				nfs_read_send(slot);
+			} else {
+				slot->xid = 0;
+			}
+			if (nfs_read_retransmit(nfs_timeout)) {
+				puts("\nRetry count exceeded; starting again\n");
+				net_start_again();
+				break;
+			}
 			nfs_send();
+			if (!nfs_read_busy()) {
+				nfs_download_state = NETLOOP_SUCCESS;
+				nfs_state = STATE_UMOUNT_REQ;
+				nfs_send();
+			}
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
-			if (rlen < 0)
-				debug("NFS READ error (%d)\n", rlen);
+			debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
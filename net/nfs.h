@@ -25,6 +25,7 @@
 #define NFS_READ        6
 
 #define NFS3PROC_LOOKUP 3
+#define NFS3PROC_FSINFO 19
 
 #define NFS_FHSIZE      32
 #define NFS3_FHSIZE     64
@@ -42,8 +43,33 @@
  * case, most NFS servers are optimized for a power of 2.
  */
 #define NFS_READ_SIZE	1024	/* biggest power of two that fits Ether frame */
+
 #define NFS_MAX_ATTRS	26
 
+/* Largest size of the RPC header, status and attributes in a READ reply */
+#define NFS_READ_HDR_SIZE	((6 + NFS_MAX_ATTRS) * sizeof(uint32_t))
+
+/* Protocol maximum for an NFSv2 READ */
+#define NFS2_MAX_READ_SIZE	8192
+
+/*
+ * Largest read size we can accept: whatever fits in the IP defragmentation
+ * buffer after the IP/UDP and RPC headers. NFSv3 servers may report a
+ * smaller maximum, in which case that is used.
+ */
+#ifdef CONFIG_IP_DEFRAG
+#ifdef CONFIG_NET_MAXDEFRAG
+#define NFS_DEFRAG_SIZE		CONFIG_NET_MAXDEFRAG
+#else
+#define NFS_DEFRAG_SIZE		16384	/* default in net/net.c */
+#endif
+#define NFS_MAX_READ_SIZE	max_t(uint, NFS_DEFRAG_SIZE - \
+				      IP_UDP_HDR_SIZE - NFS_READ_HDR_SIZE, \
+				      NFS_READ_SIZE)
+#else
+#define NFS_MAX_READ_SIZE	NFS_READ_SIZE
+#endif
+
 /* Values for Accept State flag on RPC answers (See: rfc1831) */
 enum rpc_accept_stat {
 	NFS_RPC_SUCCESS = 0,	/* RPC executed successfully */
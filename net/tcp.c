@@ -0,0 +1,488 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Minimal TCP support
+ *
+ * This supports a single client connection which sends a small request and
+ * then receives a large stream of data, e.g. an HTTP GET. Received data is
+ * passed straight to the handler, which stores it at its final location,
+ * so there is no receive buffer. Segments which arrive out of order are
+ * passed on as well and their ranges recorded, so that a lost segment does
+ * not cause everything after it to be sent again. Each out-of-order
+ * segment is acknowledged immediately, so the duplicate ACKs trigger a fast
+ * retransmit of the missing segment by the sender, without needing SACK.
+ */
+
+#include <common.h>
+#include <net.h>
+#include <net/tcp.h>
+#include <asm/unaligned.h>
+
+#define TCP_TICK_MS	50	/* timer tick; also the delayed-ACK time */
+#define TCP_RTO_MS	1000	/* initial retransmission timeout */
+#define TCP_RTO_MAX_MS	8000
+#define TCP_RETRIES	10
+#define TCP_IDLE_MS	30000	/* give up if the peer is silent this long */
+
+/* Compare sequence numbers, allowing for wrap-around */
+#define seq_before(a, b)	((s32)((a) - (b)) < 0)
+#define seq_after(a, b)		seq_before(b, a)
+
+/**
+ * struct tcp_range - A range of the stream received out of order
+ *
+ * @start:	Stream offset of the first byte
+ * @end:	Stream offset of the byte after the last one
+ */
+struct tcp_range {
+	u32 start;
+	u32 end;
+};
+
+static enum tcp_state tcp_state;
+static rxhand_tcp_f *tcp_handler;
+static struct in_addr tcp_server_ip;
+static u16 tcp_server_port;
+static u16 tcp_our_port;
+
+/* Send side: we only ever have one segment (SYN, data or FIN) in flight */
+static u32 tcp_snd_una;		/* oldest unacknowledged sequence number */
+static u32 tcp_snd_nxt;		/* next sequence number to send */
+static uchar tcp_tx_data[TCP_MSS];
+static int tcp_tx_len;		/* bytes of unacknowledged data */
+static bool tcp_fin_sent;
+static ulong tcp_tx_time;	/* time the segment in flight was sent */
+static ulong tcp_rto;
+static int tcp_retries;
+
+/* Receive side, with sequence numbers as offsets from the stream start */
+static u32 tcp_irs;		/* peer's initial sequence number */
+static u32 tcp_rcv_nxt;		/* next stream offset expected */
+static bool tcp_wscale;		/* peer agreed to window scaling */
+static int tcp_ack_pending;	/* segments received but not acknowledged */
+static ulong tcp_rx_time;	/* time the last segment was received */
+static ulong tcp_ack_time;	/* time the last ACK was sent */
+static struct tcp_range tcp_ooo[TCP_OOO_RANGES];
+static int tcp_ooo_count;
+
+void tcp_set_tcp_handler(rxhand_tcp_f *f)
+{
+	tcp_handler = f;
+}
+
+enum tcp_state tcp_get_state(void)
+{
+	return tcp_state;
+}
+
+static void tcp_set_state(enum tcp_state state)
+{
+	debug_cond(DEBUG_INT_STATE, "--- TCP state %d -> %d\n", tcp_state,
+		   state);
+	tcp_state = state;
+	if (state == TCP_CLOSED)
+		net_set_timeout_handler(0, NULL);
+	if (tcp_handler)
+		tcp_handler(NULL, tcp_rcv_nxt, 0);
+}
+
+static u16 tcp_checksum(struct ip_tcp_hdr *ip, int tcp_len)
+{
+	struct {
+		struct in_addr src;
+		struct in_addr dst;
+		u8 zero;
+		u8 proto;
+		u16 len;
+	} __attribute__((packed)) pseudo;
+	unsigned sum;
+
+	net_copy_ip(&pseudo.src, &ip->ip_src);
+	net_copy_ip(&pseudo.dst, &ip->ip_dst);
+	pseudo.zero = 0;
+	pseudo.proto = IPPROTO_TCP;
+	pseudo.len = htons(tcp_len);
+	sum = compute_ip_checksum(&pseudo, sizeof(pseudo));
+
+	return add_ip_checksums(sizeof(pseudo), sum,
+				compute_ip_checksum(&ip->tcp_src, tcp_len));
+}
+
+int tcp_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 action, u32 seq, u32 ack)
+{
+	struct ip_tcp_hdr *ip = (struct ip_tcp_hdr *)pkt;
+	uchar *opt = pkt + IP_TCP_HDR_SIZE;
+	int hlen = TCP_HDR_SIZE;
+	uint win;
+
+	if (action & TCP_SYN) {
+		/* The window in a SYN is never scaled */
+		opt[0] = TCP_O_MSS;
+		opt[1] = 4;
+		put_unaligned_be16(TCP_MSS, opt + 2);
+		opt[4] = TCP_O_NOP;
+		opt[5] = TCP_O_SCL;
+		opt[6] = 3;
+		opt[7] = TCP_WND_SHIFT;
+		hlen += 8;
+		payload_len = 0;
+		win = min(TCP_RCV_WND, 0xffff);
+	} else if (tcp_wscale) {
+		win = TCP_RCV_WND >> TCP_WND_SHIFT;
+	} else {
+		win = min(TCP_RCV_WND, 0xffff);
+	}
+
+	net_set_ip_header(pkt, dest, net_ip, IP_HDR_SIZE + hlen + payload_len,
+			  IPPROTO_TCP);
+
+	ip->tcp_src = htons(sport);
+	ip->tcp_dst = htons(dport);
+	ip->tcp_seq = htonl(seq);
+	ip->tcp_ack = htonl(ack);
+	ip->tcp_hlen = (hlen / 4) << 4;
+	ip->tcp_flags = action;
+	ip->tcp_win = htons(win);
+	ip->tcp_xsum = 0;
+	ip->tcp_urg = 0;
+	ip->tcp_xsum = tcp_checksum(ip, hlen + payload_len);
+
+	return IP_HDR_SIZE + hlen;
+}
+
+static void tcp_send_segment(u8 action, u32 seq, const void *data, int len)
+{
+	uchar *payload = net_tx_packet + net_eth_hdr_size() + IP_TCP_HDR_SIZE;
+	u32 ack = 0;
+
+	/* Everything except our SYN acknowledges what we have received */
+	if (!(action & TCP_SYN)) {
+		action |= TCP_ACK;
+		ack = tcp_irs + 1 + tcp_rcv_nxt;
+		tcp_ack_pending = 0;
+		tcp_ack_time = get_timer(0);
+	}
+	if (len)
+		memcpy(payload, data, len);
+	net_send_ip_packet(net_server_ethaddr, tcp_server_ip, tcp_server_port,
+			   tcp_our_port, len, IPPROTO_TCP, action, seq, ack);
+}
+
+static void tcp_send_ack(void)
+{
+	tcp_send_segment(TCP_ACK, tcp_snd_nxt, NULL, 0);
+}
+
+/* Send (or resend) whatever is waiting to be acknowledged */
+static void tcp_transmit(void)
+{
+	if (tcp_state == TCP_SYN_SENT)
+		tcp_send_segment(TCP_SYN, tcp_snd_una, NULL, 0);
+	else if (tcp_tx_len)
+		tcp_send_segment(TCP_PUSH, tcp_snd_una, tcp_tx_data,
+				 tcp_tx_len);
+	else if (tcp_fin_sent)
+		tcp_send_segment(TCP_FIN, tcp_snd_nxt - 1, NULL, 0);
+	tcp_tx_time = get_timer(0);
+}
+
+static void tcp_timeout_handler(void)
+{
+	if (tcp_ack_pending)
+		tcp_send_ack();
+
+	if (tcp_snd_una != tcp_snd_nxt && get_timer(tcp_tx_time) >= tcp_rto) {
+		if (++tcp_retries > TCP_RETRIES) {
+			debug("TCP: retry count exceeded\n");
+			tcp_set_state(TCP_CLOSED);
+			return;
+		}
+		tcp_rto = min(tcp_rto * 2, (ulong)TCP_RTO_MAX_MS);
+		tcp_transmit();
+	}
+
+	if (tcp_state != TCP_SYN_SENT) {
+		if (get_timer(tcp_rx_time) >= TCP_IDLE_MS) {
+			debug("TCP: connection timed out\n");
+			tcp_set_state(TCP_CLOSED);
+			return;
+		}
+		/* If the peer has gone quiet, our last ACK may have been lost */
+		if (get_timer(tcp_rx_time) >= TCP_RTO_MS &&
+		    get_timer(tcp_ack_time) >= TCP_RTO_MS)
+			tcp_send_ack();
+	}
+
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+}
+
+int tcp_connect(struct in_addr dest, u16 dport)
+{
+	static u16 next_port;
+
+	/* Use a new port each time, so the server sees a new connection */
+	if (!next_port)
+		next_port = 49152 + (get_ticks() & 0x3fff);
+	tcp_our_port = next_port++;
+	if (next_port < 49152)
+		next_port = 49152;
+
+	tcp_server_ip = dest;
+	tcp_server_port = dport;
+	tcp_snd_una = (u32)get_ticks() ^ ((u32)tcp_our_port << 16);
+	tcp_snd_nxt = tcp_snd_una + 1;
+	tcp_tx_len = 0;
+	tcp_fin_sent = false;
+	tcp_rto = TCP_RTO_MS;
+	tcp_retries = 0;
+	tcp_irs = 0;
+	tcp_rcv_nxt = 0;
+	tcp_wscale = false;
+	tcp_ack_pending = 0;
+	tcp_ooo_count = 0;
+	tcp_state = TCP_SYN_SENT;
+
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+	tcp_transmit();
+
+	return 0;
+}
+
+int tcp_send(const void *data, int len)
+{
+	if (tcp_state != TCP_ESTABLISHED)
+		return -ENOTCONN;
+	if (tcp_snd_una != tcp_snd_nxt)
+		return -EBUSY;
+	if (len > TCP_MSS)
+		return -E2BIG;
+
+	memcpy(tcp_tx_data, data, len);
+	tcp_tx_len = len;
+	tcp_snd_nxt += len;
+	tcp_rto = TCP_RTO_MS;
+	tcp_retries = 0;
+	tcp_transmit();
+
+	return 0;
+}
+
+void tcp_close(void)
+{
+	switch (tcp_state) {
+	case TCP_SYN_SENT:
+		tcp_set_state(TCP_CLOSED);
+		break;
+	case TCP_ESTABLISHED:
+		/* Any request data has been sent by now; don't resend it */
+		tcp_tx_len = 0;
+		tcp_snd_una = tcp_snd_nxt;
+		tcp_fin_sent = true;
+		tcp_snd_nxt++;
+		tcp_state = TCP_FIN_WAIT;
+		tcp_rto = TCP_RTO_MS;
+		tcp_retries = 0;
+		tcp_transmit();
+		break;
+	default:
+		break;
+	}
+}
+
+/* Parse the options in a SYN-ACK; we only care about window scaling */
+static void tcp_parse_options(const uchar *opt, int len)
+{
+	while (len > 0) {
+		int optlen;
+
+		if (opt[0] == TCP_O_END)
+			break;
+		if (opt[0] == TCP_O_NOP) {
+			opt++;
+			len--;
+			continue;
+		}
+		if (len < 2)
+			break;
+		optlen = opt[1];
+		if (optlen < 2 || optlen > len)
+			break;
+		if (opt[0] == TCP_O_SCL && optlen == 3)
+			tcp_wscale = true;
+		opt += optlen;
+		len -= optlen;
+	}
+}
+
+/* Move past any out-of-order ranges which are now in order */
+static bool tcp_ooo_advance(void)
+{
+	bool advanced = false;
+	int i;
+
+	for (i = 0; i < tcp_ooo_count; i++) {
+		struct tcp_range *range = &tcp_ooo[i];
+
+		if (seq_after(range->start, tcp_rcv_nxt))
+			continue;
+		if (seq_after(range->end, tcp_rcv_nxt))
+			tcp_rcv_nxt = range->end;
+		*range = tcp_ooo[--tcp_ooo_count];
+		advanced = true;
+		/* Another range may now be in order, so start again */
+		i = -1;
+	}
+
+	return advanced;
+}
+
+static void tcp_ooo_add(u32 start, u32 end)
+{
+	int i;
+
+	for (i = 0; i < tcp_ooo_count; i++) {
+		struct tcp_range *range = &tcp_ooo[i];
+
+		if (!seq_after(start, range->end) &&
+		    !seq_before(end, range->start)) {
+			if (seq_before(start, range->start))
+				range->start = start;
+			if (seq_after(end, range->end))
+				range->end = end;
+			return;
+		}
+	}
+
+	/* If there is no room, the peer will have to send it again */
+	if (tcp_ooo_count < TCP_OOO_RANGES) {
+		tcp_ooo[tcp_ooo_count].start = start;
+		tcp_ooo[tcp_ooo_count].end = end;
+		tcp_ooo_count++;
+	}
+}
+
+static void tcp_rx_data(uchar *data, u32 offset, int len, u8 flags)
+{
+	s32 delta = offset - tcp_rcv_nxt;
+	bool ack_now = false;
+
+	if (len && delta + len <= 0) {
+		/* Old data sent again; the peer may have missed an ACK */
+		offset += len;
+		len = 0;
+		ack_now = true;
+	} else if (len) {
+		if (delta < 0) {
+			data -= delta;
+			len += delta;
+			offset = tcp_rcv_nxt;
+			delta = 0;
+		}
+		if (delta >= TCP_RCV_WND) {
+			tcp_send_ack();
+			return;
+		}
+		len = min(len, TCP_RCV_WND - delta);
+
+		if (!delta) {
+			if (tcp_handler && tcp_handler(data, offset, len)) {
+				tcp_send_ack();
+				return;
+			}
+			tcp_rcv_nxt += len;
+			/* ACK at once if a hole was just filled */
+			if (tcp_ooo_advance() || tcp_ooo_count)
+				ack_now = true;
+			if ((flags & TCP_PUSH) || ++tcp_ack_pending >= 2)
+				ack_now = true;
+		} else {
+			if (tcp_handler && !tcp_handler(data, offset, len))
+				tcp_ooo_add(offset, offset + len);
+			/* The duplicate ACK tells the peer what is missing */
+			ack_now = true;
+		}
+	}
+
+	/* The FIN takes effect only once everything before it has arrived */
+	if ((flags & TCP_FIN) && offset + len == tcp_rcv_nxt) {
+		tcp_rcv_nxt++;
+		if (tcp_state == TCP_ESTABLISHED) {
+			tcp_fin_sent = true;
+			tcp_snd_nxt++;
+			tcp_transmit();
+			tcp_set_state(TCP_CLOSE_WAIT);
+		} else if (tcp_state == TCP_FIN_WAIT) {
+			tcp_send_ack();
+			tcp_set_state(TCP_CLOSED);
+		}
+		return;
+	}
+
+	if (ack_now)
+		tcp_send_ack();
+}
+
+void tcp_receive(struct ip_tcp_hdr *ip, int len)
+{
+	int hlen;
+	u32 seq, ack;
+	u8 flags;
+
+	if (tcp_state == TCP_CLOSED || len < IP_TCP_HDR_SIZE)
+		return;
+	if (net_read_ip(&ip->ip_src).s_addr != tcp_server_ip.s_addr ||
+	    ntohs(ip->tcp_src) != tcp_server_port ||
+	    ntohs(ip->tcp_dst) != tcp_our_port)
+		return;
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	if (hlen < TCP_HDR_SIZE || IP_HDR_SIZE + hlen > len)
+		return;
+	if (tcp_checksum(ip, len - IP_HDR_SIZE)) {
+		debug("TCP: bad checksum\n");
+		return;
+	}
+
+	flags = ip->tcp_flags;
+	seq = ntohl(ip->tcp_seq);
+	ack = ntohl(ip->tcp_ack);
+	tcp_rx_time = get_timer(0);
+
+	if (flags & TCP_RST) {
+		debug("TCP: connection reset\n");
+		tcp_set_state(TCP_CLOSED);
+		return;
+	}
+
+	if (tcp_state == TCP_SYN_SENT) {
+		if ((flags & (TCP_SYN | TCP_ACK)) != (TCP_SYN | TCP_ACK) ||
+		    ack != tcp_snd_nxt)
+			return;
+		tcp_irs = seq;
+		tcp_snd_una = ack;
+		tcp_retries = 0;
+		tcp_rto = TCP_RTO_MS;
+		tcp_parse_options((uchar *)ip + IP_TCP_HDR_SIZE,
+				  hlen - TCP_HDR_SIZE);
+		tcp_send_ack();
+		tcp_set_state(TCP_ESTABLISHED);
+		return;
+	}
+
+	if ((flags & TCP_ACK) && seq_after(ack, tcp_snd_una) &&
+	    !seq_after(ack, tcp_snd_nxt)) {
+		tcp_snd_una = ack;
+		if (tcp_snd_una == tcp_snd_nxt) {
+			tcp_tx_len = 0;
+			tcp_retries = 0;
+			tcp_rto = TCP_RTO_MS;
+			/* Our FIN was acknowledged after the peer's */
+			if (tcp_fin_sent && tcp_state == TCP_CLOSE_WAIT) {
+				tcp_set_state(TCP_CLOSED);
+				return;
+			}
+		}
+	}
+
+	tcp_rx_data((uchar *)ip + IP_HDR_SIZE + hlen, seq - tcp_irs - 1,
+		    len - IP_HDR_SIZE - hlen, flags);
+}
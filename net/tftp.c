@@ -9,6 +9,7 @@
 #include <common.h>
 #include <command.h>
 #include <efi_loader.h>
+#include <image.h>
 #include <mapmem.h>
 #include <net.h>
 #include <net/tftp.h>
@@ -193,6 +194,7 @@ static inline void store_block(int block, uchar *src, unsigned len)
 	{
 		void *ptr = map_sysmem(load_addr + offset, len);
 
+		fit_handoff_invalidate(load_addr + offset, len);
 		memcpy(ptr, src, len);
 		unmap_sysmem(ptr);
 	}
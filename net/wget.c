@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * HTTP file download over TCP
+ *
+ * This sends an HTTP/1.1 GET request and writes the body of the response
+ * straight to the load address as it arrives, using the offset of each TCP
+ * segment so that data received out of order can be stored at once.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <image.h>
+#include <lmb.h>
+#include <mapmem.h>
+#include <net.h>
+#include <net/tcp.h>
+#include <linux/sizes.h>
+#include "wget.h"
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of "loading" hashes per line */
+#define HASHES_PER_LINE	65
+/* Bytes per hash when the size is not known */
+#define HASH_BYTES	(64 << 10)
+
+/* Space left for the stack to grow, when there is no LMB */
+#define WGET_STACK_MARGIN	SZ_1M
+
+enum wget_state {
+	WGET_CONNECTING,
+	WGET_HEADERS,
+	WGET_DATA,
+	WGET_DONE,
+};
+
+static enum wget_state wget_state;
+static struct in_addr wget_server_ip;
+static char wget_path[1024];
+static char wget_hdr[WGET_HDR_MAX + 1];
+static u32 wget_hdr_len;	/* bytes of response header received */
+static u32 wget_data_start;	/* stream offset of the response body */
+static long wget_content_len;	/* from Content-Length, or -1 if not known */
+static ulong wget_free_size;	/* bytes which may be written at load_addr */
+static ulong wget_bytes;	/* body bytes received */
+static int wget_hashes;		/* number of hashes printed */
+static ulong wget_time_start;
+
+static void wget_fail(const char *msg)
+{
+	printf("\n*** ERROR: %s\n", msg);
+	wget_state = WGET_DONE;
+	tcp_close();
+	net_set_state(NETLOOP_FAIL);
+}
+
+static void wget_done(void)
+{
+	ulong time;
+
+	if (wget_content_len >= 0 && net_boot_file_size != wget_content_len) {
+		wget_fail("Connection closed before the end of the file");
+		return;
+	}
+	wget_state = WGET_DONE;
+	time = get_timer(wget_time_start);
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(net_boot_file_size / time * 1000, "/s");
+	}
+	puts("\ndone\n");
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+static void wget_send_request(void)
+{
+	char req[sizeof(wget_path) + 128];
+	int len;
+
+	len = snprintf(req, sizeof(req),
+		       "GET %s%s HTTP/1.1\r\n"
+		       "Host: %pI4\r\n"
+		       "User-Agent: U-Boot\r\n"
+		       "Connection: close\r\n\r\n",
+		       *wget_path == '/' ? "" : "/", wget_path,
+		       &wget_server_ip);
+	if (len >= sizeof(req) || tcp_send(req, len)) {
+		wget_fail("Cannot send request");
+		return;
+	}
+	wget_state = WGET_HEADERS;
+}
+
+static void wget_show_progress(void)
+{
+	if (wget_content_len > 0) {
+		while (wget_hashes < wget_bytes * 50 / wget_content_len) {
+			putc('#');
+			wget_hashes++;
+		}
+		return;
+	}
+	while (wget_hashes < wget_bytes / HASH_BYTES) {
+		if (wget_hashes && !(wget_hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		wget_hashes++;
+	}
+}
+
+static void wget_store(uchar *data, u32 offset, u32 len)
+{
+	u32 pos = offset - wget_data_start;
+	void *ptr;
+
+	if (wget_content_len >= 0) {
+		if (pos >= wget_content_len)
+			return;
+		len = min_t(u32, len, wget_content_len - pos);
+	}
+	if (pos >= wget_free_size || len > wget_free_size - pos) {
+		wget_fail("Not enough free memory at load address");
+		return;
+	}
+	fit_handoff_invalidate(load_addr + pos, len);
+	ptr = map_sysmem(load_addr + pos, len);
+	memcpy(ptr, data, len);
+	unmap_sysmem(ptr);
+
+	if (net_boot_file_size < pos + len)
+		net_boot_file_size = pos + len;
+	wget_bytes += len;
+	wget_show_progress();
+}
+
+/*
+ * Parse the response header in wget_hdr
+ *
+ * @return 0 if OK, -ve if the request failed
+ */
+static int wget_parse_header(void)
+{
+	char *line, *end;
+	int status;
+
+	if (strncmp(wget_hdr, "HTTP/1.", 7) || wget_hdr[8] != ' ')
+		return -EPROTO;
+	status = simple_strtoul(wget_hdr + 9, NULL, 10);
+	if (status != 200) {
+		end = strchr(wget_hdr, '\r');
+		*end = '\0';
+		printf("\nServer said '%s'", wget_hdr);
+		return -ENOENT;
+	}
+
+	wget_content_len = -1;
+	for (line = strstr(wget_hdr, "\r\n"); line; line = strstr(line, "\r\n")) {
+		line += 2;
+		if (!strncasecmp(line, "Content-Length:", 15)) {
+			wget_content_len = simple_strtoul(line + 15 +
+							  strspn(line + 15, " \t"),
+							  NULL, 10);
+			break;
+		}
+	}
+	if (wget_content_len >= 0) {
+		puts(" Size is ");
+		print_size(wget_content_len, "\n\t ");
+		if (wget_content_len > wget_free_size)
+			return -EFBIG;
+	}
+
+	return 0;
+}
+
+static int wget_handler(uchar *pkt, u32 offset, u32 len)
+{
+	u32 n;
+	char *end;
+	int ret;
+
+	if (!len) {
+		switch (tcp_get_state()) {
+		case TCP_ESTABLISHED:
+			if (wget_state == WGET_CONNECTING)
+				wget_send_request();
+			break;
+		case TCP_CLOSE_WAIT:
+			if (wget_state == WGET_DATA)
+				wget_done();
+			else if (wget_state != WGET_DONE)
+				wget_fail("Connection closed by server");
+			break;
+		case TCP_CLOSED:
+			if (wget_state != WGET_DONE)
+				wget_fail("Connection failed");
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
+
+	switch (wget_state) {
+	case WGET_HEADERS:
+		/* The header must be read in order */
+		if (offset != wget_hdr_len)
+			return -EAGAIN;
+		n = min_t(u32, len, WGET_HDR_MAX - wget_hdr_len);
+		memcpy(wget_hdr + wget_hdr_len, pkt, n);
+		wget_hdr_len += n;
+		wget_hdr[wget_hdr_len] = '\0';
+		end = strstr(wget_hdr, "\r\n\r\n");
+		if (!end) {
+			if (wget_hdr_len == WGET_HDR_MAX)
+				wget_fail("Response header too long");
+			return 0;
+		}
+		end[2] = '\0';
+		wget_data_start = end + 4 - wget_hdr;
+		ret = wget_parse_header();
+		if (ret == -EFBIG) {
+			wget_fail("Not enough free memory at load address");
+			return 0;
+		} else if (ret) {
+			wget_fail("HTTP request failed");
+			return 0;
+		}
+		wget_state = WGET_DATA;
+
+		/* Store any part of the body which came with the header */
+		n = wget_data_start - offset;
+		if (n < len)
+			wget_store(pkt + n, wget_data_start, len - n);
+		break;
+	case WGET_DATA:
+		if (offset < wget_data_start) {
+			n = wget_data_start - offset;
+			if (n >= len)
+				break;
+			pkt += n;
+			offset += n;
+			len -= n;
+		}
+		wget_store(pkt, offset, len);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/**
+ * wget_get_free_size() - Get the space which is free at the load address
+ *
+ * @return number of bytes which can be written at load_addr without
+ *	overwriting U-Boot or anything else which is in use
+ */
+static ulong wget_get_free_size(void)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+
+	lmb_init_and_reserve(&lmb, env_get_bootm_low(), env_get_bootm_size());
+
+	return lmb_get_free_size(&lmb, load_addr);
+#else
+	ulong top = gd->start_addr_sp - WGET_STACK_MARGIN;
+
+	return load_addr < top ? top - load_addr : 0;
+#endif
+}
+
+void wget_start(void)
+{
+	debug("%s\n", __func__);
+
+	wget_server_ip = net_server_ip;
+	if (!net_parse_bootfile(&wget_server_ip, wget_path,
+				sizeof(wget_path))) {
+		puts("*** ERROR: No file name given\n");
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	wget_free_size = wget_get_free_size();
+	if (!wget_free_size) {
+		printf("*** ERROR: Address %lx is in use\n", load_addr);
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+
+	printf("Using %s device\n", eth_get_name());
+	printf("HTTP from server %pI4; our IP address is %pI4\n",
+	       &wget_server_ip, &net_ip);
+	printf("Filename '%s'.\nLoad address: 0x%lx\nLoading: *\b",
+	       wget_path, load_addr);
+
+	wget_state = WGET_CONNECTING;
+	wget_hdr_len = 0;
+	wget_content_len = -1;
+	wget_bytes = 0;
+	wget_hashes = 0;
+	wget_time_start = get_timer(0);
+
+	/* zero out server ether in case the server ip has changed */
+	memset(net_server_ethaddr, 0, 6);
+
+	tcp_set_tcp_handler(wget_handler);
+	if (tcp_connect(wget_server_ip, WGET_HTTP_PORT))
+		wget_fail("Cannot connect");
+}
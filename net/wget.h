@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * HTTP file download over TCP
+ */
+
+#ifndef __WGET_H__
+#define __WGET_H__
+
+#define WGET_HTTP_PORT		80
+#define WGET_HDR_MAX		2048	/* largest HTTP response header */
+
+void wget_start(void);	/* Begin wget */
+
+#endif /* __WGET_H__ */
@@ -5,11 +5,13 @@
 
 #include <common.h>
 #include <bloblist.h>
+#include <image.h>
 #include <log.h>
 #include <mapmem.h>
 #include <test/suites.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <warm_state.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -27,6 +29,10 @@ enum {
 
 	TEST_ADDR		= CONFIG_BLOBLIST_ADDR,
 	TEST_BLOBLIST_SIZE	= 0x100,
+
+	TEST_FIT_SIZE		= 0x200,
+	TEST_DATA_ADDR		= TEST_ADDR + CONFIG_BLOBLIST_SIZE,
+	TEST_DATA_SIZE		= 0x40,
 };
 
 static struct bloblist_hdr *clear_bloblist(void)
@@ -177,6 +183,255 @@ static int bloblist_test_checksum(struct unit_test_state *uts)
 
 BLOBLIST_TEST(bloblist_test_checksum, 0);
 
+static int bloblist_test_warm_state(struct unit_test_state *uts)
+{
+	u8 big[CONFIG_WARM_STATE_SIZE];
+	const char *data;
+	void *blob;
+
+	clear_bloblist();
+	ut_assertok(bloblist_new(TEST_ADDR, TEST_BLOBLIST_SIZE, 0));
+	ut_asserteq(0, warm_state_count());
+	ut_assertnull(warm_state_find(UCLASS_MMC, 0, TEST_SIZE));
+
+	/* Add a record and check that we can find it */
+	ut_assertok(warm_state_save(UCLASS_MMC, 0, "first", TEST_SIZE));
+	blob = bloblist_find(BLOBLISTT_WARM_STATE, CONFIG_WARM_STATE_SIZE);
+	ut_assertnonnull(blob);
+	ut_asserteq(1, warm_state_count());
+	data = warm_state_find(UCLASS_MMC, 0, TEST_SIZE);
+	ut_assertnonnull(data);
+	ut_asserteq_str("first", data);
+
+	/* The uclass, key and size must all match */
+	ut_assertnull(warm_state_find(UCLASS_MMC, 1, TEST_SIZE));
+	ut_assertnull(warm_state_find(UCLASS_SPI_FLASH, 0, TEST_SIZE));
+	ut_assertnull(warm_state_find(UCLASS_MMC, 0, TEST_SIZE2));
+
+	/* Add a second record */
+	ut_assertok(warm_state_save(UCLASS_SPI_FLASH, 0, "second", TEST_SIZE2));
+	ut_asserteq(2, warm_state_count());
+	ut_asserteq_str("second", warm_state_find(UCLASS_SPI_FLASH, 0,
+						  TEST_SIZE2));
+
+	/* Update the first record, which cannot change size */
+	ut_assertok(warm_state_save(UCLASS_MMC, 0, "update", TEST_SIZE));
+	ut_asserteq(2, warm_state_count());
+	ut_asserteq_str("update", warm_state_find(UCLASS_MMC, 0, TEST_SIZE));
+	ut_asserteq(-ESPIPE, warm_state_save(UCLASS_MMC, 0, "update",
+					     TEST_SIZE2));
+
+	/* There is no more space than the size of the blob */
+	memset(big, '\0', sizeof(big));
+	ut_asserteq(-ENOSPC, warm_state_save(UCLASS_MMC, 1, big, sizeof(big)));
+	ut_asserteq(2, warm_state_count());
+	ut_asserteq_ptr(blob, bloblist_find(BLOBLISTT_WARM_STATE,
+					    CONFIG_WARM_STATE_SIZE));
+
+	return 0;
+}
+BLOBLIST_TEST(bloblist_test_warm_state, 0);
+
+/* Create a FIT with one image which has a checked and an ignored hash */
+static int make_handoff_fit(struct unit_test_state *uts, void *fit,
+			    const void *data, int size)
+{
+	u8 value[FIT_MAX_HASH_LEN];
+	int len;
+
+	ut_assertok(fdt_create(fit, TEST_FIT_SIZE));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	ut_assertok(fdt_begin_node(fit, "kernel"));
+	ut_assertok(fdt_begin_node(fit, "hash-1"));
+	ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, "sha256"));
+	ut_assertok(calculate_hash(data, size, "sha256", value, &len));
+	ut_assertok(fdt_property(fit, FIT_VALUE_PROP, value, len));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_begin_node(fit, "hash-2"));
+	ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, "crc32"));
+	ut_assertok(fdt_property(fit, FIT_VALUE_PROP, value, 4));
+	ut_assertok(fdt_property_u32(fit, FIT_IGNORE_PROP, 1));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+
+	return 0;
+}
+
+static int bloblist_test_fit_handoff(struct unit_test_state *uts)
+{
+	struct fit_handoff_hdr *hdr;
+	struct fit_handoff_rec *rec;
+	char fit[TEST_FIT_SIZE];
+	uint8_t *value;
+	int node, len;
+	u8 *data;
+
+	clear_bloblist();
+	ut_assertok(bloblist_new(TEST_ADDR, CONFIG_BLOBLIST_SIZE, 0));
+	data = map_sysmem(TEST_DATA_ADDR, TEST_DATA_SIZE);
+	memset(data, 'a', TEST_DATA_SIZE);
+	ut_assertok(make_handoff_fit(uts, fit, data, TEST_DATA_SIZE));
+	node = fdt_path_offset(fit, "/images/kernel");
+	ut_assert(node >= 0);
+	ut_assertok(fit_image_hash_get_value(fit, fdt_subnode_offset(fit, node,
+				"hash-1"), &value, &len));
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR, TEST_DATA_SIZE, "sha256",
+				    value, len));
+
+	/* Only the hash which is checked is recorded */
+	ut_assertok(fit_handoff_save(fit, node, TEST_DATA_ADDR,
+				     TEST_DATA_SIZE));
+	hdr = bloblist_find(BLOBLISTT_FIT_HANDOFF, CONFIG_FIT_HANDOFF_SIZE);
+	ut_assertnonnull(hdr);
+	ut_asserteq(1, hdr->count);
+
+	/* Saving again replaces the record */
+	ut_assertok(fit_handoff_save(fit, node, TEST_DATA_ADDR,
+				     TEST_DATA_SIZE));
+	ut_asserteq(1, hdr->count);
+
+	/* The address, size, algorithm and value must all match */
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR + 1, TEST_DATA_SIZE,
+				    "sha256", value, len));
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR, TEST_DATA_SIZE - 1,
+				    "sha256", value, len));
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR, TEST_DATA_SIZE, "sha1",
+				    value, len));
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR, TEST_DATA_SIZE, "sha256",
+				    value, len - 1));
+
+	/* The record is used once, so the data is hashed after that */
+	ut_asserteq(1, fit_image_verify_with_data(fit, node, data,
+						  TEST_DATA_SIZE));
+	ut_asserteq(0, hdr->count);
+	data[0] = 'b';
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, data,
+						  TEST_DATA_SIZE));
+	data[0] = 'a';
+
+	/* Loading data elsewhere leaves the record alone */
+	ut_assertok(fit_handoff_save(fit, node, TEST_DATA_ADDR,
+				     TEST_DATA_SIZE));
+	fit_handoff_invalidate(TEST_DATA_ADDR - 0x10, 0x10);
+	fit_handoff_invalidate(TEST_DATA_ADDR + TEST_DATA_SIZE, 0);
+	ut_asserteq(1, hdr->count);
+
+	/* Loading data over the image drops the record */
+	fit_handoff_invalidate(TEST_DATA_ADDR + TEST_DATA_SIZE - 1, 1);
+	ut_asserteq(0, hdr->count);
+	data[TEST_DATA_SIZE - 1] = 'b';
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, data,
+						  TEST_DATA_SIZE));
+	data[TEST_DATA_SIZE - 1] = 'a';
+
+	ut_assertok(fit_handoff_save(fit, node, TEST_DATA_ADDR,
+				     TEST_DATA_SIZE));
+	fit_handoff_invalidate(TEST_DATA_ADDR - 0x10, 0);
+	ut_asserteq(0, hdr->count);
+
+	/* If the record is corrupted it is not used */
+	ut_assertok(fit_handoff_save(fit, node, TEST_DATA_ADDR,
+				     TEST_DATA_SIZE));
+	data[0] = 'b';
+	rec = (struct fit_handoff_rec *)(hdr + 1);
+	rec->value[0]++;
+	ut_assert(!fit_handoff_find(TEST_DATA_ADDR, TEST_DATA_SIZE, "sha256",
+				    rec->value, len));
+	rec->value[0]--;
+	rec->size++;
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, data,
+						  TEST_DATA_SIZE));
+	data[0] = 'a';
+	ut_asserteq(1, fit_image_verify_with_data(fit, node, data,
+						  TEST_DATA_SIZE));
+	ut_asserteq(-EINVAL, fit_handoff_save(fit, node, TEST_DATA_ADDR,
+					      TEST_DATA_SIZE));
+	unmap_sysmem(data);
+
+	return 0;
+}
+BLOBLIST_TEST(bloblist_test_fit_handoff, 0);
+
+/* Add an image with its data and a hash for each algorithm in @algos */
+static int add_handoff_image(struct unit_test_state *uts, void *fit,
+			     const char *name, const char *data,
+			     const char *const algos[])
+{
+	u8 value[FIT_MAX_HASH_LEN];
+	char hash_name[20];
+	int i, len;
+
+	ut_assertok(fdt_begin_node(fit, name));
+	ut_assertok(fdt_property_string(fit, FIT_DATA_PROP, data));
+	for (i = 0; algos[i]; i++) {
+		snprintf(hash_name, sizeof(hash_name), "hash-%d", i + 1);
+		ut_assertok(fdt_begin_node(fit, hash_name));
+		ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, algos[i]));
+		ut_assertok(calculate_hash(data, strlen(data) + 1, algos[i],
+					   value, &len));
+		ut_assertok(fdt_property(fit, FIT_VALUE_PROP, value, len));
+		ut_assertok(fdt_end_node(fit));
+	}
+	ut_assertok(fdt_end_node(fit));
+
+	return 0;
+}
+
+/* Check a FIT where only some of the images were handed off */
+static int bloblist_test_fit_handoff_all(struct unit_test_state *uts)
+{
+	static const char *const two[] = { "sha256", "sha1", NULL };
+	static const char *const one[] = { "sha256", NULL };
+	struct fit_handoff_hdr *hdr;
+	const void *data;
+	int images, node;
+	size_t size;
+	void *fit;
+
+	clear_bloblist();
+	ut_assertok(bloblist_new(TEST_ADDR, CONFIG_BLOBLIST_SIZE, 0));
+	fit = map_sysmem(TEST_DATA_ADDR, TEST_FIT_SIZE * 2);
+	ut_assertok(fdt_create(fit, TEST_FIT_SIZE * 2));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	ut_assertok(add_handoff_image(uts, fit, "kernel", "kernel data", two));
+	ut_assertok(add_handoff_image(uts, fit, "fdt", "fdt data", one));
+	ut_assertok(add_handoff_image(uts, fit, "ramdisk", "ramdisk data",
+				      two));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	node = fdt_subnode_offset(fit, images, "kernel");
+	ut_assert(node >= 0);
+	ut_assertok(fit_image_get_data_and_size(fit, node, &data, &size));
+	ut_assertok(fit_handoff_save(fit, node, map_to_sysmem((void *)data),
+				     size));
+	hdr = bloblist_find(BLOBLISTT_FIT_HANDOFF, CONFIG_FIT_HANDOFF_SIZE);
+	ut_assertnonnull(hdr);
+	ut_asserteq(2, hdr->count);
+
+	/* Looking for hashes to calculate in advance leaves the records */
+	fit_hash_jobs_start(fit, images);
+	ut_asserteq(2, hdr->count);
+	fit_hash_jobs_finish();
+
+	/* Checking the kernel uses its records and the rest are hashed */
+	ut_asserteq(1, fit_all_image_verify(fit));
+	ut_asserteq(0, hdr->count);
+	unmap_sysmem(fit);
+
+	return 0;
+}
+BLOBLIST_TEST(bloblist_test_fit_handoff_all, 0);
+
 int do_ut_bloblist(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	struct unit_test *tests = ll_entry_start(struct unit_test,
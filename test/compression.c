@@ -153,6 +153,48 @@ static int uncompress_using_gzip(struct unit_test_state *uts,
 	return ret;
 }
 
+/**
+ * struct gzip_stream_priv - Compressed data read by gzip_stream_read()
+ *
+ * @data:	Compressed data
+ * @size:	Number of bytes of compressed data remaining
+ */
+struct gzip_stream_priv {
+	const char *data;
+	unsigned long size;
+};
+
+/* Read a few bytes at a time, to check that chunks are handled correctly */
+static int gzip_stream_read(void *priv, void *buf, int size)
+{
+	struct gzip_stream_priv *st = priv;
+
+	size = min(size, (int)min(st->size, 7UL));
+	memcpy(buf, st->data, size);
+	st->data += size;
+	st->size -= size;
+
+	return size;
+}
+
+static int uncompress_using_gzip_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	struct gzip_stream_priv st = { .data = in, .size = in_size };
+	unsigned long len;
+	char buf[16];
+	int ret;
+
+	ret = gunzip_stream(out, out_max, gzip_stream_read, &st, buf,
+			    sizeof(buf), &len);
+	if (out_size)
+		*out_size = len;
+
+	return ret;
+}
+
 static int compress_using_bzip2(struct unit_test_state *uts,
 				void *in, unsigned long in_size,
 				void *out, unsigned long out_max,
@@ -410,6 +452,13 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+static int compression_test_gzip_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "gzip_stream", compress_using_gzip,
+			uncompress_using_gzip_stream);
+}
+COMPRESSION_TEST(compression_test_gzip_stream, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -10,6 +10,8 @@
 #include <dm.h>
 #include <dm/test.h>
 #include <dma.h>
+#include <malloc.h>
+#include <asm/test.h>
 #include <test/ut.h>
 
 static int dm_test_dma_m2m(struct unit_test_state *uts)
@@ -121,3 +123,86 @@ static int dm_test_dma_rx(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_dma_rx, DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DMA_ASYNC)
+static int dm_test_dma_async(struct unit_test_state *uts)
+{
+	const size_t len = 0x40000, fill_len = 0x100;
+	struct dma_async_desc desc;
+	struct dma_sg sg[2];
+	ulong overlap, stall;
+	struct udevice *dev;
+	u8 *src, *dst;
+	u8 other[64];
+	int i;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_DMA, "dma", &dev));
+	sandbox_dma_get_async_stats(dev, &overlap, &stall);
+
+	src = memalign(ARCH_DMA_MINALIGN, len);
+	ut_assertnonnull(src);
+	dst = memalign(ARCH_DMA_MINALIGN, len + fill_len);
+	ut_assertnonnull(dst);
+	memset(dst, '\0', len + fill_len);
+	for (i = 0; i < len; i++)
+		src[i] = i * 7;
+
+	/* Copy the buffer, then fill the area after it */
+	sg[0].dst = dst;
+	sg[0].src = src;
+	sg[0].len = len;
+	sg[1].dst = dst + len;
+	sg[1].src = NULL;
+	sg[1].len = fill_len;
+	desc.sg = sg;
+	desc.count = 2;
+	desc.fill = 0xa5;
+	ut_assertok(dma_async_submit(&desc));
+
+	/* The engine is busy, so this copy is done by the CPU */
+	ut_assertok(dma_memmove(other, src, sizeof(other)));
+	ut_assertok(memcmp(other, src, sizeof(other)));
+
+	/* Spend 100ms on other work, during which the engine runs */
+	sandbox_timer_add_offset(100);
+	ut_asserteq(-EINPROGRESS, dma_async_poll(&desc));
+	ut_assertok(dma_async_wait(&desc));
+	ut_assertok(dma_async_poll(&desc));
+
+	sandbox_dma_get_async_stats(dev, &overlap, &stall);
+	ut_asserteq(len + fill_len, overlap + stall);
+	ut_assert(overlap >= 100000);
+	ut_assert(stall > 0);
+
+	ut_assertok(memcmp(src, dst, len));
+	for (i = 0; i < fill_len; i++)
+		ut_asserteq(0xa5, dst[len + i]);
+
+	/*
+	 * The destination is invalidated afterwards, so it must not share
+	 * a cache line with other data
+	 */
+	sg[0].dst = dst + 1;
+	sg[0].src = src;
+	sg[0].len = len - ARCH_DMA_MINALIGN;
+	desc.count = 1;
+	ut_asserteq(-EINVAL, dma_async_submit(&desc));
+	sg[0].dst = dst;
+	sg[0].len = len - 1;
+	ut_asserteq(-EINVAL, dma_async_submit(&desc));
+
+	/* A segment which overlaps itself cannot be offloaded */
+	sg[0].dst = src + ARCH_DMA_MINALIGN;
+	sg[0].src = src;
+	sg[0].len = len - ARCH_DMA_MINALIGN;
+	ut_asserteq(-EINVAL, dma_async_submit(&desc));
+	ut_assertok(dma_memmove(src + 1, src, len - 1));
+	ut_assertok(memcmp(src + 1, dst, len - 1));
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+DM_TEST(dm_test_dma_async, DM_TESTF_SCAN_FDT);
+#endif
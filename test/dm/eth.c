@@ -9,8 +9,11 @@
 #include <common.h>
 #include <dm.h>
 #include <fdtdec.h>
+#include <lmb.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <net.h>
+#include <net/tcp.h>
 #include <dm/test.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
@@ -428,3 +431,281 @@ static int dm_test_eth_async_ping_reply(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_eth_async_ping_reply, DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_CMD_WGET
+/* A fake HTTP server, driven by the packets that wget sends */
+#define SB_HTTP_SEG		1000	/* bytes per segment */
+#define SB_HTTP_WINDOW		3	/* segments in flight */
+#define SB_HTTP_BODY_LEN	20000
+#define SB_HTTP_SWAP_SEG	3	/* sent after the segment following it */
+#define SB_HTTP_DROP_SEG	8	/* lost the first time it is sent */
+#define SB_HTTP_ISS		0x12345678
+#define SB_HTTP_PORT		80
+
+static struct sb_http_server {
+	char hdr[128];
+	u32 hdr_len;
+	u32 total;		/* length of the header and body */
+	u16 cli_port;		/* wget's TCP port */
+	u32 cli_nxt;		/* next sequence number expected from wget */
+	u32 next;		/* stream offset of the next segment to send */
+	u32 acked;		/* stream offset acknowledged by wget */
+	int dup_acks;
+	bool got_request;
+	bool swapped;
+	bool dropped;
+	bool retransmitted;
+	bool fin_sent;
+	bool closed;
+} sb_http;
+
+static u8 sb_http_body_byte(u32 pos)
+{
+	return (pos * 7 + (pos >> 8)) & 0xff;
+}
+
+static int sb_http_inject(struct udevice *dev, u8 flags, u32 offset, int len,
+			  const void *opt, int opt_len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	struct ethernet_hdr *eth;
+	struct ip_tcp_hdr *ip;
+	struct {
+		struct in_addr src;
+		struct in_addr dst;
+		u8 zero;
+		u8 proto;
+		u16 len;
+	} __attribute__((packed)) pseudo;
+	int hlen = TCP_HDR_SIZE + opt_len;
+	uchar *data;
+	int i;
+
+	if (priv->recv_packets >= PKTBUFSRX)
+		return -EOVERFLOW;
+
+	eth = (void *)priv->recv_packet_buffer[priv->recv_packets];
+	memcpy(eth->et_dest, net_ethaddr, ARP_HLEN);
+	memcpy(eth->et_src, priv->fake_host_hwaddr, ARP_HLEN);
+	eth->et_protlen = htons(PROT_IP);
+
+	ip = (void *)eth + ETHER_HDR_SIZE;
+	net_set_ip_header((uchar *)ip, net_ip, priv->fake_host_ipaddr,
+			  IP_HDR_SIZE + hlen + len, IPPROTO_TCP);
+	ip->tcp_src = htons(SB_HTTP_PORT);
+	ip->tcp_dst = htons(sb_http.cli_port);
+	ip->tcp_seq = htonl(SB_HTTP_ISS + 1 + offset - !!(flags & TCP_SYN));
+	ip->tcp_ack = htonl(sb_http.cli_nxt);
+	ip->tcp_hlen = (hlen / 4) << 4;
+	ip->tcp_flags = flags;
+	ip->tcp_win = htons(0xffff);
+	ip->tcp_xsum = 0;
+	ip->tcp_urg = 0;
+	memcpy((uchar *)ip + IP_TCP_HDR_SIZE, opt, opt_len);
+	data = (uchar *)ip + IP_HDR_SIZE + hlen;
+	for (i = 0; i < len; i++) {
+		u32 pos = offset + i;
+
+		data[i] = pos < sb_http.hdr_len ? sb_http.hdr[pos] :
+			sb_http_body_byte(pos - sb_http.hdr_len);
+	}
+
+	net_copy_ip(&pseudo.src, &ip->ip_src);
+	net_copy_ip(&pseudo.dst, &ip->ip_dst);
+	pseudo.zero = 0;
+	pseudo.proto = IPPROTO_TCP;
+	pseudo.len = htons(hlen + len);
+	ip->tcp_xsum = add_ip_checksums(sizeof(pseudo),
+			compute_ip_checksum(&pseudo, sizeof(pseudo)),
+			compute_ip_checksum(&ip->tcp_src, hlen + len));
+
+	priv->recv_packet_length[priv->recv_packets] =
+		ETHER_HDR_SIZE + IP_HDR_SIZE + hlen + len;
+	++priv->recv_packets;
+
+	return 0;
+}
+
+static void sb_http_send_segs(struct udevice *dev)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	u32 seg, len;
+
+	while (sb_http.next < sb_http.total &&
+	       sb_http.next < sb_http.acked + SB_HTTP_WINDOW * SB_HTTP_SEG &&
+	       priv->recv_packets < PKTBUFSRX) {
+		seg = sb_http.next / SB_HTTP_SEG;
+		len = min_t(u32, SB_HTTP_SEG, sb_http.total - sb_http.next);
+		if (seg == SB_HTTP_DROP_SEG && !sb_http.dropped) {
+			sb_http.dropped = true;
+		} else if (seg == SB_HTTP_SWAP_SEG && !sb_http.swapped) {
+			if (priv->recv_packets + 2 > PKTBUFSRX)
+				break;
+			sb_http.swapped = true;
+			sb_http_inject(dev, TCP_ACK, sb_http.next + SB_HTTP_SEG,
+				       SB_HTTP_SEG, NULL, 0);
+			sb_http_inject(dev, TCP_ACK, sb_http.next, len, NULL, 0);
+			sb_http.next += SB_HTTP_SEG;
+		} else {
+			sb_http_inject(dev, TCP_ACK, sb_http.next, len, NULL,
+				       0);
+		}
+		sb_http.next += len;
+	}
+
+	if (sb_http.acked == sb_http.total && !sb_http.fin_sent &&
+	    !sb_http_inject(dev, TCP_FIN | TCP_ACK, sb_http.total, 0, NULL, 0))
+		sb_http.fin_sent = true;
+}
+
+static int sb_http_handler(struct udevice *dev, void *packet,
+			   unsigned int len)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	struct ethernet_hdr *eth = packet;
+	struct ip_tcp_hdr *ip = packet + ETHER_HDR_SIZE;
+	/* Used by all of the ut_assert macros */
+	struct unit_test_state *uts = priv->priv;
+	static const u8 syn_opts[] = {
+		TCP_O_MSS, 4, 0x05, 0xb4, TCP_O_NOP, TCP_O_SCL, 3, 2,
+	};
+	int hlen, dlen;
+	u32 ack;
+
+	if (!sandbox_eth_arp_req_to_reply(dev, packet, len))
+		return 0;
+	if (ntohs(eth->et_protlen) != PROT_IP || ip->ip_p != IPPROTO_TCP)
+		return 0;
+
+	ut_asserteq(SB_HTTP_PORT, ntohs(ip->tcp_dst));
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	dlen = ntohs(ip->ip_len) - IP_HDR_SIZE - hlen;
+
+	if (ip->tcp_flags & TCP_SYN) {
+		sb_http.cli_port = ntohs(ip->tcp_src);
+		sb_http.cli_nxt = ntohl(ip->tcp_seq) + 1;
+		sb_http_inject(dev, TCP_SYN | TCP_ACK, 0, 0, syn_opts,
+			       sizeof(syn_opts));
+		return 0;
+	}
+
+	ack = ntohl(ip->tcp_ack) - SB_HTTP_ISS - 1;
+	if (dlen) {
+		char *req = (char *)ip + IP_HDR_SIZE + hlen;
+
+		req[dlen] = '\0';
+		ut_assertnonnull(strstr(req, "GET /test.bin HTTP/1.1\r\n"));
+		ut_assertnonnull(strstr(req, "Connection: close\r\n"));
+		sb_http.got_request = true;
+		sb_http.cli_nxt += dlen;
+	} else if (ip->tcp_flags & TCP_FIN) {
+		sb_http.cli_nxt++;
+		sb_http.closed = true;
+		return 0;
+	} else if (sb_http.got_request && ack == sb_http.acked &&
+		   sb_http.acked < sb_http.total) {
+		/* With only three packets in flight, two duplicates will do */
+		if (++sb_http.dup_acks == 2) {
+			sb_http.next = sb_http.acked;
+			sb_http.retransmitted = true;
+		}
+	}
+	if (ack > sb_http.acked && ack <= sb_http.total) {
+		sb_http.acked = ack;
+		sb_http.dup_acks = 0;
+	}
+	if (sb_http.got_request)
+		sb_http_send_segs(dev);
+
+	return 0;
+}
+
+static int dm_test_eth_wget(struct unit_test_state *uts)
+{
+	u8 *buf;
+	int i;
+
+	memset(&sb_http, '\0', sizeof(sb_http));
+	sb_http.hdr_len = snprintf(sb_http.hdr, sizeof(sb_http.hdr),
+				   "HTTP/1.1 200 OK\r\n"
+				   "Content-Type: application/octet-stream\r\n"
+				   "content-length: %d\r\n\r\n",
+				   SB_HTTP_BODY_LEN);
+	sb_http.total = sb_http.hdr_len + SB_HTTP_BODY_LEN;
+
+	sandbox_eth_set_tx_handler(0, sb_http_handler);
+	/* Used by all of the ut_assert macros in the tx_handler */
+	sandbox_eth_set_priv(0, uts);
+
+	env_set("ethact", "eth@10002000");
+	net_server_ip = string_to_ip("1.1.2.2");
+	strcpy(net_boot_file_name, "test.bin");
+	load_addr = 0x1000000;
+	buf = map_sysmem(load_addr, SB_HTTP_BODY_LEN);
+	memset(buf, '\0', SB_HTTP_BODY_LEN);
+
+	ut_asserteq(SB_HTTP_BODY_LEN, net_loop(WGET));
+	ut_asserteq(SB_HTTP_BODY_LEN, env_get_hex("filesize", 0));
+	for (i = 0; i < SB_HTTP_BODY_LEN; i++)
+		ut_asserteq(sb_http_body_byte(i), buf[i]);
+	unmap_sysmem(buf);
+
+	/* Check that the reordered and lost segments were handled */
+	ut_assert(sb_http.swapped);
+	ut_assert(sb_http.dropped);
+	ut_assert(sb_http.retransmitted);
+	ut_assert(sb_http.fin_sent);
+
+	sandbox_eth_set_tx_handler(0, NULL);
+
+	return 0;
+}
+
+DM_TEST(dm_test_eth_wget, DM_TESTF_SCAN_FDT);
+
+/* Test that wget does not write past the free memory at the load address */
+static int dm_test_eth_wget_no_space(struct unit_test_state *uts)
+{
+	struct lmb lmb;
+	ulong free;
+	u8 *buf;
+	int i;
+
+	memset(&sb_http, '\0', sizeof(sb_http));
+	sb_http.hdr_len = snprintf(sb_http.hdr, sizeof(sb_http.hdr),
+				   "HTTP/1.1 200 OK\r\n"
+				   "Content-Length: %d\r\n\r\n",
+				   SB_HTTP_BODY_LEN);
+	sb_http.total = sb_http.hdr_len + SB_HTTP_BODY_LEN;
+
+	sandbox_eth_set_tx_handler(0, sb_http_handler);
+	sandbox_eth_set_priv(0, uts);
+	env_set("ethact", "eth@10002000");
+	net_server_ip = string_to_ip("1.1.2.2");
+	strcpy(net_boot_file_name, "test.bin");
+
+	/* Leave room for only half of the file */
+	lmb_init_and_reserve(&lmb, env_get_bootm_low(), env_get_bootm_size());
+	free = lmb_get_free_size(&lmb, 0x1000000);
+	ut_assert(free > SB_HTTP_BODY_LEN);
+	load_addr = 0x1000000 + free - SB_HTTP_BODY_LEN / 2;
+	buf = map_sysmem(load_addr, SB_HTTP_BODY_LEN / 2);
+	memset(buf, '\0', SB_HTTP_BODY_LEN / 2);
+	ut_assert(net_loop(WGET) < 0);
+	ut_assert(sb_http.got_request);
+	for (i = 0; i < SB_HTTP_BODY_LEN / 2; i++)
+		ut_asserteq(0, buf[i]);
+	unmap_sysmem(buf);
+
+	/* Nothing is requested if the load address is in use */
+	memset(&sb_http, '\0', sizeof(sb_http));
+	load_addr = 0x1000000 + free;
+	ut_assert(net_loop(WGET) < 0);
+	ut_assert(!sb_http.got_request);
+
+	sandbox_eth_set_tx_handler(0, NULL);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_wget_no_space, DM_TESTF_SCAN_FDT);
+#endif
@@ -6,6 +6,7 @@
 #include <common.h>
 #include <dm.h>
 #include <mmc.h>
+#include <warm_state.h>
 #include <dm/test.h>
 #include <test/ut.h>
 
@@ -41,3 +42,66 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that modes which failed in an earlier phase are not tried again */
+static int dm_test_mmc_warm_state(struct unit_test_state *uts)
+{
+	const struct mmc_warm_state *ws;
+	struct mmc_warm_state new_ws;
+	struct blk_desc *dev_desc;
+	struct mmc *mmc;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	mmc = find_mmc_device(0);
+	ut_assertnonnull(mmc);
+	ut_asserteq(SD_HS, mmc->selected_mode);
+
+	/* The state is saved once a mode is selected */
+	ws = warm_state_find(UCLASS_MMC, 0, sizeof(*ws));
+	ut_assertnonnull(ws);
+	ut_assertok(memcmp(mmc->cid, ws->cid, sizeof(ws->cid)));
+	ut_asserteq(mmc->failed_caps, ws->failed_caps);
+
+	/* Pretend the selected mode failed last time */
+	memcpy(&new_ws, ws, sizeof(new_ws));
+	new_ws.failed_caps = MMC_CAP(SD_HS);
+	ut_assertok(warm_state_save(UCLASS_MMC, 0, &new_ws, sizeof(new_ws)));
+	mmc->has_init = 0;
+	ut_assertok(mmc_init(mmc));
+	ut_asserteq(SD_LEGACY, mmc->selected_mode);
+	ut_asserteq(MMC_CAP(SD_HS), mmc->failed_caps);
+
+	/* The state is ignored if the card has changed */
+	new_ws.cid[0]++;
+	ut_assertok(warm_state_save(UCLASS_MMC, 0, &new_ws, sizeof(new_ws)));
+	mmc->has_init = 0;
+	ut_assertok(mmc_init(mmc));
+	ut_asserteq(SD_HS, mmc->selected_mode);
+	ut_asserteq(0, mmc->failed_caps);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_warm_state, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that writes follow the rules for pre-defined and open-ended transfers */
+static int dm_test_mmc_write(struct unit_test_state *uts)
+{
+	struct blk_desc *dev_desc;
+	char buf[512 * 4];
+	struct mmc *mmc;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	mmc = find_mmc_device(0);
+	ut_assertnonnull(mmc);
+	ut_asserteq(SD_SCR_CMD23_SUPPORT, mmc->scr[0] & SD_SCR_CMD23_SUPPORT);
+
+	memset(buf, 0xa5, sizeof(buf));
+	ut_asserteq(1, blk_dwrite(dev_desc, 0, 1, buf));
+	ut_asserteq(4, blk_dwrite(dev_desc, 0, 4, buf));
+
+	/* Reads are still open-ended, so need STOP_TRANSMISSION */
+	ut_asserteq(2, blk_dread(dev_desc, 0, 2, buf));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_write, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
@@ -2,6 +2,7 @@
 
 #include <common.h>
 #include <dm.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
 #include <dm/test.h>
 #include <test/ut.h>
@@ -58,3 +59,73 @@ static int dm_test_ofnode_fmap(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_ofnode_fmap, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Count nodes compatible with @compat, optionally without using the index */
+static int count_compatible(const char *compat, bool scan)
+{
+	struct device_node *np;
+	int count = 0;
+
+	if (scan) {
+		for_each_of_allnodes(np) {
+			if (of_device_is_compatible(np, compat, NULL, NULL))
+				count++;
+		}
+	} else {
+		for (np = of_find_compatible_node(NULL, NULL, compat); np;
+		     np = of_find_compatible_node(np, NULL, compat))
+			count++;
+	}
+
+	return count;
+}
+
+static int dm_test_ofnode_live_index(struct unit_test_state *uts)
+{
+	const char *compat = "denx,u-boot-fdt-test";
+	struct device_node node = {};
+	struct property prop = {};
+	struct device_node *np;
+	int count;
+
+	if (!of_live_active()) {
+		printf("Live tree not active; ignore test\n");
+		return 0;
+	}
+
+	/* Property names are interned when the tree is built */
+	ut_assert(of_prop_name_id("compatible") >= 0);
+	ut_assert(of_prop_name_id("name") >= 0);
+	ut_asserteq(-ENOENT, of_prop_name_id("no-such-property"));
+	np = of_find_node_by_path("/a-test");
+	ut_assertnonnull(np);
+	ut_asserteq(1234, be32_to_cpup(of_get_property(np, "int-value",
+						       NULL)));
+	ut_assertnull(of_find_property(np, "no-such-property", NULL));
+
+	/* IDs of a node outside the indexed tree are compared by name */
+	prop.name = "int-value";
+	prop.id = of_prop_name_id("compatible");
+	node.properties = &prop;
+	ut_asserteq_ptr(&prop, of_find_property(&node, "int-value", NULL));
+	ut_assertnull(of_find_property(&node, "compatible", NULL));
+
+	/* The index must give the same nodes, in order, as a scan */
+	count = count_compatible(compat, true);
+	ut_assert(count > 1);
+	ut_asserteq(count, count_compatible(compat, false));
+	ut_asserteq(count_compatible("DENX,U-Boot-FDT-Test", true),
+		    count_compatible("DENX,U-Boot-FDT-Test", false));
+	ut_asserteq(0, count_compatible("no-such-compatible", false));
+
+	/* Starting from a node without that compatible string falls back */
+	ut_asserteq_ptr(of_find_compatible_node(NULL, NULL, compat),
+			of_find_compatible_node(gd->of_root, NULL, compat));
+
+	of_compat_index_drop();
+	ut_asserteq(count, count_compatible(compat, false));
+	ut_assertok(of_compat_index_build());
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_live_index, DM_TESTF_SCAN_FDT);
@@ -794,3 +794,137 @@ static int dm_test_read_int(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_read_int, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(OF_PHANDLE_CACHE)
+#define PHANDLE_TEST_NODES	1500
+#define PHANDLE_TEST_SIZE	(320 << 10)
+#define PHANDLE_TEST_LOOKUPS	200
+
+/* Create a flat tree of about 240KB with a phandle in every node */
+static int make_phandle_tree(struct unit_test_state *uts, void *blob)
+{
+	char pad[64];
+	char name[20];
+	int i;
+
+	memset(pad, '\0', sizeof(pad));
+	ut_assertok(fdt_create(blob, PHANDLE_TEST_SIZE));
+	ut_assertok(fdt_finish_reservemap(blob));
+	ut_assertok(fdt_begin_node(blob, ""));
+	for (i = 1; i <= PHANDLE_TEST_NODES; i++) {
+		snprintf(name, sizeof(name), "node@%x", i);
+		ut_assertok(fdt_begin_node(blob, name));
+		ut_assertok(fdt_property_string(blob, "compatible",
+						"sandbox,phandle-test"));
+		ut_assertok(fdt_property_u32(blob, "reg", i));
+		ut_assertok(fdt_property(blob, "data", pad, sizeof(pad)));
+		ut_assertok(fdt_property_u32(blob, "phandle", i));
+		ut_assertok(fdt_end_node(blob));
+	}
+	ut_assertok(fdt_end_node(blob));
+	ut_assertok(fdt_finish(blob));
+	ut_assert(fdt_totalsize(blob) > 200 << 10);
+
+	/* Allow the tree to be modified */
+	ut_assertok(fdt_open_into(blob, blob, PHANDLE_TEST_SIZE));
+
+	return 0;
+}
+
+/* Test the phandle cache gives the same results as scanning the tree */
+static int dm_test_fdt_phandle_cache(struct unit_test_state *uts)
+{
+	struct fdtdec_phandle_cache *cache;
+	uint phandle, hits, builds;
+	void *blob;
+	int i, node;
+
+	blob = malloc(PHANDLE_TEST_SIZE);
+	ut_assertnonnull(blob);
+	ut_assertok(make_phandle_tree(uts, blob));
+
+	ut_assertok(fdtdec_phandle_cache_build(blob));
+	cache = gd->phandle_cache;
+	ut_assertnonnull(cache);
+	ut_asserteq(PHANDLE_TEST_NODES, cache->max_phandle);
+	hits = cache->hits;
+	builds = cache->builds;
+	for (phandle = 1; phandle <= PHANDLE_TEST_NODES; phandle++)
+		ut_asserteq(fdt_node_offset_by_phandle(blob, phandle),
+			    fdtdec_node_offset_by_phandle(blob, phandle));
+	ut_asserteq(hits + PHANDLE_TEST_NODES, cache->hits);
+	ut_asserteq(-FDT_ERR_NOTFOUND,
+		    fdtdec_node_offset_by_phandle(blob, PHANDLE_TEST_NODES + 1));
+	ut_asserteq(-FDT_ERR_BADPHANDLE, fdtdec_node_offset_by_phandle(blob, 0));
+
+	/* Phandles near the end of the tree come from the cache too */
+	hits = cache->hits;
+	for (i = 0; i < PHANDLE_TEST_LOOKUPS; i++) {
+		phandle = PHANDLE_TEST_NODES - i % 16;
+		ut_asserteq(fdt_node_offset_by_phandle(blob, phandle),
+			    fdtdec_node_offset_by_phandle(blob, phandle));
+	}
+	ut_asserteq(hits + PHANDLE_TEST_LOOKUPS, cache->hits);
+	ut_asserteq(builds, cache->builds);
+
+	/* Growing a node moves everything after it, so the cache is rebuilt */
+	node = fdtdec_node_offset_by_phandle(blob, 1);
+	ut_assertok(fdt_setprop_string(blob, node, "status", "okay"));
+	ut_asserteq(fdt_node_offset_by_phandle(blob, PHANDLE_TEST_NODES),
+		    fdtdec_node_offset_by_phandle(blob, PHANDLE_TEST_NODES));
+	ut_asserteq(builds + 1, cache->builds);
+
+	/* Sparse phandles are still found, by scanning the tree */
+	node = fdtdec_node_offset_by_phandle(blob, 2);
+	ut_assertok(fdt_setprop_u32(blob, node, "phandle", 0x10000));
+	ut_asserteq(node, fdtdec_node_offset_by_phandle(blob, 0x10000));
+	ut_asserteq(-ENOSPC, fdtdec_phandle_cache_build(blob));
+	ut_asserteq(node, fdtdec_node_offset_by_phandle(blob, 0x10000));
+
+	fdtdec_phandle_cache_invalidate();
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_phandle_cache, 0);
+
+#ifdef CONFIG_UT_BENCH
+/* Compare the speed of the phandle cache with scanning the tree */
+static int dm_test_fdt_phandle_cache_bench(struct unit_test_state *uts)
+{
+	ulong start, scan_us, cache_us;
+	uint phandle;
+	void *blob;
+	int i;
+
+	blob = malloc(PHANDLE_TEST_SIZE);
+	ut_assertnonnull(blob);
+	ut_assertok(make_phandle_tree(uts, blob));
+	ut_assertok(fdtdec_phandle_cache_build(blob));
+
+	/* Look up phandles near the end of the tree, the worst case */
+	start = timer_get_us();
+	for (i = 0; i < PHANDLE_TEST_LOOKUPS; i++) {
+		phandle = PHANDLE_TEST_NODES - i % 16;
+		ut_assert(fdt_node_offset_by_phandle(blob, phandle) > 0);
+	}
+	scan_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < PHANDLE_TEST_LOOKUPS; i++) {
+		phandle = PHANDLE_TEST_NODES - i % 16;
+		ut_assert(fdtdec_node_offset_by_phandle(blob, phandle) > 0);
+	}
+	cache_us = timer_get_us() - start;
+	printf("%d lookups in %dKB tree: scan %lu us, cache %lu us\n",
+	       PHANDLE_TEST_LOOKUPS, fdt_totalsize(blob) >> 10, scan_us,
+	       cache_us);
+
+	fdtdec_phandle_cache_invalidate();
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_phandle_cache_bench, 0);
+#endif
+#endif
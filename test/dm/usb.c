@@ -6,11 +6,15 @@
 #include <common.h>
 #include <console.h>
 #include <dm.h>
+#include <hexdump.h>
+#include <malloc.h>
 #include <usb.h>
 #include <asm/io.h>
 #include <asm/state.h>
 #include <asm/test.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
+#include <dm/root.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/ut.h>
@@ -55,6 +59,54 @@ static int dm_test_usb_flash(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_usb_flash, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/*
+ * Test a read which needs several READ(10) commands, so that all but the
+ * first are sent in batches. The flash stick reads 20 blocks per command, so
+ * reading the same blocks 20 at a time does not use batches.
+ */
+static int dm_test_usb_flash_batch(struct unit_test_state *uts)
+{
+	const int blocks = 95, per_cmd = 20;
+	struct blk_desc *dev_desc;
+	struct udevice *dev;
+	char *buf, *cmp;
+	int i, len;
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 0, &dev));
+	ut_assertok(blk_get_device_by_str("usb", "0", &dev_desc));
+
+	len = blocks * dev_desc->blksz;
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	ut_assertnonnull(buf);
+	cmp = memalign(ARCH_DMA_MINALIGN, len);
+	ut_assertnonnull(cmp);
+	for (i = 0; i < blocks; i += per_cmd) {
+		int count = min(blocks - i, per_cmd);
+
+		ut_asserteq(count, blk_dread(dev_desc, i, count,
+					     cmp + i * dev_desc->blksz));
+	}
+	ut_asserteq_str("this is a test", cmp);
+
+	/* Each command must read the right blocks into the right place */
+	memset(buf, '\xff', len);
+	ut_asserteq(blocks, blk_dread(dev_desc, 0, blocks, buf));
+	ut_asserteq_mem(cmp, buf, len);
+
+	/* The device is left ready for the next command */
+	memset(buf, '\xff', dev_desc->blksz);
+	ut_asserteq(1, blk_dread(dev_desc, 0, 1, buf));
+	ut_asserteq_mem(cmp, buf, dev_desc->blksz);
+	free(cmp);
+	free(buf);
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_flash_batch, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /* test that we can handle multiple storage devices */
 static int dm_test_usb_multi(struct unit_test_state *uts)
 {
@@ -71,6 +123,60 @@ static int dm_test_usb_multi(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_usb_multi, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/* Find the UAS flash stick, which comes after the three on usb@1 */
+static int find_uas_stick(struct unit_test_state *uts, struct udevice **devp,
+			  struct blk_desc **descp)
+{
+	struct udevice *blk;
+
+	ut_assertok(uclass_get_device(UCLASS_MASS_STORAGE, 3, devp));
+	ut_assertok(device_find_first_child(*devp, &blk));
+	*descp = dev_get_uclass_platdata(blk);
+
+	return 0;
+}
+
+/* test that a device offering UAS is switched to it, unless told not to */
+static int dm_test_usb_uas(struct unit_test_state *uts)
+{
+	struct blk_desc *dev_desc;
+	struct usb_device *udev;
+	struct udevice *dev;
+	char cmp[1024];
+
+	/* The controller is disabled so that the other tests do not see it */
+	ut_assertok(device_bind_driver_to_node(dm_root(), "usb_sandbox",
+					       "usb@3", ofnode_path("/usb@3"),
+					       &dev));
+
+	state_set_skip_delays(true);
+	ut_assertok(usb_init());
+	ut_assertok(find_uas_stick(uts, &dev, &dev_desc));
+	udev = dev_get_parent_priv(dev);
+	ut_asserteq(1, udev->config.if_desc[0].act_altsetting);
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(2, blk_dread(dev_desc, 0, 2, cmp));
+	ut_assertok(strcmp(cmp, "this is a test"));
+	ut_assertok(usb_stop());
+
+	/* the device should stay with bulk-only transport if it is ignored */
+	env_set("usb_uas_ignore", "1234:5678");
+	ut_assertok(usb_init());
+	ut_assertok(find_uas_stick(uts, &dev, &dev_desc));
+	udev = dev_get_parent_priv(dev);
+	ut_asserteq(0, udev->config.if_desc[0].act_altsetting);
+
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(2, blk_dread(dev_desc, 0, 2, cmp));
+	ut_assertok(strcmp(cmp, "this is a test"));
+	env_set("usb_uas_ignore", NULL);
+	ut_assertok(usb_stop());
+
+	return 0;
+}
+DM_TEST(dm_test_usb_uas, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 static int count_usb_devices(void)
 {
 	struct udevice *hub;
@@ -11,10 +11,13 @@
 #include <os.h>
 #include <video.h>
 #include <video_console.h>
+#include <dm/device-internal.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/ut.h>
 
+#define BENCH_LINES	10000
+
 /*
  * These tests use the standard sandbox frame buffer, the resolution of which
  * is defined in the device tree. This only supports 16bpp so the tests only
@@ -272,6 +275,239 @@ static int dm_test_video_rotation3(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_rotation3, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/**
+ * check_damage() - Check that all changes are inside the damaged area
+ *
+ * @uts:	Test state
+ * @dev:	Video device
+ * @old:	Copy of the frame buffer from before the changes
+ * @return 0 on success
+ */
+static int check_damage(struct unit_test_state *uts, struct udevice *dev,
+			u16 *old)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_bbox *damage = &priv->damage;
+	u16 *fb = priv->fb;
+	int x, y, i;
+
+	ut_assert(damage->x0 < damage->x1);
+	for (y = 0, i = 0; y < priv->ysize; y++) {
+		for (x = 0; x < priv->xsize; x++, i++) {
+			if (fb[i] == old[i])
+				continue;
+			ut_assert(x >= damage->x0 && x < damage->x1);
+			ut_assert(y >= damage->y0 && y < damage->y1);
+		}
+	}
+
+	/* Start again for the next check */
+	video_sync(dev, true);
+	ut_asserteq(0, damage->x1 - damage->x0);
+	memcpy(old, priv->fb, priv->fb_size);
+
+	return 0;
+}
+
+/* Check the damage recorded by a console for each type of operation */
+static int check_console_damage(struct unit_test_state *uts, int rot,
+				const char *drv_name)
+{
+	struct sandbox_sdl_plat *plat;
+	struct vidconsole_priv *vc_priv;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	u16 *old;
+
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	plat = dev_get_platdata(dev);
+	plat->rot = rot;
+	plat->vidconsole_drv_name = drv_name;
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	vc_priv = dev_get_uclass_priv(con);
+
+	/* Panning moves the display without writing to the frame buffer */
+	ut_assertok(video_set_pan(dev, false));
+
+	/* The display is cleared on probe */
+	ut_asserteq(0, priv->damage.x0);
+	ut_asserteq(priv->xsize, priv->damage.x1);
+	ut_asserteq(priv->ysize, priv->damage.y1);
+	video_sync(dev, true);
+
+	old = malloc(priv->fb_size);
+	ut_assertnonnull(old);
+	memcpy(old, priv->fb, priv->fb_size);
+
+	/* A character only damages its own cell */
+	ut_assert(vidconsole_putc_xy(con, VID_TO_POS(3 * vc_priv->x_charsize),
+				     2 * vc_priv->y_charsize, 'W') > 0);
+	ut_assert((priv->damage.x1 - priv->damage.x0) *
+		  (priv->damage.y1 - priv->damage.y0) <
+		  4 * vc_priv->x_charsize * vc_priv->y_charsize);
+	ut_assertok(check_damage(uts, dev, old));
+
+	ut_assertok(vidconsole_set_row(con, 3, priv->colour_fg));
+	ut_assertok(check_damage(uts, dev, old));
+
+	ut_assertok(vidconsole_move_rows(con, 0, 2, 2));
+	ut_assertok(check_damage(uts, dev, old));
+	free(old);
+
+	return 0;
+}
+
+/* Test that only the changed parts of the display are synced */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	int rot;
+
+	for (rot = 0; rot < 4; rot++)
+		ut_assertok(check_console_damage(uts, rot, NULL));
+	ut_assertok(check_console_damage(uts, 0, "vidconsole0"));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that the shadow frame buffer is copied to the display on sync */
+static int dm_test_video_copy(struct unit_test_state *uts)
+{
+	struct video_uc_platdata *plat;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	plat = dev_get_uclass_platdata(dev);
+	priv = dev_get_uclass_priv(dev);
+	ut_assertnonnull(priv->copy_fb);
+	ut_asserteq(plat->shadow_base, map_to_sysmem(priv->fb));
+	ut_asserteq(plat->base, map_to_sysmem(priv->copy_fb));
+
+	video_sync(dev, true);
+	ut_assertok(memcmp(priv->fb, priv->copy_fb, priv->fb_size));
+
+	/* Drawing only changes the shadow buffer until the next sync */
+	ut_assert(vidconsole_putc_xy(con, 0, 0, 'a') > 0);
+	ut_assert(memcmp(priv->fb, priv->copy_fb, priv->fb_size));
+	video_sync(dev, true);
+	ut_assertok(memcmp(priv->fb, priv->copy_fb, priv->fb_size));
+
+	return 0;
+}
+DM_TEST(dm_test_video_copy, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/**
+ * print_lines() - Probe the video device and print numbered lines on it
+ *
+ * @uts:	Test state
+ * @pan:	true to allow scrolling by panning the display
+ * @count:	Number of lines to print
+ * @devp:	Returns the video device
+ * @usp:	Returns the time taken to print the lines, in microseconds
+ * @return 0 on success
+ */
+static int print_lines(struct unit_test_state *uts, bool pan, int count,
+		       struct udevice **devp, ulong *usp)
+{
+	struct udevice *dev, *con;
+	char str[20];
+	ulong start;
+	int i;
+
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	if (!pan)
+		ut_assertok(video_set_pan(dev, false));
+
+	start = timer_get_us();
+	for (i = 0; i < count; i++) {
+		snprintf(str, sizeof(str), "line %d\n", i);
+		vidconsole_put_string(con, str);
+	}
+	video_sync(dev, true);
+	*usp = timer_get_us() - start;
+	*devp = dev;
+
+	return 0;
+}
+
+/* Test that scrolling by panning gives the same display as moving rows */
+static int dm_test_video_pan(struct unit_test_state *uts)
+{
+	struct vidconsole_priv *vc_priv;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	void *expect;
+	ulong us;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(print_lines(uts, false, 150, &dev, &us));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq(0, priv->yoffset);
+	expect = malloc(priv->fb_size);
+	ut_assertnonnull(expect);
+	memcpy(expect, priv->fb, priv->fb_size);
+
+	/* Each new line at the bottom pans the display down by one row */
+	ut_assertok(print_lines(uts, true, 60, &dev, &us));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	vc_priv = dev_get_uclass_priv(con);
+	ut_asserteq((60 - vc_priv->rows + 1) * vc_priv->y_charsize,
+		    priv->yoffset);
+
+	/* This wraps around to the start of the frame buffer */
+	ut_assertok(print_lines(uts, true, 150, &dev, &us));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(memcmp(expect, priv->fb, priv->fb_size));
+
+	/* Disabling panning moves the display back to the start */
+	ut_assertok(video_set_pan(dev, false));
+	ut_asserteq(0, priv->yoffset);
+	ut_assertok(memcmp(expect, priv->fb, priv->fb_size));
+	ut_assertok(memcmp(priv->fb, priv->copy_fb, priv->fb_size));
+	free(expect);
+
+	return 0;
+}
+DM_TEST(dm_test_video_pan, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_UT_BENCH
+/* Compare the time taken to scroll the console by moving rows and panning */
+static int dm_test_video_scroll_bench(struct unit_test_state *uts)
+{
+	ulong move_us, pan_us;
+	struct video_priv *priv;
+	struct udevice *dev;
+	void *expect;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(print_lines(uts, false, BENCH_LINES, &dev, &move_us));
+	priv = dev_get_uclass_priv(dev);
+	expect = malloc(priv->fb_size);
+	ut_assertnonnull(expect);
+	memcpy(expect, priv->fb, priv->fb_size);
+
+	ut_assertok(print_lines(uts, true, BENCH_LINES, &dev, &pan_us));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(memcmp(expect, priv->fb, priv->fb_size));
+	free(expect);
+	printf("%d lines: move rows %lu us, pan %lu us\n", BENCH_LINES,
+	       move_us, pan_us);
+
+	return 0;
+}
+DM_TEST(dm_test_video_scroll_bench, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
+
 /* Read a file into memory and return a pointer to it */
 static int read_file(struct unit_test_state *uts, const char *fname,
 		     ulong *addrp)
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for selecting a FIT configuration which matches the board
+ */
+
+#include <common.h>
+#include <image.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+#define FDT_SIZE	1024
+#define FIT_SIZE	4096
+
+/* Create a device tree with a root compatible string list */
+static int make_fdt(void *buf, const char *compat, int len)
+{
+	int ret;
+
+	ret = fdt_create(buf, FDT_SIZE);
+	ret |= fdt_finish_reservemap(buf);
+	ret |= fdt_begin_node(buf, "");
+	ret |= fdt_property(buf, FIT_COMPAT_PROP, compat, len);
+	ret |= fdt_end_node(buf);
+	ret |= fdt_finish(buf);
+
+	return ret;
+}
+
+/*
+ * Create a FIT with three configurations:
+ *	conf-1 has no compatible property, so fdt-1 must be checked
+ *	conf-2 has a compatible property and refers to a missing fdt image
+ *	conf-3 has a compatible property which overrides that of fdt-1
+ */
+static int make_fit(void *fit, void *fdt)
+{
+	int ret;
+
+	ret = make_fdt(fdt, "vendor,other", sizeof("vendor,other"));
+	ret |= fdt_create(fit, FIT_SIZE);
+	ret |= fdt_finish_reservemap(fit);
+	ret |= fdt_begin_node(fit, "");
+	ret |= fdt_begin_node(fit, "images");
+	ret |= fdt_begin_node(fit, "fdt-1");
+	ret |= fdt_property(fit, FIT_DATA_PROP, fdt, fdt_totalsize(fdt));
+	ret |= fdt_end_node(fit);
+	ret |= fdt_end_node(fit);
+
+	ret |= fdt_begin_node(fit, "configurations");
+	ret |= fdt_begin_node(fit, "conf-1");
+	ret |= fdt_property_string(fit, FIT_FDT_PROP, "fdt-1");
+	ret |= fdt_end_node(fit);
+	ret |= fdt_begin_node(fit, "conf-2");
+	ret |= fdt_property_string(fit, FIT_COMPAT_PROP, "vendor,board");
+	ret |= fdt_property_string(fit, FIT_FDT_PROP, "fdt-missing");
+	ret |= fdt_end_node(fit);
+	ret |= fdt_begin_node(fit, "conf-3");
+	ret |= fdt_property_string(fit, FIT_COMPAT_PROP, "vendor,board-rev2");
+	ret |= fdt_property_string(fit, FIT_FDT_PROP, "fdt-1");
+	ret |= fdt_end_node(fit);
+	ret |= fdt_end_node(fit);
+
+	ret |= fdt_end_node(fit);
+	ret |= fdt_finish(fit);
+
+	return ret;
+}
+
+/* Find the name of the configuration which best matches a board */
+static const char *find_compat(const void *fit, void *board, const char *compat,
+			       int len)
+{
+	int node;
+
+	if (make_fdt(board, compat, len))
+		return NULL;
+	node = fit_conf_find_compat(fit, board);
+	if (node < 0)
+		return "none";
+
+	return fit_get_name(fit, node, NULL);
+}
+
+/* Test matching using configuration and fdt compatible strings */
+static int lib_test_fit_conf_find_compat(struct unit_test_state *uts)
+{
+	char fit[FIT_SIZE], fdt[FDT_SIZE], board[FDT_SIZE];
+
+	ut_assertok(make_fit(fit, fdt));
+
+	/* The first string in the board's list is the best match */
+	ut_asserteq_str("conf-3", find_compat(fit, board,
+		"vendor,board-rev2\0vendor,board",
+		sizeof("vendor,board-rev2\0vendor,board")));
+	ut_asserteq_str("conf-2", find_compat(fit, board,
+		"vendor,board-rev1\0vendor,board",
+		sizeof("vendor,board-rev1\0vendor,board")));
+
+	/* conf-3 has its own compatible, so does not match using fdt-1 */
+	ut_asserteq_str("conf-1", find_compat(fit, board, "vendor,other",
+					      sizeof("vendor,other")));
+	ut_asserteq_str("none", find_compat(fit, board, "vendor,unknown",
+					    sizeof("vendor,unknown")));
+
+	return 0;
+}
+DM_TEST(lib_test_fit_conf_find_compat, 0);
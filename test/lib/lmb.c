@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the logical memory blocks (lmb) library
+ */
+
+#include <common.h>
+#include <lmb.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+#define RAM_BASE	0x40000000
+#define RAM_SIZE	0x10000000
+
+static int lib_test_lmb_get_free_size(struct unit_test_state *uts)
+{
+	struct lmb lmb;
+
+	lmb_init(&lmb);
+	ut_assertok(lmb_add(&lmb, RAM_BASE, RAM_SIZE));
+
+	/* With nothing reserved, everything up to the end of RAM is free */
+	ut_asserteq(RAM_SIZE, lmb_get_free_size(&lmb, RAM_BASE));
+	ut_asserteq(0x1000, lmb_get_free_size(&lmb,
+					      RAM_BASE + RAM_SIZE - 0x1000));
+
+	/* Reserve in the opposite order to how the regions are sorted */
+	ut_assertok(lmb_reserve(&lmb, RAM_BASE + 0x8000000, 0x2000));
+	ut_assertok(lmb_reserve(&lmb, RAM_BASE + 0x4000000, 0x1000));
+
+	/* Stop at the next reserved region */
+	ut_asserteq(0x4000000, lmb_get_free_size(&lmb, RAM_BASE));
+	ut_asserteq(0x4000000 - 0x1000,
+		    lmb_get_free_size(&lmb, RAM_BASE + 0x4001000));
+	ut_asserteq(RAM_SIZE - 0x8002000,
+		    lmb_get_free_size(&lmb, RAM_BASE + 0x8002000));
+
+	/* Nothing is free within a reserved region */
+	ut_asserteq(0, lmb_get_free_size(&lmb, RAM_BASE + 0x4000000));
+	ut_asserteq(0, lmb_get_free_size(&lmb, RAM_BASE + 0x4000fff));
+	ut_asserteq(0, lmb_get_free_size(&lmb, RAM_BASE + 0x8001000));
+
+	/* Nor outside RAM */
+	ut_asserteq(0, lmb_get_free_size(&lmb, RAM_BASE - 1));
+	ut_asserteq(0, lmb_get_free_size(&lmb, RAM_BASE + RAM_SIZE));
+
+	return 0;
+}
+DM_TEST(lib_test_lmb_get_free_size, 0);
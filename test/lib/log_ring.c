@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the in-memory log ring
+ */
+
+#include <common.h>
+#include <log.h>
+#include <mapmem.h>
+#include <dm/test.h>
+#include <test/ut.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define TEST_RING_SIZE	512
+#define TEST_MSG	"abcdefghijklmnopqrstuvwxyz0123456789"
+
+/* Check the records in the ring and return the number found */
+static int check_ring(struct unit_test_state *uts, struct log_ring_hdr *ring)
+{
+	struct log_ring_rec *rrec;
+	u32 offset, seq = 0;
+	int count = 0;
+
+	ut_assert(ring->head - ring->tail <= ring->size);
+	for (offset = ring->tail; offset != ring->head; offset += rrec->size) {
+		rrec = (void *)(ring + 1) + offset % ring->size;
+		ut_assert(rrec->size);
+		ut_asserteq(0, rrec->size % LOG_RING_ALIGN);
+		if (rrec->flags & LOGRF_PAD)
+			continue;
+		ut_assert(offset % ring->size + rrec->size <= ring->size);
+		ut_asserteq(strlen(rrec->msg), rrec->msg_len);
+		ut_asserteq(LOGL_DEBUG, rrec->level);
+		ut_asserteq(LOGC_BOARD, rrec->cat);
+		if (count)
+			ut_asserteq(seq + 1, rrec->seq);
+		seq = rrec->seq;
+		count++;
+	}
+
+	return count;
+}
+
+/* Test adding records to the ring, wrapping and dropping old records */
+static int lib_test_log_ring(struct unit_test_state *uts)
+{
+	struct log_ring_hdr *old_ring = gd->log_ring;
+	struct log_ring_hdr *ring;
+	struct log_ring_rec *rrec;
+	const fdt64_t *prop;
+	u64 addr, size;
+	char fdt[256];
+	int node;
+	int i;
+
+	ring = calloc(1, sizeof(*ring) + TEST_RING_SIZE);
+	ut_assertnonnull(ring);
+	ring->magic = LOG_RING_MAGIC;
+	ring->hdr_size = sizeof(*ring);
+	ring->size = TEST_RING_SIZE;
+	gd->log_ring = ring;
+
+	/* Debug records are not shown on the console, but are kept */
+	ut_assertok(_log(LOGC_BOARD, LOGL_DEBUG, "file.c", 123, "func",
+			 "msg %d\n", 1));
+	rrec = (void *)(ring + 1);
+	ut_asserteq(ALIGN(sizeof(*rrec) + 7, LOG_RING_ALIGN), rrec->size);
+	ut_asserteq(rrec->size, ring->head);
+	log_flush();
+	ut_asserteq(ring->head, ring->emit);
+	ut_asserteq(123, rrec->line);
+	ut_asserteq_str("file.c", (char *)(ulong)rrec->file);
+	ut_asserteq_str("func", (char *)(ulong)rrec->func);
+	ut_asserteq_str("msg 1\n", rrec->msg);
+	ut_asserteq(1, check_ring(uts, ring));
+
+	/* Fill the ring several times over with records of varying size */
+	for (i = 2; i < 60; i++) {
+		ut_assertok(_log(LOGC_BOARD, LOGL_DEBUG, "file.c", i, "func",
+				 "%.*s\n", i % 37, TEST_MSG));
+		ut_assert(check_ring(uts, ring) > 0);
+	}
+	ut_asserteq(59, ring->seq);
+	ut_asserteq(0, ring->drop_count);
+	log_flush();
+	ut_asserteq(ring->head, ring->emit);
+
+	/* A record which cannot fit is dropped */
+	ring->size = sizeof(*rrec);
+	ring->head = 0;
+	ring->tail = 0;
+	ring->emit = 0;
+	ut_asserteq(-ENOSPC, _log(LOGC_BOARD, LOGL_DEBUG, "file.c", 1, "func",
+				  "too big\n"));
+	ut_asserteq(1, ring->drop_count);
+	ring->size = TEST_RING_SIZE;
+
+	/* The OS is told where to find the ring */
+	ut_assertok(fdt_create_empty_tree(fdt, sizeof(fdt)));
+	ut_assertok(log_ring_fdt_fixup(fdt));
+	ut_asserteq(1, fdt_num_mem_rsv(fdt));
+	ut_assertok(fdt_get_mem_rsv(fdt, 0, &addr, &size));
+	ut_asserteq(map_to_sysmem(ring), addr);
+	ut_asserteq(sizeof(*ring) + TEST_RING_SIZE, size);
+	node = fdt_path_offset(fdt, "/chosen");
+	ut_assert(node >= 0);
+	prop = fdt_getprop(fdt, node, "u-boot,log-ring", NULL);
+	ut_assertnonnull(prop);
+	ut_asserteq(addr, fdt64_to_cpu(prop[0]));
+	ut_asserteq(size, fdt64_to_cpu(prop[1]));
+
+	gd->log_ring = old_ring;
+	free(ring);
+
+	return 0;
+}
+
+DM_TEST(lib_test_log_ring, 0);
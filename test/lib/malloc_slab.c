@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the slab allocator for small malloc() requests
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <malloc.h>
+#include <dm/device-internal.h>
+#include <dm/lists.h>
+#include <dm/root.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+#define BENCH_DEVS	200
+#define BENCH_ROUNDS	5
+
+/* Test allocating, resizing and freeing small objects */
+static int lib_test_malloc_slab(struct unit_test_state *uts)
+{
+	struct malloc_slab_stats before, after;
+	struct mallinfo start, end;
+	char *ptr, *other;
+	bool old;
+	int i;
+
+	ut_assertok(malloc_slab_get_stats(24, &before));
+	start = mallinfo();
+	ptr = malloc(24);
+	ut_assertnonnull(ptr);
+	ut_assert(malloc_slab_owns(ptr));
+	ut_asserteq(32, malloc_usable_size(ptr));
+	ut_assertok(malloc_slab_get_stats(24, &after));
+	ut_asserteq(32, after.obj_size);
+	ut_asserteq(before.allocs + 1, after.allocs);
+	ut_asserteq(before.in_use + 1, after.in_use);
+
+	/* mallinfo() counts the object, not the slab area */
+	end = mallinfo();
+	ut_asserteq(start.uordblks + 32, end.uordblks);
+
+	/* Growing within the size class does not move the object */
+	for (i = 0; i < 24; i++)
+		ptr[i] = i;
+	ut_asserteq_ptr(ptr, realloc(ptr, 32));
+
+	/* Growing into a larger class keeps the contents */
+	other = realloc(ptr, 100);
+	ut_assertnonnull(other);
+	ut_assert(malloc_slab_owns(other));
+	ut_asserteq(128, malloc_usable_size(other));
+	for (i = 0; i < 24; i++)
+		ut_asserteq(i, other[i]);
+
+	/* Growing beyond the slab allocator moves it to the heap */
+	ptr = realloc(other, MALLOC_SLAB_MAX + 1);
+	ut_assertnonnull(ptr);
+	ut_assert(!malloc_slab_owns(ptr));
+	for (i = 0; i < 24; i++)
+		ut_asserteq(i, ptr[i]);
+	free(ptr);
+
+	/* A freed object is reused and cleared by calloc() */
+	ptr = malloc(40);
+	memset(ptr, '\xff', 40);
+	free(ptr);
+	other = calloc(1, 40);
+	ut_asserteq_ptr(ptr, other);
+	for (i = 0; i < 40; i++)
+		ut_asserteq(0, other[i]);
+	free(other);
+
+	/* Strict alignment needs a real chunk */
+	ptr = memalign(64, 40);
+	ut_assertnonnull(ptr);
+	ut_assert(!malloc_slab_owns(ptr));
+	ut_asserteq(0, (ulong)ptr & 63);
+	free(ptr);
+
+	ptr = malloc(MALLOC_SLAB_MAX + 1);
+	ut_assert(!malloc_slab_owns(ptr));
+	free(ptr);
+	ut_asserteq(-E2BIG, malloc_slab_get_stats(MALLOC_SLAB_MAX + 1,
+						  &after));
+
+	/* When disabled, objects come from the heap */
+	old = malloc_slab_enable(false);
+	ut_assert(old);
+	ptr = malloc(24);
+	ut_assert(!malloc_slab_owns(ptr));
+	malloc_slab_enable(old);
+	free(ptr);
+
+	end = mallinfo();
+	ut_asserteq(start.uordblks, end.uordblks);
+	ut_assertok(malloc_slab_get_stats(24, &after));
+	ut_asserteq(before.in_use, after.in_use);
+
+	return 0;
+}
+DM_TEST(lib_test_malloc_slab, 0);
+
+#ifdef CONFIG_UT_BENCH
+/* Bind, probe, remove and unbind a batch of devices, returning the time */
+static int bench_bind_probe(struct unit_test_state *uts, ulong *usp)
+{
+	struct udevice *devs[BENCH_DEVS];
+	ulong start;
+	int round, i;
+
+	start = timer_get_us();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < BENCH_DEVS; i++)
+			ut_assertok(device_bind_driver(dm_root(), "test_drv",
+						       "bench", &devs[i]));
+		for (i = 0; i < BENCH_DEVS; i++)
+			ut_assertok(device_probe(devs[i]));
+		for (i = 0; i < BENCH_DEVS; i++) {
+			ut_assertok(device_remove(devs[i], DM_REMOVE_NORMAL));
+			ut_assertok(device_unbind(devs[i]));
+		}
+	}
+	*usp = timer_get_us() - start;
+
+	return 0;
+}
+
+/* Allocate and free a batch of small objects, returning the time */
+static int bench_alloc(struct unit_test_state *uts, ulong *usp)
+{
+	void *ptrs[BENCH_DEVS * 4];
+	ulong start;
+	int round, i;
+
+	start = timer_get_us();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		for (i = 0; i < ARRAY_SIZE(ptrs); i++) {
+			ptrs[i] = calloc(1, 8 + i % MALLOC_SLAB_MAX);
+			ut_assertnonnull(ptrs[i]);
+		}
+		for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+			free(ptrs[i]);
+	}
+	*usp = timer_get_us() - start;
+
+	return 0;
+}
+
+/* Compare driver-model performance with and without the slab allocator */
+static int lib_test_malloc_slab_bench(struct unit_test_state *uts)
+{
+	struct dm_test_state *dms = uts->priv;
+	ulong slab_us, heap_us, slab_alloc_us, heap_alloc_us;
+	bool old;
+
+	/* The test uclass expects platform data after probing */
+	dms->skip_post_probe = true;
+	old = malloc_slab_enable(false);
+	ut_assertok(bench_bind_probe(uts, &heap_us));
+	ut_assertok(bench_alloc(uts, &heap_alloc_us));
+	malloc_slab_enable(true);
+	ut_assertok(bench_bind_probe(uts, &slab_us));
+	ut_assertok(bench_alloc(uts, &slab_alloc_us));
+	malloc_slab_enable(old);
+	printf("%d x %d devices: dlmalloc %lu us, slab %lu us\n",
+	       BENCH_ROUNDS, BENCH_DEVS, heap_us, slab_us);
+	printf("%d x %d objects: dlmalloc %lu us, slab %lu us\n",
+	       BENCH_ROUNDS, BENCH_DEVS * 4, heap_alloc_us, slab_alloc_us);
+	malloc_stats();
+
+	return 0;
+}
+DM_TEST(lib_test_malloc_slab_bench, 0);
+#endif
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the sampling profiler
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <prof.h>
+#include <dm/test.h>
+#include <test/ut.h>
+#include <asm/sections.h>
+
+/* Keep the CPU busy for a while, inside this function */
+static noinline ulong prof_test_busy(ulong loops)
+{
+	volatile ulong val = 0;
+	ulong i;
+
+	for (i = 0; i < loops; i++)
+		val += i;
+
+	return val;
+}
+
+/* Test that samples are recorded and can be written out for proftool */
+static int lib_test_prof(struct unit_test_state *uts)
+{
+	ulong offset = (ulong)prof_test_busy - (ulong)&_init;
+	ulong samples, outside, start, busy;
+	struct trace_output_func *rec;
+	struct trace_output_hdr *hdr;
+	uint needed;
+	void *buff;
+	int i;
+
+	ut_asserteq(-EINVAL, prof_start(0));
+	ut_assertok(prof_start(PROF_DEFAULT_HZ));
+	ut_asserteq(-EBUSY, prof_start(PROF_DEFAULT_HZ));
+	start = get_timer(0);
+	while (get_timer(start) < 200)
+		prof_test_busy(100000);
+	prof_stop();
+	prof_get_stats(&samples, &outside);
+	ut_assert(samples > 20);
+
+	/* Samples are not taken once the profiler has stopped */
+	prof_test_busy(10000000);
+	prof_get_stats(&busy, &outside);
+	ut_asserteq(samples, busy);
+
+	/* Samples can also be added directly */
+	prof_sample((ulong)&_init + 3);
+	prof_sample((ulong)&_init - 1);
+	prof_get_stats(&busy, &outside);
+	ut_asserteq(samples + 1, busy);
+	ut_assert(outside > 0);
+
+	/* Most of the samples should be in the busy loop */
+	ut_asserteq(-ENOSPC, prof_list_samples(NULL, 0, &needed));
+	buff = malloc(needed);
+	ut_assertnonnull(buff);
+	ut_assertok(prof_list_samples(buff, needed, &needed));
+	hdr = buff;
+	ut_asserteq(TRACE_CHUNK_SAMPLES, hdr->type);
+	ut_asserteq(needed, sizeof(*hdr) + hdr->rec_count * sizeof(*rec));
+	rec = buff + sizeof(*hdr);
+	ut_asserteq(0, rec->offset);
+	for (i = busy = 0; i < hdr->rec_count; i++, rec++) {
+		ut_assert(rec->call_count);
+		if (rec->offset >= offset && rec->offset < offset + 0x100)
+			busy += rec->call_count;
+	}
+	ut_assert(busy > samples / 2);
+	free(buff);
+
+	return 0;
+}
+
+DM_TEST(lib_test_prof, 0);
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Known-answer tests for SHA1 and SHA256, which may use architecture-specific
+ * block functions
+ */
+
+#include <common.h>
+#include <hexdump.h>
+#include <malloc.h>
+#include <dm/test.h>
+#include <test/ut.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+/* The million 'a' test is hashed in chunks of this size */
+#define CHUNK_LEN	1000
+
+/* Test vectors from FIPS 180-2 appendices A and B */
+static const struct {
+	const char *input;	/* NULL for one million 'a' characters */
+	const char *sha1;
+	const char *sha256;
+} sha_test_vectors[] = {
+	{
+		"abc",
+		"a9993e364706816aba3e25717850c26c9cd0d89d",
+		"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+	}, {
+		"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+		"84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+		"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+	}, {
+		NULL,
+		"34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+		"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+	},
+};
+
+/**
+ * sha_test_input() - Set up the input for a test vector
+ *
+ * The data is placed at an odd address, so that an architecture-specific
+ * block function must cope with unaligned data.
+ *
+ * @input:	Input string, or NULL for a chunk of 'a' characters
+ * @lenp:	Returns the number of bytes to hash
+ * @countp:	Returns the number of times to hash them
+ * @return buffer to free when done, with the data at offset 1, or NULL if out
+ * of memory
+ */
+static u8 *sha_test_input(const char *input, int *lenp, int *countp)
+{
+	u8 *buf;
+
+	*lenp = input ? strlen(input) : CHUNK_LEN;
+	*countp = input ? 1 : 1000000 / CHUNK_LEN;
+	buf = malloc(*lenp + 1);
+	if (!buf)
+		return NULL;
+	if (input)
+		memcpy(buf + 1, input, *lenp);
+	else
+		memset(buf + 1, 'a', *lenp);
+
+	return buf;
+}
+
+#ifdef CONFIG_SHA1
+static int lib_test_sha1(struct unit_test_state *uts)
+{
+	u8 expect[SHA1_SUM_LEN], digest[SHA1_SUM_LEN];
+	sha1_context ctx;
+	int i, j, len, count;
+	u8 *buf;
+
+	for (i = 0; i < ARRAY_SIZE(sha_test_vectors); i++) {
+		buf = sha_test_input(sha_test_vectors[i].input, &len, &count);
+		ut_assertnonnull(buf);
+		sha1_starts(&ctx);
+		for (j = 0; j < count; j++)
+			sha1_update(&ctx, buf + 1, len);
+		sha1_finish(&ctx, digest);
+		free(buf);
+		ut_assertok(hex2bin(expect, sha_test_vectors[i].sha1,
+				    SHA1_SUM_LEN));
+		ut_asserteq_mem(expect, digest, SHA1_SUM_LEN);
+	}
+
+	return 0;
+}
+DM_TEST(lib_test_sha1, 0);
+#endif
+
+#ifdef CONFIG_SHA256
+static int lib_test_sha256(struct unit_test_state *uts)
+{
+	u8 expect[SHA256_SUM_LEN], digest[SHA256_SUM_LEN];
+	sha256_context ctx;
+	int i, j, len, count;
+	u8 *buf;
+
+	for (i = 0; i < ARRAY_SIZE(sha_test_vectors); i++) {
+		buf = sha_test_input(sha_test_vectors[i].input, &len, &count);
+		ut_assertnonnull(buf);
+		sha256_starts(&ctx);
+		for (j = 0; j < count; j++)
+			sha256_update(&ctx, buf + 1, len);
+		sha256_finish(&ctx, digest);
+		free(buf);
+		ut_assertok(hex2bin(expect, sha_test_vectors[i].sha256,
+				    SHA256_SUM_LEN));
+		ut_asserteq_mem(expect, digest, SHA256_SUM_LEN);
+	}
+
+	return 0;
+}
+DM_TEST(lib_test_sha256, 0);
+#endif
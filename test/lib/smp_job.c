@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for running jobs on secondary CPUs
+ */
+
+#include <common.h>
+#include <smp_job.h>
+#include <dm/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+#define TEST_JOBS	(SMP_JOB_QUEUE_LEN * 2 + 5)
+#define TEST_CHUNK	4096
+
+struct test_job {
+	struct smp_job job;
+	const u8 *data;
+	u32 crc;
+};
+
+static int test_job_crc(void *arg)
+{
+	struct test_job *tjob = arg;
+
+	tjob->crc = crc32(0, tjob->data, TEST_CHUNK);
+
+	return 0;
+}
+
+static int test_job_fail(void *arg)
+{
+	return (long)arg;
+}
+
+/* Test that jobs run on the worker CPUs and give the right results */
+static int lib_test_smp_job(struct unit_test_state *uts)
+{
+	struct test_job *tjobs;
+	struct smp_job jobs[3];
+	u8 *buf;
+	int i;
+
+	buf = malloc(TEST_JOBS * TEST_CHUNK);
+	tjobs = calloc(TEST_JOBS, sizeof(*tjobs));
+	ut_assertnonnull(buf);
+	ut_assertnonnull(tjobs);
+	for (i = 0; i < TEST_JOBS * TEST_CHUNK; i++)
+		buf[i] = i * 13 + (i >> 8);
+
+	/* More jobs than the queue can hold */
+	for (i = 0; i < TEST_JOBS; i++) {
+		tjobs[i].data = buf + i * TEST_CHUNK;
+		smp_job_init(&tjobs[i].job, test_job_crc, &tjobs[i]);
+		smp_job_queue(&tjobs[i].job);
+	}
+	ut_asserteq(CONFIG_SMP_JOB_MAX_WORKERS, smp_job_get_workers());
+	for (i = 0; i < TEST_JOBS; i++) {
+		ut_asserteq(0, smp_job_wait(&tjobs[i].job));
+		ut_asserteq(crc32(0, buf + i * TEST_CHUNK, TEST_CHUNK),
+			    tjobs[i].crc);
+	}
+
+	/* The first error is returned */
+	smp_job_init(&jobs[0], test_job_fail, (void *)0);
+	smp_job_init(&jobs[1], test_job_fail, (void *)-EINVAL);
+	smp_job_init(&jobs[2], test_job_fail, (void *)-ENOENT);
+	ut_asserteq(-EINVAL, smp_job_run(jobs, ARRAY_SIZE(jobs)));
+	ut_asserteq(-ENOENT, jobs[2].ret);
+
+	/* Stopping parks the workers; they start again when needed */
+	smp_job_stop();
+	ut_asserteq(0, smp_job_get_workers());
+	smp_job_init(&jobs[0], test_job_fail, (void *)-EIO);
+	ut_asserteq(-EIO, smp_job_run(jobs, 1));
+	ut_asserteq(CONFIG_SMP_JOB_MAX_WORKERS, smp_job_get_workers());
+	smp_job_stop();
+
+	free(tjobs);
+	free(buf);
+
+	return 0;
+}
+
+DM_TEST(lib_test_smp_job, 0);
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the mem*() string functions, which may be provided by
+ * architecture-specific code
+ */
+
+#include <common.h>
+#include <hexdump.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+#define BUFLEN		160
+#define MAXLEN		100
+#define MAXOFFSET	16
+
+static void init_buffer(u8 *buf, u8 seed)
+{
+	int i;
+
+	for (i = 0; i < BUFLEN; i++)
+		buf[i] = seed + i * 7;
+}
+
+static int lib_test_memcpy(struct unit_test_state *uts)
+{
+	u8 src[BUFLEN], dst[BUFLEN];
+	int doff, soff, len, i;
+
+	init_buffer(src, 0x11);
+	for (doff = 0; doff < MAXOFFSET; doff++) {
+		for (soff = 0; soff < MAXOFFSET; soff++) {
+			for (len = 0; len < MAXLEN; len++) {
+				init_buffer(dst, 0xa3);
+				ut_asserteq_ptr(dst + doff,
+						memcpy(dst + doff, src + soff,
+						       len));
+				for (i = 0; i < BUFLEN; i++) {
+					u8 expect = i >= doff && i < doff + len ?
+						src[soff + i - doff] :
+						(u8)(0xa3 + i * 7);
+
+					ut_asserteq(expect, dst[i]);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+DM_TEST(lib_test_memcpy, 0);
+
+static int lib_test_memmove(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN], ref[BUFLEN];
+	int doff, soff, len, i;
+
+	for (doff = 0; doff < 2 * MAXOFFSET; doff++) {
+		for (soff = 0; soff < 2 * MAXOFFSET; soff++) {
+			for (len = 0; len < MAXLEN; len++) {
+				init_buffer(buf, 0x37);
+				init_buffer(ref, 0x37);
+				for (i = 0; i < len; i++)
+					ref[doff + i] = buf[soff + i];
+				ut_asserteq_ptr(buf + doff,
+						memmove(buf + doff, buf + soff,
+							len));
+				ut_asserteq_mem(ref, buf, BUFLEN);
+			}
+		}
+	}
+
+	return 0;
+}
+
+DM_TEST(lib_test_memmove, 0);
+
+static int lib_test_memset(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int off, len, i;
+
+	for (off = 0; off < MAXOFFSET; off++) {
+		for (len = 0; len < MAXLEN; len++) {
+			init_buffer(buf, 0x5c);
+			ut_asserteq_ptr(buf + off,
+					memset(buf + off, len & 1 ? 0x1c3 : 0,
+					       len));
+			for (i = 0; i < BUFLEN; i++) {
+				u8 expect = i >= off && i < off + len ?
+					(len & 1 ? 0xc3 : 0) :
+					(u8)(0x5c + i * 7);
+
+				ut_asserteq(expect, buf[i]);
+			}
+		}
+	}
+
+	return 0;
+}
+
+DM_TEST(lib_test_memset, 0);
+
+static int lib_test_memcmp(struct unit_test_state *uts)
+{
+	u8 a[BUFLEN], b[BUFLEN];
+	int aoff, boff, len, pos;
+
+	init_buffer(a, 0x42);
+	for (aoff = 0; aoff < MAXOFFSET; aoff++) {
+		for (boff = 0; boff < MAXOFFSET; boff++) {
+			for (len = 0; len < MAXLEN; len += 3) {
+				memset(b, '\0', sizeof(b));
+				memcpy(b + boff, a + aoff, len);
+				ut_asserteq(0, memcmp(a + aoff, b + boff, len));
+
+				/* The result is the difference of the bytes */
+				for (pos = 0; pos < len; pos += 5) {
+					b[boff + pos] = a[aoff + pos] + 0x90;
+					ut_asserteq(a[aoff + pos] - b[boff + pos],
+						    memcmp(a + aoff, b + boff,
+							   len));
+					b[boff + pos] = a[aoff + pos];
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+DM_TEST(lib_test_memcmp, 0);
@@ -13,3 +13,11 @@ def test_handoff(u_boot_console):
     cons = u_boot_console
     response = cons.run_command('sb handoff')
     assert ('SPL handoff magic %x' % TEST_HANDOFF_MAGIC) in response
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('spl_warm_state')
+def test_handoff_warm_state(u_boot_console):
+    """Test that device state saved in SPL is available in U-Boot proper"""
+    cons = u_boot_console
+    response = cons.run_command('sb handoff')
+    assert ('SPL warm state magic %x' % TEST_HANDOFF_MAGIC) in response
@@ -167,6 +167,15 @@ def test_vboot(u_boot_console):
         util.run_and_log(cons, [fit_check_sign, '-f', fit, '-k', tmpdir,
                                 '-k', dtb])
 
+        # The signature must also cover data moved outside the FIT
+        cons.log.action('%s: Check signed config with external data' %
+                        sha_algo)
+        util.run_and_log(cons, [mkimage, '-E', '-D', dtc_args, '-k', tmpdir,
+                                '-K', dtb, '-r', '-f',
+                                '%ssign-configs-%s%s.its' %
+                                (datadir, sha_algo, padding), ext_fit])
+        util.run_and_log(cons, [fit_check_sign, '-f', ext_fit, '-k', dtb])
+
         # Replace header bytes
         bcfg = u_boot_console.config.buildconfig
         max_size = int(bcfg.get('config_fit_signature_max_size', 0x10000000), 0)
@@ -200,6 +209,7 @@ def test_vboot(u_boot_console):
     tmp = tmpdir + 'vboot.tmp'
     datadir = cons.config.source_dir + '/test/py/tests/vboot/'
     fit = '%stest.fit' % tmpdir
+    ext_fit = '%stest-ext.fit' % tmpdir
     mkimage = cons.config.build_dir + '/tools/mkimage'
     fit_check_sign = cons.config.build_dir + '/tools/fit_check_sign'
     dtc_args = '-I dts -O dtb -i %s' % tmpdir
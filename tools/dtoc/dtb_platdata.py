@@ -41,6 +41,13 @@ TYPE_NAMES = {
     fdt.TYPE_INT64: 'fdt64_t',
 }
 
+# Properties which mean that a node is needed before relocation
+PRE_RELOC_PROPS = [
+    'u-boot,dm-pre-reloc',
+    'u-boot,dm-spl',
+    'u-boot,dm-tpl',
+]
+
 STRUCT_PREFIX = 'dtd_'
 VAL_PREFIX = 'dtv_'
 
@@ -137,14 +144,16 @@ class DtbPlatdata(object):
         _dtb_fname: Filename of the input device tree binary file
         _valid_nodes: A list of Node object with compatible strings
         _include_disabled: true to include nodes marked status = "disabled"
+        _pre_reloc: true to mark devices which are needed before relocation
         _outfile: The current output file (sys.stdout or a real file)
         _lines: Stashed list of output lines for outputting in the future
     """
-    def __init__(self, dtb_fname, include_disabled):
+    def __init__(self, dtb_fname, include_disabled, pre_reloc=False):
         self._fdt = None
         self._dtb_fname = dtb_fname
         self._valid_nodes = None
         self._include_disabled = include_disabled
+        self._pre_reloc = pre_reloc
         self._outfile = None
         self._lines = []
         self._aliases = {}
@@ -512,6 +521,9 @@ class DtbPlatdata(object):
         self.buf('\t.name\t\t= "%s",\n' % struct_name)
         self.buf('\t.platdata\t= &%s%s,\n' % (VAL_PREFIX, var_name))
         self.buf('\t.platdata_size\t= sizeof(%s%s),\n' % (VAL_PREFIX, var_name))
+        if self._pre_reloc and any(name in node.props
+                                   for name in PRE_RELOC_PROPS):
+            self.buf('\t.flags\t\t= DM_FLAG_PRE_RELOC,\n')
         self.buf('};\n')
         self.buf('\n')
 
@@ -546,7 +558,7 @@ class DtbPlatdata(object):
             nodes_to_output.remove(node)
 
 
-def run_steps(args, dtb_file, include_disabled, output):
+def run_steps(args, dtb_file, include_disabled, output, pre_reloc=False):
     """Run all the steps of the dtoc tool
 
     Args:
@@ -554,11 +566,13 @@ def run_steps(args, dtb_file, include_disabled, output):
         dtb_file: Filename of dtb file to process
         include_disabled: True to include disabled nodes
         output: Name of output file
+        pre_reloc: True to add DM_FLAG_PRE_RELOC to devices whose nodes are
+            marked as needed before relocation
     """
     if not args:
         raise ValueError('Please specify a command: struct, platdata')
 
-    plat = DtbPlatdata(dtb_file, include_disabled)
+    plat = DtbPlatdata(dtb_file, include_disabled, pre_reloc)
     plat.scan_dtb()
     plat.scan_tree()
     plat.scan_reg_sizes()
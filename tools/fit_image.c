@@ -24,7 +24,7 @@
 static image_header_t header;
 
 static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
-			     const char *tmpfile)
+			     const char *tmpfile, const struct fit_ext_data *ext)
 {
 	int tfd, destfd = 0;
 	void *dest_blob = NULL;
@@ -58,7 +58,7 @@ static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 
 	if (!ret) {
 		ret = fit_add_verification_data(params->keydir, dest_blob, ptr,
-						params->comment,
+						ext, params->comment,
 						params->require_keys,
 						params->engine_id,
 						params->cmdname);
@@ -396,23 +396,54 @@ err_buf:
 	return -1;
 }
 
+/**
+ * fit_write_data() - Write image data to a file, padded to a multiple of 4
+ *
+ * @fd:		File to write to
+ * @data:	Data to write
+ * @len:	Length of data in bytes
+ * @return number of bytes written including padding, or -EIO on error
+ */
+static int fit_write_data(int fd, const void *data, int len)
+{
+	static const char pad[3];
+	int pad_len = -len & 3;
+
+	if (write(fd, data, len) != len ||
+	    write(fd, pad, pad_len) != pad_len) {
+		debug("%s: Failed to write external data to file %s\n",
+		      __func__, strerror(errno));
+		return -EIO;
+	}
+
+	return len + pad_len;
+}
+
 /**
  * fit_extract_data() - Move all data outside the FIT
  *
  * This takes a normal FIT file and removes all the 'data' properties from it.
- * The data is placed in an area after the FIT so that it can be accessed
+ * The data is written to a separate file so that it can be accessed
  * using an offset into that area. The 'data' properties turn into
- * 'data-offset' properties.
+ * 'data-offset' properties, or 'data-position' properties if an external
+ * offset is set. Data which is already after the FIT, in an image with a
+ * 'data-offset' property, is moved too and keeps its offset.
+ *
+ * This is done before hashes and signatures are added, so that the FIT
+ * stays small while that happens and the signatures cover the final
+ * properties. Afterwards fit_append_data() places the data after the FIT.
  *
- * This function cannot cope with FITs with 'data-offset' properties. All
- * data must be in 'data' properties on entry.
+ * @params:	Image parameters
+ * @fname:	FIT file to update
+ * @datafname:	File to write the data to
+ * @return 0 if OK, -ve on error
  */
-static int fit_extract_data(struct image_tool_params *params, const char *fname)
+static int fit_extract_data(struct image_tool_params *params, const char *fname,
+			    const char *datafname)
 {
-	void *buf;
-	int buf_ptr;
+	int buf_ptr, data_base;
 	int fit_size, new_size;
-	int fd;
+	int fd, dfd;
 	struct stat sbuf;
 	void *fdt;
 	int ret;
@@ -423,57 +454,189 @@ static int fit_extract_data(struct image_tool_params *params, const char *fname)
 	if (fd < 0)
 		return -EIO;
 	fit_size = fdt_totalsize(fdt);
+	data_base = (fit_size + 3) & ~3;
 
-	/* Allocate space to hold the image data we will extract */
-	buf = malloc(fit_size);
-	if (!buf) {
-		ret = -ENOMEM;
+	dfd = open(datafname, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+	if (dfd < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n",
+			params->cmdname, datafname, strerror(errno));
+		ret = -EIO;
 		goto err_munmap;
 	}
+
+	/* Keep any data which is already external, at the same offsets */
 	buf_ptr = 0;
+	if (sbuf.st_size > data_base) {
+		buf_ptr = fit_write_data(dfd, fdt + data_base,
+					 sbuf.st_size - data_base);
+		if (buf_ptr < 0) {
+			ret = buf_ptr;
+			goto err;
+		}
+	}
+
+	/* Now that the data is safe, the FDT can use the rest of the file */
+	ret = fdt_open_into(fdt, fdt, sbuf.st_size);
+	if (ret) {
+		debug("%s: Failed to expand FIT: %s\n", __func__,
+		      fdt_strerror(ret));
+		ret = -EINVAL;
+		goto err;
+	}
 
 	images = fdt_path_offset(fdt, FIT_IMAGES_PATH);
 	if (images < 0) {
 		debug("%s: Cannot find /images node: %d\n", __func__, images);
 		ret = -EINVAL;
-		goto err_munmap;
+		goto err;
 	}
 
 	for (node = fdt_first_subnode(fdt, images);
 	     node >= 0;
 	     node = fdt_next_subnode(fdt, node)) {
 		const char *data;
+		int offset;
 		int len;
 
 		data = fdt_getprop(fdt, node, FIT_DATA_PROP, &len);
-		if (!data)
-			continue;
-		memcpy(buf + buf_ptr, data, len);
-		debug("Extracting data size %x\n", len);
+		if (data) {
+			debug("Extracting data size %x\n", len);
+			offset = buf_ptr;
+			ret = fit_write_data(dfd, data, len);
+			if (ret < 0)
+				goto err;
+			buf_ptr += ret;
+			ret = fdt_delprop(fdt, node, FIT_DATA_PROP);
+		} else {
+			offset = fdtdec_get_int(fdt, node, FIT_DATA_OFFSET_PROP,
+						-1);
+			len = fdtdec_get_int(fdt, node, FIT_DATA_SIZE_PROP, -1);
+			if (offset == -1 || len == -1)
+				continue;
+			ret = 0;
+		}
 
-		ret = fdt_delprop(fdt, node, FIT_DATA_PROP);
+		if (!ret && params->external_offset > 0) {
+			/* An external offset positions the data absolutely. */
+			ret = fdt_delprop(fdt, node, FIT_DATA_OFFSET_PROP);
+			if (ret == -FDT_ERR_NOTFOUND)
+				ret = 0;
+			if (!ret)
+				ret = fdt_setprop_u32(fdt, node,
+						      FIT_DATA_POSITION_PROP,
+						      params->external_offset +
+						      offset);
+		} else if (!ret) {
+			ret = fdt_setprop_u32(fdt, node, FIT_DATA_OFFSET_PROP,
+					      offset);
+		}
+		if (!ret)
+			ret = fdt_setprop_u32(fdt, node, FIT_DATA_SIZE_PROP,
+					      len);
 		if (ret) {
+			debug("%s: Failed to update properties: %s\n",
+			      __func__, fdt_strerror(ret));
 			ret = -EPERM;
-			goto err_munmap;
-		}
-		if (params->external_offset > 0) {
-			/* An external offset positions the data absolutely. */
-			fdt_setprop_u32(fdt, node, FIT_DATA_POSITION_PROP,
-					params->external_offset + buf_ptr);
-		} else {
-			fdt_setprop_u32(fdt, node, FIT_DATA_OFFSET_PROP,
-					buf_ptr);
+			goto err;
 		}
-		fdt_setprop_u32(fdt, node, FIT_DATA_SIZE_PROP, len);
-
-		buf_ptr += (len + 3) & ~3;
 	}
 
-	/* Pack the FDT and place the data after it */
+	/* Pack the FDT; the data is added back by fit_append_data() */
 	fdt_pack(fdt);
 
-	debug("Size reduced from %x to %x\n", fit_size, fdt_totalsize(fdt));
+	new_size = fdt_totalsize(fdt);
+	debug("Size reduced from %x to %x\n", (int)sbuf.st_size, new_size);
 	debug("External data size %x\n", buf_ptr);
+	munmap(fdt, sbuf.st_size);
+
+	if (ftruncate(fd, new_size)) {
+		debug("%s: Failed to truncate file: %s\n", __func__,
+		      strerror(errno));
+		ret = -EIO;
+		goto err_fdt;
+	}
+	close(dfd);
+	close(fd);
+
+	return 0;
+
+err:
+	munmap(fdt, sbuf.st_size);
+err_fdt:
+	close(dfd);
+err_munmap:
+	close(fd);
+	return ret;
+}
+
+/**
+ * fit_map_data() - Map the data written by fit_extract_data()
+ *
+ * @params:	Image parameters
+ * @datafname:	File holding the data
+ * @ext:	Returns the data, with @ext->data set to NULL if it is empty
+ * @return 0 if OK, -EIO on error
+ */
+static int fit_map_data(struct image_tool_params *params,
+			const char *datafname, struct fit_ext_data *ext)
+{
+	struct stat sbuf;
+	void *ptr;
+	int fd;
+
+	fd = open(datafname, O_RDONLY | O_BINARY);
+	if (fd < 0 || fstat(fd, &sbuf) < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n",
+			params->cmdname, datafname, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -EIO;
+	}
+	ext->data = NULL;
+	ext->size = sbuf.st_size;
+	ext->position = params->external_offset;
+	if (ext->size) {
+		ptr = mmap(0, ext->size, PROT_READ, MAP_SHARED, fd, 0);
+		if (ptr == MAP_FAILED) {
+			fprintf(stderr, "%s: Can't read %s: %s\n",
+				params->cmdname, datafname, strerror(errno));
+			close(fd);
+			return -EIO;
+		}
+		ext->data = ptr;
+	}
+	close(fd);
+
+	return 0;
+}
+
+/**
+ * fit_append_data() - Place the external data after the FIT
+ *
+ * This packs the FIT, which has been given hashes and signatures, and
+ * appends the data extracted by fit_extract_data(). The data is written
+ * straight from @ext, without being copied into memory first.
+ *
+ * @params:	Image parameters
+ * @fname:	FIT file to update
+ * @ext:	External data to append
+ * @return 0 if OK, -ve on error
+ */
+static int fit_append_data(struct image_tool_params *params, const char *fname,
+			   const struct fit_ext_data *ext)
+{
+	int new_size;
+	int fd;
+	struct stat sbuf;
+	void *fdt;
+	int ret;
+
+	fd = mmap_fdt(params->cmdname, fname, 0, &fdt, &sbuf, false);
+	if (fd < 0)
+		return -EIO;
+
+	/* Pack the FDT and place the data after it */
+	fdt_pack(fdt);
 	new_size = fdt_totalsize(fdt);
 	new_size = (new_size + 3) & ~3;
 	munmap(fdt, sbuf.st_size);
@@ -501,21 +664,14 @@ static int fit_extract_data(struct image_tool_params *params, const char *fname)
 		ret = -EIO;
 		goto err;
 	}
-	if (write(fd, buf, buf_ptr) != buf_ptr) {
+	if (write(fd, ext->data, ext->size) != ext->size) {
 		debug("%s: Failed to write external data to file %s\n",
 		      __func__, strerror(errno));
 		ret = -EIO;
 		goto err;
 	}
-	free(buf);
-	close(fd);
-	return 0;
-
-err_munmap:
-	munmap(fdt, sbuf.st_size);
+	ret = 0;
 err:
-	if (buf)
-		free(buf);
 	close(fd);
 	return ret;
 }
@@ -615,6 +771,90 @@ err_no_fd:
 	return ret;
 }
 
+/**
+ * fit_add_conf_compat() - Add a compatible property to each configuration
+ *
+ * This copies the root compatible string list from each configuration's
+ * first fdt image into the configuration node, so that U-Boot can select a
+ * configuration without looking inside the fdt images. Configurations which
+ * already have a compatible property are left alone, as are those whose fdt
+ * is compressed, since mkimage cannot uncompress it.
+ *
+ * @params:	Image parameters
+ * @size_inc:	Amount to expand the FIT by, to hold the new properties
+ * @fname:	FIT file to update
+ * @return 0 if OK, -ENOSPC if @size_inc is too small, other -ve on error
+ */
+static int fit_add_conf_compat(struct image_tool_params *params,
+			       size_t size_inc, const char *fname)
+{
+	int confs, images, node;
+	struct stat sbuf;
+	void *fit;
+	int ret = 0;
+	int fd;
+
+	fd = mmap_fdt(params->cmdname, fname, size_inc, &fit, &sbuf, false);
+	if (fd < 0)
+		return -EIO;
+
+	confs = fdt_path_offset(fit, FIT_CONFS_PATH);
+	images = fdt_path_offset(fit, FIT_IMAGES_PATH);
+	if (confs < 0 || images < 0)
+		goto out;
+
+	fdt_for_each_subnode(node, fit, confs) {
+		const char *fdt_name;
+		const void *data;
+		const char *compat;
+		char *copy;
+		int image;
+		uint8_t comp;
+		int len;
+
+		if (fdt_getprop(fit, node, FIT_COMPAT_PROP, NULL))
+			continue;
+		fdt_name = fdt_getprop(fit, node, FIT_FDT_PROP, NULL);
+		if (!fdt_name)
+			continue;
+		image = fdt_subnode_offset(fit, images, fdt_name);
+		if (image < 0)
+			continue;
+		if (fit_image_get_comp(fit, image, &comp) ||
+		    comp != IH_COMP_NONE)
+			continue;
+		data = fdt_getprop(fit, image, FIT_DATA_PROP, &len);
+		if (!data || len < sizeof(struct fdt_header) ||
+		    fdt_check_header(data) || fdt_totalsize(data) > len)
+			continue;
+		compat = fdt_getprop(data, 0, FIT_COMPAT_PROP, &len);
+		if (!compat)
+			continue;
+
+		/* Adding the property moves the data, so copy it first */
+		copy = malloc(len);
+		if (!copy) {
+			ret = -ENOMEM;
+			break;
+		}
+		memcpy(copy, compat, len);
+		ret = fdt_setprop(fit, node, FIT_COMPAT_PROP, copy, len);
+		free(copy);
+		if (ret) {
+			ret = ret == -FDT_ERR_NOSPACE ? -ENOSPC : -EIO;
+			break;
+		}
+		debug("Added compatible for configuration '%s'\n",
+		      fit_get_name(fit, node, NULL));
+	}
+
+out:
+	munmap(fit, sbuf.st_size);
+	close(fd);
+
+	return ret;
+}
+
 /**
  * fit_handle_file - main FIT file processing function
  *
@@ -630,7 +870,9 @@ err_no_fd:
 static int fit_handle_file(struct image_tool_params *params)
 {
 	char tmpfile[MKIMAGE_MAX_TMPFILE_LEN];
+	char datafile[MKIMAGE_MAX_TMPFILE_LEN];
 	char cmd[MKIMAGE_MAX_DTC_CMDLINE_LEN];
+	struct fit_ext_data ext_data, *ext = NULL;
 	size_t size_inc;
 	int ret;
 
@@ -639,13 +881,14 @@ static int fit_handle_file(struct image_tool_params *params)
 
 	/* call dtc to include binary properties into the tmp file */
 	if (strlen (params->imagefile) +
-		strlen (MKIMAGE_TMPFILE_SUFFIX) + 1 > sizeof (tmpfile)) {
+		strlen (MKIMAGE_TMPDATA_SUFFIX) + 1 > sizeof (tmpfile)) {
 		fprintf (stderr, "%s: Image file name (%s) too long, "
 				"can't create tmpfile",
 				params->imagefile, params->cmdname);
 		return (EXIT_FAILURE);
 	}
 	sprintf (tmpfile, "%s%s", params->imagefile, MKIMAGE_TMPFILE_SUFFIX);
+	sprintf(datafile, "%s%s", params->imagefile, MKIMAGE_TMPDATA_SUFFIX);
 
 	/* We either compile the source file, or use the existing FIT image */
 	if (params->auto_its) {
@@ -670,10 +913,38 @@ static int fit_handle_file(struct image_tool_params *params)
 		goto err_system;
 	}
 
-	/* Move the data so it is internal to the FIT, if needed */
-	ret = fit_import_data(params, tmpfile);
-	if (ret)
-		goto err_system;
+	/* Let U-Boot match configurations without looking at each fdt */
+	if (params->auto_its || params->datafile) {
+		for (size_inc = 0; size_inc < 64 * 1024; size_inc += 1024) {
+			ret = fit_add_conf_compat(params, size_inc, tmpfile);
+			if (ret != -ENOSPC)
+				break;
+		}
+		if (ret) {
+			fprintf(stderr, "%s: Can't add compatible to FIT: %d\n",
+				params->cmdname, ret);
+			goto err_system;
+		}
+	}
+
+	if (params->external_data) {
+		/*
+		 * Move the data so it is external to the FIT, as requested.
+		 * The FIT is then small, so adding hashes is quick, and the
+		 * data is hashed where it is.
+		 */
+		ret = fit_extract_data(params, tmpfile, datafile);
+		if (!ret)
+			ret = fit_map_data(params, datafile, &ext_data);
+		if (ret)
+			goto err_data;
+		ext = &ext_data;
+	} else {
+		/* Move the data so it is internal to the FIT, if needed */
+		ret = fit_import_data(params, tmpfile);
+		if (ret)
+			goto err_system;
+	}
 
 	/*
 	 * Set hashes for images in the blob. Unfortunately we may need more
@@ -686,7 +957,7 @@ static int fit_handle_file(struct image_tool_params *params)
 	 * steps of this loop is enough to sign with several keys.
 	 */
 	for (size_inc = 0; size_inc < 64 * 1024; size_inc += 1024) {
-		ret = fit_add_file_data(params, size_inc, tmpfile);
+		ret = fit_add_file_data(params, size_inc, tmpfile, ext);
 		if (!ret || ret != -ENOSPC)
 			break;
 	}
@@ -694,14 +965,17 @@ static int fit_handle_file(struct image_tool_params *params)
 	if (ret) {
 		fprintf(stderr, "%s Can't add hashes to FIT blob: %d\n",
 			params->cmdname, ret);
-		goto err_system;
+		goto err_data;
 	}
 
-	/* Move the data so it is external to the FIT, if requested */
-	if (params->external_data) {
-		ret = fit_extract_data(params, tmpfile);
+	/* Put the external data back after the FIT */
+	if (ext) {
+		ret = fit_append_data(params, tmpfile, ext);
 		if (ret)
-			goto err_system;
+			goto err_data;
+		if (ext->data)
+			munmap((void *)ext->data, ext->size);
+		unlink(datafile);
 	}
 
 	if (rename (tmpfile, params->imagefile) == -1) {
@@ -714,6 +988,11 @@ static int fit_handle_file(struct image_tool_params *params)
 	}
 	return EXIT_SUCCESS;
 
+err_data:
+	if (ext && ext->data)
+		munmap((void *)ext->data, ext->size);
+	if (params->external_data)
+		unlink(datafile);
 err_system:
 	unlink(tmpfile);
 	return -1;
@@ -11,8 +11,40 @@
 #include "mkimage.h"
 #include <bootm.h>
 #include <image.h>
+#include <smp_job.h>
 #include <version.h>
 
+/**
+ * struct fit_host_hash - Hash of an image, calculated before it is needed
+ *
+ * @job:	Job which calculates the hash
+ * @image_name:	Name of the image node
+ * @node_name:	Name of the hash node
+ * @algo:	Hash algorithm
+ * @data:	Data to hash, only valid until the job is done
+ * @size:	Size of the data in bytes
+ * @value:	Hash value
+ * @value_len:	Length of the hash value in bytes
+ */
+struct fit_host_hash {
+	struct smp_job job;
+	char *image_name;
+	char *node_name;
+	char *algo;
+	const void *data;
+	size_t size;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+};
+
+/*
+ * Hashes calculated by fit_image_hash_all(). The image data does not change
+ * when mkimage retries with more space in the FIT, so these are kept until
+ * mkimage exits.
+ */
+static struct fit_host_hash *host_hashes;
+static int host_hash_count;
+
 /**
  * fit_set_hash_value - set hash value in requested has node
  * @fit: pointer to the FIT format image header
@@ -43,6 +75,152 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 	return 0;
 }
 
+/**
+ * fit_image_get_host_data() - Get the data for an image
+ *
+ * @fit:	pointer to the FIT format image header
+ * @image_noffset: offset of the component image node
+ * @ext:	external image data, or NULL if none
+ * @datap:	returns a pointer to the data
+ * @sizep:	returns the size of the data in bytes
+ * @return 0 if ok, -ENOENT if the image has no data, -EINVAL if the data is
+ *	not inside @ext
+ */
+static int fit_image_get_host_data(const void *fit, int image_noffset,
+				   const struct fit_ext_data *ext,
+				   const void **datap, size_t *sizep)
+{
+	int offset, len;
+
+	if (!fit_image_get_data(fit, image_noffset, datap, sizep))
+		return 0;
+	if (!ext || fit_image_get_data_size(fit, image_noffset, &len))
+		return -ENOENT;
+	if (!fit_image_get_data_position(fit, image_noffset, &offset))
+		offset -= ext->position;
+	else if (fit_image_get_data_offset(fit, image_noffset, &offset))
+		return -ENOENT;
+	if (offset < 0 || len < 0 || offset + (size_t)len > ext->size)
+		return -EINVAL;
+	*datap = ext->data + offset;
+	*sizep = len;
+
+	return 0;
+}
+
+static int fit_host_hash_run(void *arg)
+{
+	struct fit_host_hash *hash = arg;
+
+	return calculate_hash(hash->data, hash->size, hash->algo, hash->value,
+			      &hash->value_len);
+}
+
+/**
+ * fit_host_hash_find() - Find a hash calculated by fit_image_hash_all()
+ *
+ * @image_name:	name of the image node
+ * @node_name:	name of the hash node
+ * @algo:	hash algorithm
+ * @size:	size of the image data in bytes
+ * @return hash found, or NULL if none
+ */
+static struct fit_host_hash *fit_host_hash_find(const char *image_name,
+						const char *node_name,
+						const char *algo, size_t size)
+{
+	int i;
+
+	for (i = 0; i < host_hash_count; i++) {
+		struct fit_host_hash *hash = &host_hashes[i];
+
+		if (!strcmp(hash->image_name, image_name) &&
+		    !strcmp(hash->node_name, node_name) &&
+		    !strcmp(hash->algo, algo) && hash->size == size)
+			return hash;
+	}
+
+	return NULL;
+}
+
+/**
+ * fit_image_hash_all() - Calculate the hashes of all images in parallel
+ *
+ * Images are often large, so calculating their hashes takes most of the
+ * time needed to build a FIT. This calculates them all at once, using a
+ * thread for each CPU, so that fit_image_process_hash() only needs to look
+ * them up. Hashes which cannot be calculated are left for
+ * fit_image_process_hash() to report.
+ *
+ * @fit:	pointer to the FIT format image header
+ * @images_noffset: offset of the /images node
+ * @ext:	external image data, or NULL if none
+ * @return 0 if ok, -ENOMEM if out of memory
+ */
+static int fit_image_hash_all(const void *fit, int images_noffset,
+			      const struct fit_ext_data *ext)
+{
+	struct fit_host_hash *hashes;
+	int image_noffset, noffset;
+	int count, i;
+
+	count = host_hash_count;
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		fdt_for_each_subnode(noffset, fit, image_noffset)
+			count++;
+	}
+	if (count == host_hash_count)
+		return 0;
+	hashes = realloc(host_hashes, count * sizeof(*hashes));
+	if (!hashes)
+		return -ENOMEM;
+	host_hashes = hashes;
+
+	count = host_hash_count;
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		const char *image_name;
+		const void *data;
+		size_t size;
+
+		if (fit_image_get_host_data(fit, image_noffset, ext, &data,
+					    &size))
+			continue;
+		image_name = fit_get_name(fit, image_noffset, NULL);
+		fdt_for_each_subnode(noffset, fit, image_noffset) {
+			const char *node_name = fit_get_name(fit, noffset, NULL);
+			struct fit_host_hash *hash = &host_hashes[count];
+			char *algo;
+
+			if (strncmp(node_name, FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)) ||
+			    fit_image_hash_get_algo(fit, noffset, &algo) ||
+			    fit_host_hash_find(image_name, node_name, algo,
+					       size))
+				continue;
+			hash->image_name = strdup(image_name);
+			hash->node_name = strdup(node_name);
+			hash->algo = strdup(algo);
+			if (!hash->image_name || !hash->node_name || !hash->algo)
+				return -ENOMEM;
+			hash->data = data;
+			hash->size = size;
+			smp_job_init(&hash->job, fit_host_hash_run, hash);
+			count++;
+		}
+	}
+
+	for (i = host_hash_count; i < count; i++)
+		smp_job_queue(&host_hashes[i].job);
+	for (i = host_hash_count; i < count; i++)
+		smp_job_wait(&host_hashes[i].job);
+	host_hash_count = count;
+
+	/* Don't leave idle threads spinning while signing */
+	smp_job_stop();
+
+	return 0;
+}
+
 /**
  * fit_image_process_hash - Process a single subnode of the images/ node
  *
@@ -60,6 +238,7 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		int noffset, const void *data, size_t size)
 {
 	uint8_t value[FIT_MAX_HASH_LEN];
+	struct fit_host_hash *hash;
 	const char *node_name;
 	int value_len;
 	char *algo;
@@ -73,7 +252,11 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	hash = fit_host_hash_find(image_name, node_name, algo, size);
+	if (hash && !hash->job.ret) {
+		memcpy(value, hash->value, hash->value_len);
+		value_len = hash->value_len;
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		printf("Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 		       algo, node_name, image_name);
 		return -EPROTONOSUPPORT;
@@ -298,14 +481,16 @@ static int fit_image_process_sig(const char *keydir, void *keydest,
  * @keydest	FDT Blob to write public keys into (NULL if none)
  * @fit:	Pointer to the FIT format image header
  * @image_noffset: Requested component image node
+ * @ext:	External image data (NULL if none)
  * @comment:	Comment to add to signature nodes
  * @require_keys: Mark all keys as 'required'
  * @engine_id:	Engine to use for signing
  * @return: 0 on success, <0 on failure
  */
 int fit_image_add_verification_data(const char *keydir, void *keydest,
-		void *fit, int image_noffset, const char *comment,
-		int require_keys, const char *engine_id, const char *cmdname)
+		void *fit, int image_noffset, const struct fit_ext_data *ext,
+		const char *comment, int require_keys, const char *engine_id,
+		const char *cmdname)
 {
 	const char *image_name;
 	const void *data;
@@ -313,7 +498,7 @@ int fit_image_add_verification_data(const char *keydir, void *keydest,
 	int noffset;
 
 	/* Get image data and data length */
-	if (fit_image_get_data(fit, image_noffset, &data, &size)) {
+	if (fit_image_get_host_data(fit, image_noffset, ext, &data, &size)) {
 		printf("Can't get image data/size\n");
 		return -1;
 	}
@@ -676,6 +861,7 @@ static int fit_config_add_verification_data(const char *keydir, void *keydest,
 }
 
 int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
+			      const struct fit_ext_data *ext,
 			      const char *comment, int require_keys,
 			      const char *engine_id, const char *cmdname)
 {
@@ -691,6 +877,10 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 		return images_noffset;
 	}
 
+	ret = fit_image_hash_all(fit, images_noffset, ext);
+	if (ret)
+		return ret;
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -700,8 +890,8 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 		 * i.e. component image node.
 		 */
 		ret = fit_image_add_verification_data(keydir, keydest,
-				fit, noffset, comment, require_keys, engine_id,
-				cmdname);
+				fit, noffset, ext, comment, require_keys,
+				engine_id, cmdname);
 		if (ret)
 			return ret;
 	}
@@ -747,7 +937,12 @@ int fit_check_sign(const void *fit, const void *key)
 	ret = fit_config_verify(fit, cfg_noffset);
 	if (ret)
 		return ret;
+
+	/* Check the image hashes in parallel while loading the images */
+	fit_hash_jobs_start(fit, fdt_path_offset(fit, FIT_IMAGES_PATH));
 	ret = bootm_host_load_images(fit, cfg_noffset);
+	fit_hash_jobs_finish();
+	smp_job_stop();
 
 	return ret;
 }
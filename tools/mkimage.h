@@ -40,6 +40,7 @@ static inline ulong map_to_sysmem(void *ptr)
 }
 
 #define MKIMAGE_TMPFILE_SUFFIX		".tmp"
+#define MKIMAGE_TMPDATA_SUFFIX		".data.tmp"
 #define MKIMAGE_MAX_TMPFILE_LEN		256
 #define MKIMAGE_DEFAULT_DTC_OPTIONS	"-I dts -O dtb -p 500"
 #define MKIMAGE_MAX_DTC_CMDLINE_LEN	512
@@ -31,6 +31,7 @@ struct func_info {
 	const char *name;
 	unsigned long code_size;
 	unsigned long call_count;
+	unsigned long sample_count;
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
@@ -55,6 +56,7 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+unsigned long sample_total;		/* total samples from the profiler */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -85,6 +87,7 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-prof\t\tDump out samples from the profiler by function\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -226,6 +229,30 @@ static int read_calls(FILE *fin, int count)
 	return 0;
 }
 
+static int read_samples(FILE *fin, int count, int *not_found)
+{
+	struct trace_output_func rec;
+	struct func_info *func;
+	int i;
+
+	notice("sample count: %d\n", count);
+	for (i = 0; i < count; i++) {
+		if (read_data(fin, &rec, sizeof(rec)))
+			return 1;
+		func = find_caller_by_offset(rec.offset);
+		if (!func || (func->code_size &&
+			      rec.offset >= func->offset + func->code_size)) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + rec.offset);
+			(*not_found)++;
+			continue;
+		}
+		func->sample_count += rec.call_count;
+		sample_total += rec.call_count;
+	}
+	return 0;
+}
+
 static int read_profile(FILE *fin, int *not_found)
 {
 	struct trace_output_hdr hdr;
@@ -249,6 +276,11 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count, not_found))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -532,6 +564,49 @@ static int make_ftrace(void)
 	return 0;
 }
 
+static int h_cmp_samples(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(const struct func_info **)v1;
+	const struct func_info *f2 = *(const struct func_info **)v2;
+
+	if (f1->sample_count != f2->sample_count)
+		return f1->sample_count < f2->sample_count ? 1 : -1;
+
+	return strcmp(f1->name, f2->name);
+}
+
+/*
+ * #  Samples       %  Function
+ *       1234   41.2%  memcpy
+ */
+static int make_prof(void)
+{
+	struct func_info **funcs;
+	int count, i;
+
+	funcs = calloc(func_count, sizeof(*funcs));
+	if (!funcs) {
+		error("Cannot allocate function list\n");
+		return -1;
+	}
+	for (i = count = 0; i < func_count; i++) {
+		if (func_list[i].sample_count)
+			funcs[count++] = &func_list[i];
+	}
+	qsort(funcs, count, sizeof(*funcs), h_cmp_samples);
+
+	printf("#  Samples       %%  Function\n");
+	for (i = 0; i < count; i++) {
+		struct func_info *func = funcs[i];
+
+		printf("%10lu  %5.1f%%  %s\n", func->sample_count,
+		       func->sample_count * 100.0 / sample_total, func->name);
+	}
+	free(funcs);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -552,6 +627,8 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-prof"))
+			err = make_prof();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Running jobs in parallel in host tools: each worker is a host thread
+ */
+
+#include "mkimage.h"
+#include <pthread.h>
+#include <sched.h>
+#include <smp_job.h>
+
+static pthread_t threads[CONFIG_SMP_JOB_MAX_WORKERS];
+static int num_threads;
+
+static void *smp_job_host_thread(void *arg)
+{
+	smp_job_worker((long)arg);
+
+	return NULL;
+}
+
+int arch_smp_job_start(int max_workers)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int i;
+
+	/* The calling thread runs jobs too, while it waits */
+	if (max_workers > cpus - 1)
+		max_workers = cpus - 1;
+	for (i = 0; i < max_workers; i++) {
+		if (pthread_create(&threads[i], NULL, smp_job_host_thread,
+				   (void *)(long)i))
+			break;
+	}
+	num_threads = i;
+
+	return num_threads;
+}
+
+void arch_smp_job_stop(void)
+{
+	int i;
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+	num_threads = 0;
+}
+
+void arch_smp_job_idle(void)
+{
+	sched_yield();
+}
+
+void arch_smp_job_notify(void)
+{
+}